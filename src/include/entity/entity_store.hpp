@@ -0,0 +1,79 @@
+#ifndef MSCFINALPROJECT_ENTITY_ENTITYSTORE_HPP
+#define MSCFINALPROJECT_ENTITY_ENTITYSTORE_HPP
+
+#include <cstdint>
+#include <render/sprite_grid.hpp>
+#include <vector>
+#include <vml/vec2.hpp>
+#include <vml/vec4.hpp>
+
+namespace entity {
+    //--Low 24 bits index the sparse set, the high 8 bits are a generation so stale ids are rejected--//
+    typedef uint32_t entity_id;
+    const entity_id INVALID_ENTITY = 0xFFFFFFFF;
+
+    struct transform {
+        vml::vec2 position;
+        vml::vec2 scale;
+        float rotation;
+    };
+
+    //--Components are stored densely (one array each) and removal swaps the last entity into the hole--//
+    class entity_store {
+    public:
+        //--cell_size is in world units, a few entities across so a view query only walks the cells it overlaps--//
+        explicit entity_store(float cell_size);
+
+        entity_id create(const transform& t, uint32_t sprite, const vml::vec4& colour, uint8_t layer, const vml::vec2& velocity);
+        void destroy(entity_id id);
+        bool alive(entity_id id) const;
+        void clear();
+
+        uint32_t size() const;
+        uint32_t index_of(entity_id id) const;
+
+        void set_position(entity_id id, const vml::vec2& position);
+        void set_scale(entity_id id, const vml::vec2& scale);
+        void set_rotation(entity_id id, float rotation);
+        void set_sprite(entity_id id, uint32_t sprite);
+        void set_colour(entity_id id, const vml::vec4& colour);
+        void set_layer(entity_id id, uint8_t layer);
+        void set_velocity(entity_id id, const vml::vec2& velocity);
+
+        const std::vector<entity_id>& get_entities() const { return this->dense; }
+        const std::vector<vml::vec2>& get_positions() const { return this->positions; }
+        const std::vector<vml::vec2>& get_scales() const { return this->scales; }
+        const std::vector<float>& get_rotations() const { return this->rotations; }
+        const std::vector<uint32_t>& get_sprites() const { return this->sprites; }
+        const std::vector<vml::vec4>& get_colours() const { return this->colours; }
+        const std::vector<uint8_t>& get_layers() const { return this->layers; }
+        const std::vector<vml::vec2>& get_velocities() const { return this->velocities; }
+
+        void update(float dt);
+        //--Only entities whose bounds overlap view reach the render queue--//
+        void render(uint32_t pipeline, const render::bounds& view);
+
+    private:
+        vml::mat4 model_of(uint32_t index) const;
+        void update_bounds(uint32_t index);
+
+        std::vector<uint32_t> sparse;
+        std::vector<uint8_t> generations;
+        std::vector<uint32_t> free_slots;
+
+        std::vector<entity_id> dense;
+        std::vector<vml::vec2> positions;
+        std::vector<vml::vec2> scales;
+        std::vector<float> rotations;
+        std::vector<uint32_t> sprites;
+        std::vector<vml::vec4> colours;
+        std::vector<uint8_t> layers;
+        std::vector<vml::vec2> velocities;
+
+        render::sprite_grid grid;
+        //--Scratch for update, 1 where an entity moved into a different range of grid cells--//
+        std::vector<uint8_t> cell_changes;
+    };
+}
+
+#endif//MSCFINALPROJECT_ENTITY_ENTITYSTORE_HPP
@@ -0,0 +1,45 @@
+#ifndef MSCFINALPROJECT_JOB_JOBSYSTEM_HPP
+#define MSCFINALPROJECT_JOB_JOBSYSTEM_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace job::job_system {
+    struct counter;
+
+    struct job {
+        std::function<void()> fn;
+        counter* signal = nullptr;
+    };
+
+    //--Tracks outstanding jobs, jobs queued with run_after are released when it reaches zero--//
+    struct counter {
+        std::atomic<uint32_t> pending{0};
+        std::mutex lock;
+        std::vector<job> continuations;
+
+        bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+    };
+
+    //--worker_count of 0 uses one worker per extra hardware thread, must be called from the main thread--//
+    void init(uint32_t worker_count = 0);
+    uint32_t get_worker_count();
+    bool is_main_thread();
+
+    void run(std::function<void()> fn, counter* signal = nullptr);
+    void run_after(counter* dependency, std::function<void()> fn, counter* signal = nullptr);
+    void run_on_main(std::function<void()> fn, counter* signal = nullptr);
+    void wait(counter* c);
+
+    //--Splits [0, count) into ranges of at most grain items, a grain of 0 picks one from the worker count--//
+    void parallel_for(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)>& fn);
+
+    void process_main_jobs();
+
+    void terminate();
+}
+
+#endif//MSCFINALPROJECT_JOB_JOBSYSTEM_HPP
@@ -0,0 +1,12 @@
+#ifndef MSCFINALPROJECT_MEMORY_ALLOCATIONCOUNTER_HPP
+#define MSCFINALPROJECT_MEMORY_ALLOCATIONCOUNTER_HPP
+
+#include <cstdint>
+
+//--Counts global operator new calls when built with TRACK_ALLOCATIONS, otherwise always reports 0--//
+namespace memory::allocation_counter {
+    bool enabled();
+    uint64_t get_allocation_count();
+}
+
+#endif//MSCFINALPROJECT_MEMORY_ALLOCATIONCOUNTER_HPP
@@ -0,0 +1,51 @@
+#ifndef MSCFINALPROJECT_MEMORY_FRAMEARENA_HPP
+#define MSCFINALPROJECT_MEMORY_FRAMEARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//--One bump arena per frame in flight, memory handed out is only valid until that frame comes round again--//
+namespace memory::frame_arena {
+    struct stats {
+        size_t capacity;
+        size_t used;
+        size_t peak;
+        uint32_t allocations;
+        uint32_t overflow_allocations;
+        uint64_t global_allocations;
+    };
+
+    void init(uint32_t frame_count, size_t capacity);
+    void begin_frame(uint32_t frame);
+
+    void* allocate(size_t size, size_t alignment);
+
+    //--Stats for the frame most recently finished in the active arena slot--//
+    stats get_stats();
+
+    void terminate();
+
+    template<typename T>
+    struct allocator {
+        typedef T value_type;
+
+        allocator() = default;
+        template<typename U>
+        allocator(const allocator<U>&) {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(frame_arena::allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T*, size_t) {}
+    };
+    template<typename T, typename U>
+    bool operator==(const allocator<T>&, const allocator<U>&) { return true; }
+    template<typename T, typename U>
+    bool operator!=(const allocator<T>&, const allocator<U>&) { return false; }
+
+    template<typename T>
+    using vector = std::vector<T, allocator<T>>;
+}
+
+#endif//MSCFINALPROJECT_MEMORY_FRAMEARENA_HPP
@@ -0,0 +1,72 @@
+#ifndef MSCFINALPROJECT_PACK_GUILLOTINEPACKER_HPP
+#define MSCFINALPROJECT_PACK_GUILLOTINEPACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pack {
+    struct rect {
+        uint32_t x, y, w, h;
+    };
+
+    //--Splits a page into a binary tree of free and used rectangles, nodes come from a pool owned by the packer--//
+    class guillotine_packer {
+    public:
+        static constexpr uint32_t INVALID_HANDLE = 0xFFFFFFFF;
+
+        explicit guillotine_packer(uint32_t w = 0, uint32_t h = 0);
+
+        //--Forgets every placement, handles from before the reset must not be removed afterwards--//
+        void reset(uint32_t w, uint32_t h);
+
+        //--First fit in tree order, returns a handle for remove or INVALID_HANDLE when nothing has room--//
+        uint32_t insert(uint32_t w, uint32_t h, rect& out);
+        //--Frees a placement, free siblings are merged back into their parent so the space can be reused whole--//
+        //--A handle that was already removed is ignored even after its node has been handed out again--//
+        void remove(uint32_t handle);
+        //--Marks a region as permanently used, for placements made elsewhere that must not move--//
+        void occupy(const rect& r);
+
+        uint32_t get_width() const;
+        uint32_t get_height() const;
+        uint64_t get_used_area() const;
+        size_t get_node_count() const;
+
+    private:
+        enum class state : uint8_t {
+            free,
+            used,
+            split
+        };
+        struct node {
+            rect r;
+            uint32_t parent;
+            uint32_t first;
+            uint32_t second;
+            //--Largest free width and height anywhere below, not necessarily from the same leaf, used to skip subtrees--//
+            uint32_t max_w, max_h;
+            //--Bumped each time the node goes back to the pool, handles carry it so a stale one doesn't match the new placement--//
+            uint32_t generation;
+            state s;
+        };
+        //--Handles are the node index in the low bits and the node generation in the high bits--//
+        static constexpr uint32_t INDEX_BITS = 22;
+        static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+        uint32_t create(const rect& r, uint32_t parent);
+        void release(uint32_t index);
+        uint32_t find(uint32_t index, uint32_t w, uint32_t h) const;
+        void split(uint32_t index, bool horizontal, uint32_t at);
+        uint32_t claim(uint32_t index, uint32_t w, uint32_t h);
+        void carve(uint32_t index, const rect& r);
+        void refresh(uint32_t index);
+
+        std::vector<node> nodes;
+        std::vector<uint32_t> free_nodes;
+        uint32_t root = INVALID_HANDLE;
+        uint64_t used_area = 0;
+    };
+}
+
+#endif//MSCFINALPROJECT_PACK_GUILLOTINEPACKER_HPP
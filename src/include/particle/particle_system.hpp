@@ -0,0 +1,86 @@
+#ifndef MSCFINALPROJECT_PARTICLE_PARTICLESYSTEM_HPP
+#define MSCFINALPROJECT_PARTICLE_PARTICLESYSTEM_HPP
+
+#include <cstdint>
+#include <render/vertex.hpp>
+#include <vector>
+#include <vml/mat3.hpp>
+#include <vml/vec2.hpp>
+#include <vml/vec4.hpp>
+
+namespace particle {
+    struct emitter_settings {
+        vml::vec2 position = vml::vec2(0.0f, 0.0f);
+        //--Particles start anywhere in a square this far either side of the position--//
+        float radius = 0.0f;
+        vml::vec2 velocity_min = vml::vec2(0.0f, 0.0f);
+        vml::vec2 velocity_max = vml::vec2(0.0f, 0.0f);
+        float lifetime_min = 1.0f, lifetime_max = 1.0f;
+        float size_min = 1.0f, size_max = 1.0f;
+        //--Colour moves linearly from start to end over each particle's lifetime--//
+        vml::vec4 colour_start = vml::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+        vml::vec4 colour_end = vml::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+        //--Particles per second, 0 only emits through burst--//
+        float rate = 0.0f;
+    };
+
+    //--A pool of particles sharing one sprite, every component is its own array sized once at construction--//
+    //--Dead particles are replaced by the last live one, so the pool never reallocates or leaves holes--//
+    class particle_system {
+    public:
+        explicit particle_system(uint32_t capacity, uint32_t sprite = 0);
+
+        //--Returns a handle, 0 is no emitter--//
+        uint32_t add_emitter(const emitter_settings& settings);
+        void remove_emitter(uint32_t id);
+        void set_emitter_position(uint32_t id, const vml::vec2& position);
+        void set_emitter_rate(uint32_t id, float rate);
+        //--Spawns count particles at once, as many as fit when the pool is nearly full--//
+        void burst(uint32_t id, uint32_t count);
+
+        void set_sprite(uint32_t sprite);
+        void set_acceleration(const vml::vec2& acceleration);
+        //--Fraction of velocity lost per second--//
+        void set_drag(float drag);
+        //--Splits integration and vertex writing across job_system workers--//
+        void set_threaded(bool threaded);
+
+        uint32_t size() const { return this->count; }
+        uint32_t capacity() const { return this->max_count; }
+
+        void update(float dt);
+        //--Writes six vertices per live particle, the transform and trim are the sprite's--//
+        uint32_t write_vertices(render::vertex* out, const vml::mat3& transform, const vml::vec4& trim) const;
+        //--Writes straight into the frame's stream buffer and queues a single draw--//
+        void render(uint32_t pipeline, uint8_t layer);
+
+    private:
+        struct emitter {
+            emitter_settings settings;
+            float accumulator = 0.0f;
+            bool alive = false;
+        };
+
+        void spawn(const emitter_settings& settings, uint32_t spawn_count);
+        void integrate(uint32_t begin, uint32_t end, float dt, float damping);
+        void compact();
+        float random(float min, float max);
+
+        uint32_t max_count;
+        uint32_t count = 0;
+        //--Padded to a multiple of four so the SIMD loop never needs a scalar tail--//
+        std::vector<float> x, y, vx, vy;
+        std::vector<float> r, g, b, a, dr, dg, db, da;
+        std::vector<float> life, size_of;
+
+        std::vector<emitter> emitters;
+        std::vector<uint32_t> free_emitters;
+        vml::vec2 acceleration = vml::vec2(0.0f, 0.0f);
+        float drag = 0.0f;
+        uint32_t sprite;
+        bool threaded = false;
+        uint32_t seed = 0x9E3779B9;
+    };
+}
+
+#endif//MSCFINALPROJECT_PARTICLE_PARTICLESYSTEM_HPP
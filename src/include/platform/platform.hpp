@@ -2,6 +2,7 @@
 #define MSCFINALPROJECT_PLATFORM_PLATFORM_HPP
 
 #include <string>
+#include <vector>
 
 namespace platform {
     namespace files {
@@ -9,6 +10,13 @@ namespace platform {
         std::string get_resource_folder();
         void create_folder(const std::string& folder);
     }
+    //--Reports files that finish being written in watched folders, platforms without support never report anything--//
+    namespace watcher {
+        bool watch(const std::string& folder);
+        //--Names of the files written since the last poll, without their folder and each listed once--//
+        std::vector<std::string> poll();
+        void terminate();
+    }
 }
 
 #endif//MSCFINALPROJECT_PLATFORM_PLATFORM_HPP
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef MSCFINALPROJECT_RENDER_GPUSPRITES_HPP
+#define MSCFINALPROJECT_RENDER_GPUSPRITES_HPP
+
+#include <cstdint>
+#include <render/sprite_grid.hpp>
+#include <vml/vec2.hpp>
+#include <vml/vec4.hpp>
+
+//--Sprites kept in a device buffer, culled and compacted by a compute pass and drawn with one indirect draw--//
+//--Only instances changed since the last frame are uploaded, devices without the compute path cull on the CPU instead--//
+namespace render::gpu_sprites {
+    //--Matches the std430 Sprite struct in sprite_cull.cs.glsl and the instance attributes of gpu_sprite.vs.glsl--//
+    struct instance {
+        //--World space rectangle after trimming--//
+        float x, y, w, h;
+        //--Texture offset and scale, sprites are axis aligned so the transform's other terms are always zero--//
+        float u, v, du, dv;
+        float layer;
+        uint32_t colour;
+        uint32_t visible;
+        float pad;
+    };
+
+    struct stats {
+        uint32_t instances;
+        //--Instances copied to the device and the copy regions they were merged into--//
+        uint32_t uploaded;
+        uint32_t upload_regions;
+        //--The compute path's count is read back once the frame's fence has passed, so it is from the last time this frame slot ran--//
+        uint32_t drawn;
+        bool gpu;
+    };
+
+    //--Capacity is fixed, render_manager and sprite_manager must be initialised first--//
+    //--begin_frame, prepare and terminate do nothing until then so the frame loop can call them unconditionally--//
+    void init(uint32_t capacity);
+    //--False before init as well as on the CPU fallback--//
+    bool is_gpu();
+
+    //--Returns a handle, 0 once capacity is reached--//
+    uint32_t create(uint32_t sprite, const vml::vec2& position, const vml::vec2& size, const vml::vec4& colour);
+    void set(uint32_t id, uint32_t sprite, const vml::vec2& position, const vml::vec2& size, const vml::vec4& colour);
+    void set_position(uint32_t id, const vml::vec2& position);
+    void destroy(uint32_t id);
+
+    void set_view(const bounds& view);
+
+    //--Call with the frame index from vulkan_wrapper::begin_frame before anything is drawn--//
+    void begin_frame(uint32_t frame);
+    //--Pass to vulkan_wrapper::render_frame as external_prepare, records the uploads and the culling dispatch--//
+    void prepare();
+    //--Draws immediately rather than through render_queue, call it where the sprites belong in the layer order--//
+    //--The fallback pipeline is only used when sprites are culled on the CPU--//
+    void render(uint32_t fallback_pipeline);
+
+    stats get_stats();
+
+    void terminate();
+}
+
+#endif//MSCFINALPROJECT_RENDER_GPUSPRITES_HPP
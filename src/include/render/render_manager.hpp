@@ -2,30 +2,88 @@
 #define MSCFINALPROJECT_RENDER_RENDERMANAGER_HPP
 
 #include <string>
+#include <render/vertex.hpp>
+#include <resource/name_id.hpp>
 #include <vml/mat4.hpp>
 
 namespace render::render_manager {
     void init();
 
     bool create_graphics_pipeline(const std::string& name);
+    //--Returns a handle for bind_pipeline, 0 if no pipeline was created with that name--//
+    uint32_t get_pipeline(resource::name_id name);
     uint32_t get_pipeline(const std::string& name);
 
-    void bind_pipeline(uint32_t id);
+    //--The opaque variant doesn't blend and writes depth, see render_queue for the order it is drawn in--//
+    void bind_pipeline(uint32_t id, bool opaque = false);
 
     void reset_push_constants();
     void set_perspective(const vml::mat4& pers);
     void set_view(const vml::mat4& view);
+    const vml::mat4& get_perspective();
+    const vml::mat4& get_view();
     void set_model(const vml::mat4& mode);
     void set_texture_transform(const vml::mat3& tt);
     void set_colour_mult(const vml::mat4& cm);
+    //--Depth buffer value in [0, 1) for the next draw, smaller is nearer, it rides in the model's z translation--//
+    //--so call it after set_model--//
+    void set_depth(float depth);
+
+    bool has_depth_buffer();
 
     void draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance);
+    void bind_rect_2D();
     void draw_rect_2D();
 
+    //--Uploads static vertices into their own buffer, returns a handle for bind_geometry or 0 if it could not be created--//
+    uint32_t create_geometry(const vertex* vertices, uint32_t count);
+    //--The buffer is only freed once frames still in flight are done with it--//
+    void destroy_geometry(uint32_t id);
+    void bind_geometry(uint32_t id);
+    //--Copies count vertices into a buffer shared with other static allocations, returns its handle for bind_geometry or 0--//
+    //--first is where the vertices start in that buffer, for long lived geometry that would otherwise need an allocation each--//
+    uint32_t allocate_static(const vertex* vertices, uint32_t count, uint32_t& first);
+    //--Gives the range back once frames still in flight are done with it--//
+    void release_static(uint32_t geometry, uint32_t first, uint32_t count);
+    //--Space for count vertices in the current frame's stream buffer, nullptr once the frame's space is used up--//
+    //--The buffer is rewritten a frame in flight later, so the vertices only need to be valid for this frame--//
+    vertex* allocate_stream(uint32_t count, uint32_t& geometry, uint32_t& first);
+
+    //--Call with the frame index from vulkan_wrapper::begin_frame before anything is drawn--//
+    void begin_frame(uint32_t frame);
+
     bool load_shaders();
     void unload_shaders();
     bool reload_shaders();
 
+    //--Every pipeline's fragment shader is swapped for one that adds 1 to each pixel it touches, blending and depth are unchanged--//
+    //--Rebuilds every pipeline, so call it between frames, it fails if overdraw.fs.spv can't be built--//
+    bool set_overdraw_mode(bool enabled);
+    bool get_overdraw_mode();
+
+    const uint32_t OVERDRAW_BUCKETS = 16;
+    struct overdraw_stats {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        //--Fragments shaded per pixel of the target, 1 is every pixel shaded exactly once--//
+        double average = 0.0;
+        //--Counts saturate at 255--//
+        uint32_t max = 0;
+        //--Pixels by the number of fragments shaded, the last bucket holds OVERDRAW_BUCKETS - 1 and above--//
+        uint32_t histogram[OVERDRAW_BUCKETS] = {};
+    };
+    //--Copies the counts of the next frame rendered back to the host, false unless overdraw mode is on and the target allows it--//
+    bool capture_overdraw();
+    //--True once per capture, frames in flight after it was requested--//
+    bool get_overdraw(overdraw_stats& stats);
+    //--The most recent capture from black through red, yellow and white at its maximum--//
+    bool write_overdraw_heatmap(const std::string& path);
+
+    //--Starts watching the shader folder, changed pipelines are then rebuilt in the background by update_shaders--//
+    bool watch_shaders();
+    //--Call once per frame outside of rendering, finished rebuilds are swapped in by process_main_jobs--//
+    void update_shaders();
+
 
     void terminate();
 }
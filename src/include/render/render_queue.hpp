@@ -0,0 +1,54 @@
+#ifndef MSCFINALPROJECT_RENDER_RENDERQUEUE_HPP
+#define MSCFINALPROJECT_RENDER_RENDERQUEUE_HPP
+
+#include <cstdint>
+#include <vml/mat4.hpp>
+
+namespace render::render_queue {
+    enum class geometry : uint8_t {
+        rect_2D,
+        //--A buffer from render_manager::create_geometry or allocate_static, named by draw_command::buffer--//
+        buffer
+    };
+
+    struct draw_command {
+        uint32_t pipeline;
+        geometry geom;
+        uint32_t vertex_count;
+        uint32_t first_vertex;
+        vml::mat4 model;
+        vml::mat3 texture_transform;
+        vml::mat4 colour_mult;
+        uint32_t buffer = 0;
+        //--Fully covers what it draws, with a depth buffer these are drawn first and front to back--//
+        bool opaque = false;
+    };
+
+    struct stats {
+        uint32_t commands;
+        uint32_t pipeline_binds;
+        uint32_t pipeline_binds_saved;
+        uint32_t vertex_binds;
+        uint32_t vertex_binds_saved;
+        uint32_t opaque;
+    };
+
+    //--Bits 63-56 layer, 55-40 pipeline, 39-32 texture page, 31-0 depth--//
+    uint64_t make_key(uint8_t layer, uint16_t pipeline, uint8_t texture_page, uint32_t depth);
+    //--Maps a float depth onto an unsigned value with the same ordering--//
+    uint32_t depth_bits(float depth);
+
+    void init();
+
+    void submit(uint64_t key, const draw_command& command);
+    //--Every command gets a depth from its place in key order, so the depth buffer agrees with painting back to front--//
+    //--With a depth buffer opaque commands are drawn first nearest first, then translucent ones back to front--//
+    void flush();
+
+    //--Counts from the most recent flush--//
+    stats get_stats();
+
+    void terminate();
+}
+
+#endif//MSCFINALPROJECT_RENDER_RENDERQUEUE_HPP
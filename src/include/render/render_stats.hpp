@@ -0,0 +1,31 @@
+#ifndef MSCFINALPROJECT_RENDER_RENDERSTATS_HPP
+#define MSCFINALPROJECT_RENDER_RENDERSTATS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vml/vec2.hpp>
+
+//--Picks up vulkan_wrapper::get_frame_stats once each frame is submitted, for an on screen overlay and a CSV time series--//
+//--Every call does nothing until init so the frame loop can call them unconditionally--//
+namespace render::render_stats {
+    void init();
+
+    //--Call after vulkan_wrapper::render_frame--//
+    void end_frame();
+    //--Wall time between the two most recent end_frame calls--//
+    double get_frame_ms();
+
+    //--Writes a header and then a row per frame until stopped, false if the file can't be opened--//
+    bool start_log(const std::string& path);
+    void stop_log();
+
+    //--The font is a text handle, size is the line height like text::draw--//
+    void show_overlay(uint32_t font, float size, uint32_t pipeline, uint8_t layer, const vml::vec2& position);
+    void hide_overlay();
+    //--Draws the most recent frame's counters, call from the render callback before render_queue::flush--//
+    void render_overlay();
+
+    void terminate();
+}
+
+#endif//MSCFINALPROJECT_RENDER_RENDERSTATS_HPP
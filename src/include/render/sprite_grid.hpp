@@ -0,0 +1,118 @@
+#ifndef MSCFINALPROJECT_RENDER_SPRITEGRID_HPP
+#define MSCFINALPROJECT_RENDER_SPRITEGRID_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <vml/mat4.hpp>
+
+namespace render {
+    struct bounds {
+        float min_x, min_y;
+        float max_x, max_y;
+
+        bool overlaps(const bounds& b) const {
+            return min_x <= b.max_x && b.min_x <= max_x && min_y <= b.max_y && b.min_y <= max_y;
+        }
+    };
+
+    //--World space rectangle seen through the projection and view, intersected with the z = 0 plane--//
+    bounds view_bounds(const vml::mat4& perspective, const vml::mat4& view);
+    //--Axis aligned bounds of the unit quad after the model transform--//
+    bounds model_bounds(const vml::mat4& model);
+
+    //--Uniform grid over an unbounded world, only cells that have been occupied are stored--//
+    class sprite_grid {
+    public:
+        explicit sprite_grid(float cell_size = 256.0f);
+
+        void insert(uint32_t id, const bounds& b);
+        //--Only touches cells when the bounds move into a different cell range--//
+        void update(uint32_t id, const bounds& b);
+        //--Stores new bounds for an inserted item without touching cells, true when it has left them and needs update--//
+        //--Safe to call from several threads at once for different ids--//
+        bool set_bounds(uint32_t id, const bounds& b);
+        const bounds& get_bounds(uint32_t id) const { return this->items[id].b; }
+        void remove(uint32_t id);
+        void clear();
+
+        template<typename Vector>
+        void query(const bounds& area, Vector& out);
+
+        //--What the most recent query walked, candidates counts every id read from those cells--//
+        struct query_stats {
+            uint32_t cells;
+            uint32_t candidates;
+        };
+        query_stats get_last_query() const { return this->last_query; }
+        //--Cells that currently hold at least one item--//
+        uint32_t get_cell_count() const { return (uint32_t)this->cells.size(); }
+
+    private:
+        struct cell_range {
+            int32_t x0, y0, x1, y1;
+            bool operator==(const cell_range& r) const { return x0 == r.x0 && y0 == r.y0 && x1 == r.x1 && y1 == r.y1; }
+        };
+        struct item {
+            bounds b;
+            cell_range cells;
+            uint32_t stamp = 0;
+            bool present = false;
+        };
+
+        cell_range range_of(const bounds& b) const;
+        static uint64_t cell_key(int32_t x, int32_t y);
+        void link(uint32_t id, const cell_range& r);
+        void unlink(uint32_t id, const cell_range& r);
+
+        float inverse_cell_size;
+        std::vector<item> items;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+        uint32_t stamp = 0;
+        query_stats last_query = {0, 0};
+    };
+
+    template<typename Vector>
+    void sprite_grid::query(const bounds& area, Vector& out) {
+        //--Items spanning several cells are reported once by stamping them with the query number--//
+        this->stamp++;
+        this->last_query = {0, 0};
+        auto visit = [this, &area, &out](const std::vector<uint32_t>& ids) {
+            this->last_query.cells++;
+            this->last_query.candidates += (uint32_t)ids.size();
+            for (uint32_t id : ids) {
+                item& i = this->items[id];
+                if (i.stamp != this->stamp) {
+                    i.stamp = this->stamp;
+                    if (i.b.overlaps(area)) {
+                        out.push_back(id);
+                    }
+                }
+            }
+        };
+        cell_range r = this->range_of(area);
+        //--Ranges are clamped to +-2^30 cells, the span only fits once widened--//
+        uint64_t range_cells = (uint64_t)((int64_t)r.x1 - r.x0 + 1) * (uint64_t)((int64_t)r.y1 - r.y0 + 1);
+        if (range_cells > this->cells.size()) {
+            //--Zoomed far out, walking the stored cells is cheaper than walking the range--//
+            for (const auto& c : this->cells) {
+                int32_t x = (int32_t)(uint32_t)(c.first >> 32);
+                int32_t y = (int32_t)(uint32_t)c.first;
+                if (x >= r.x0 && x <= r.x1 && y >= r.y0 && y <= r.y1) {
+                    visit(c.second);
+                }
+            }
+            return;
+        }
+        for (int32_t y = r.y0; y <= r.y1; y++) {
+            for (int32_t x = r.x0; x <= r.x1; x++) {
+                auto it = this->cells.find(cell_key(x, y));
+                if (it != this->cells.end()) {
+                    visit(it->second);
+                }
+            }
+        }
+    }
+}
+
+#endif//MSCFINALPROJECT_RENDER_SPRITEGRID_HPP
@@ -2,11 +2,34 @@
 #define MSCFINALPROJECT_RENDER_SPRITEMANAGER_HPP
 
 #include <string>
+#include <pack/guillotine_packer.hpp>
+#include <resource/name_id.hpp>
+#include <vml/mat3.hpp>
+#include <vml/mat4.hpp>
+#include <vml/vec4.hpp>
 
 namespace render::sprite_manager {
+    //--False when sprites.ats is missing or invalid, lookups then return the whole quad on layer 0--//
     bool init();
+    uint32_t get_sprite(resource::name_id name);
     uint32_t get_sprite(const std::string& name);
+    //--Texture format the atlas was packed with, 0 RGBA8, 1 BC1, 2 BC3--//
+    uint32_t get_format();
+    uint32_t get_page(uint32_t sprite);
+    const vml::mat3& get_transform(uint32_t sprite);
+    //--Offset and size of the packed texels within the sprite, the unit quad is mapped onto this before the model--//
+    const vml::vec4& get_trim(uint32_t sprite);
+    //--Sets the texture transform only, the caller has to apply get_trim to its model or only the packed texels are drawn over the whole quad--//
     void bind_sprite(uint32_t sprite);
+    //--Sets the texture transform and the model with the sprite's trim applied, the model maps the untrimmed sprite--//
+    void bind_sprite(uint32_t sprite, const vml::mat4& model);
+
+    //--Claims w x h texels of spare layer space for a sprite filled at runtime, 0 when no layer has room--//
+    uint32_t allocate_region(const std::string& name, uint32_t w, uint32_t h);
+    //--Only regions from allocate_region can be released, packed sprites stay put--//
+    void release_region(uint32_t sprite);
+    //--Texel rectangle of a sprite within its page, for uploading the contents of a dynamic region--//
+    pack::rect get_region(uint32_t sprite);
 }
 
 #endif//MSCFINALPROJECT_RENDER_SPRITEMANAGER_HPP
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef MSCFINALPROJECT_RENDER_TEXT_HPP
+#define MSCFINALPROJECT_RENDER_TEXT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vml/vec2.hpp>
+#include <vml/vec4.hpp>
+
+//--Strings are laid out into one run of glyph quads each, drawn with a single command per texture page--//
+//--Glyphs are the distance field sprites TexturePackager bakes with --sdf-font, named <font>/<codepoint>--//
+namespace render::text {
+    void init();
+
+    //--Loads sprites.<name>.atf from the textures folder, returns a handle or 0, sprite_manager must be initialised first--//
+    uint32_t load_font(const std::string& name);
+    //--Size is the line height in world units, lines run down the y axis from the position--//
+    vml::vec2 measure(uint32_t font, const std::string& s, float size);
+
+    //--Lays the string out once into its own vertex buffer, the same font, size and string share one label--//
+    uint32_t create_label(uint32_t font, const std::string& s, float size);
+    void destroy_label(uint32_t label);
+    void draw_label(uint32_t label, uint32_t pipeline, uint8_t layer, const vml::vec2& position, const vml::vec4& colour);
+
+    //--Lays the string out into this frame's stream buffer, for text that changes every frame--//
+    void draw(uint32_t font, const std::string& s, float size, uint32_t pipeline, uint8_t layer, const vml::vec2& position, const vml::vec4& colour);
+
+    void terminate();
+}
+
+#endif//MSCFINALPROJECT_RENDER_TEXT_HPP
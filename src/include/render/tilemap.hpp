@@ -0,0 +1,82 @@
+#ifndef MSCFINALPROJECT_RENDER_TILEMAP_HPP
+#define MSCFINALPROJECT_RENDER_TILEMAP_HPP
+
+#include <cstdint>
+#include <render/sprite_grid.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace render {
+    //--Static tiles split into square chunks, each chunk's quads are uploaded once into a shared static buffer and redrawn from there--//
+    class tilemap {
+    public:
+        static const int32_t CHUNK_SIZE = 32;
+
+        struct stats {
+            uint32_t chunks;
+            uint32_t visible;
+            uint32_t rebuilt;
+            uint32_t draws;
+            uint32_t quads;
+        };
+
+        tilemap(float tile_size, uint8_t layer, uint32_t pipeline);
+        ~tilemap();
+        tilemap(const tilemap&) = delete;
+        tilemap& operator=(const tilemap&) = delete;
+
+        //--Sprite 0 is an empty tile, changing a tile only marks its chunk for a rebuild--//
+        void set_tile(int32_t x, int32_t y, uint32_t sprite);
+        uint32_t get_tile(int32_t x, int32_t y) const;
+        //--Replaces a whole chunk with CHUNK_SIZE * CHUNK_SIZE sprites in row order--//
+        void set_chunk(int32_t cx, int32_t cy, const uint32_t* sprites);
+        void remove_chunk(int32_t cx, int32_t cy);
+        bool has_chunk(int32_t cx, int32_t cy) const;
+        void clear();
+        //--For layers whose tiles have no transparent pixels, they're drawn first and hide what's behind from the depth test--//
+        void set_opaque(bool opaque);
+
+        float get_tile_size() const { return this->tile_size; }
+        //--World space covered by one chunk along each axis--//
+        float get_chunk_extent() const { return this->tile_size * CHUNK_SIZE; }
+
+        //--Dirty chunks are rebuilt when they come into view, then every visible chunk submits one draw per texture page--//
+        void render(const bounds& view);
+        //--Counts from the most recent render--//
+        const stats& get_stats() const { return this->last; }
+
+    private:
+        struct page_range {
+            uint32_t page;
+            float layer;
+            uint32_t first;
+            uint32_t count;
+        };
+        struct chunk {
+            std::vector<uint32_t> tiles;
+            std::vector<page_range> pages;
+            //--Range in the shared static buffer, page ranges start from first--//
+            uint32_t geometry = 0;
+            uint32_t first = 0;
+            uint32_t vertex_count = 0;
+            uint32_t tile_count = 0;
+            bool dirty = true;
+        };
+
+        static uint64_t chunk_key(int32_t cx, int32_t cy);
+        static int32_t chunk_of(int32_t tile);
+        chunk& get_chunk(int32_t cx, int32_t cy);
+        static void release(chunk& c);
+        void build(chunk& c);
+        void submit(chunk& c, int32_t cx, int32_t cy);
+
+        float tile_size;
+        uint8_t layer;
+        uint32_t pipeline;
+        bool opaque = false;
+        std::unordered_map<uint64_t, chunk> chunks;
+        stats last = {};
+    };
+}
+
+#endif//MSCFINALPROJECT_RENDER_TILEMAP_HPP
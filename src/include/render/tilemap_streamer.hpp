@@ -0,0 +1,111 @@
+#ifndef MSCFINALPROJECT_RENDER_TILEMAPSTREAMER_HPP
+#define MSCFINALPROJECT_RENDER_TILEMAPSTREAMER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <job/job_system.hpp>
+#include <memory>
+#include <mutex>
+#include <render/tilemap.hpp>
+#include <resource/region_file.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vml/vec2.hpp>
+
+namespace render {
+    //--Keeps the chunks of a tilemap around the camera loaded from region files, reading and decoding on workers--//
+    //--Evicted chunks are dropped from the tilemap, so tile edits to streamed chunks only last while they stay resident--//
+    class tilemap_streamer {
+    public:
+        struct settings {
+            //--Chunks either side of the camera's chunk that should be resident--//
+            uint32_t radius = 2;
+            //--Seconds ahead along the velocity that a second area is requested--//
+            float prefetch_time = 0.5f;
+            size_t memory_budget = 64 * 1024 * 1024;
+            uint32_t max_in_flight = 8;
+        };
+
+        struct stats {
+            uint32_t resident;
+            uint32_t loading;
+            uint32_t queued;
+            size_t bytes;
+            uint64_t loaded;
+            uint64_t evicted;
+            //--Summed over frames, chunks within the radius of the camera that were still on their way when update returned--//
+            //--Loads only land in process_main_jobs, so these are the chunks missing from the frame drawn after update--//
+            uint64_t misses;
+            float last_latency_ms;
+            float average_latency_ms;
+            float max_latency_ms;
+        };
+
+        //--folders is the resource sub folder holding the r.<x>.<y>.tmr region files--//
+        tilemap_streamer(tilemap& map, const std::vector<std::string>& folders);
+        //--Waits for loads in flight, their results are thrown away--//
+        ~tilemap_streamer();
+        tilemap_streamer(const tilemap_streamer&) = delete;
+        tilemap_streamer& operator=(const tilemap_streamer&) = delete;
+
+        void set_settings(const settings& s);
+        const settings& get_settings() const { return this->config; }
+
+        //--Call once a frame on the main thread with the camera's world position and velocity, finished loads arrive through process_main_jobs--//
+        void update(const vml::vec2& position, const vml::vec2& velocity);
+        const stats& get_stats() const { return this->counts; }
+
+    private:
+        enum class state : uint8_t {
+            unrequested,
+            queued,
+            loading,
+            resident,
+            absent
+        };
+        struct entry {
+            state s = state::unrequested;
+            bool desired = false;
+            uint64_t last_used = 0;
+            size_t bytes = 0;
+            std::chrono::steady_clock::time_point requested;
+        };
+        struct loaded_chunk {
+            bool found = false;
+            resource::region_file::chunk data;
+        };
+
+        static uint64_t chunk_key(int32_t cx, int32_t cy);
+        void request(int32_t cx, int32_t cy, bool needed);
+        void count_misses();
+        void start_loads();
+        //--Runs on a worker, region indices are cached behind index_lock--//
+        loaded_chunk load(int32_t cx, int32_t cy);
+        void finish(int32_t cx, int32_t cy, const loaded_chunk& c);
+        void evict();
+
+        tilemap& map;
+        std::vector<std::string> folders;
+        settings config;
+        stats counts = {};
+
+        std::unordered_map<uint64_t, entry> entries;
+        //--Requested but not started, nearest to the camera first--//
+        std::vector<uint64_t> queue;
+        std::vector<uint64_t> desired;
+        //--Within the radius of the camera itself, a subset of desired--//
+        std::vector<uint64_t> needed;
+        int32_t centre_x = 0, centre_y = 0, ahead_x = 0, ahead_y = 0;
+        bool has_centre = false;
+        uint64_t frame = 0;
+        bool closing = false;
+        std::vector<uint32_t> scratch;
+
+        std::mutex index_lock;
+        std::unordered_map<uint64_t, std::shared_ptr<resource::region_file::index>> indices;
+        job::job_system::counter loads;
+    };
+}
+
+#endif//MSCFINALPROJECT_RENDER_TILEMAPSTREAMER_HPP
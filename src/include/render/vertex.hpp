@@ -1,12 +1,15 @@
 #ifndef MSCFINALPROJECT_VERTEX_HPP
 #define MSCFINALPROJECT_VERTEX_HPP
 
+#include <cstdint>
 #include <vml/vec3.hpp>
 
 namespace render {
     struct vertex {
         vml::vec2 pos;
         vml::vec2 uv;
+        //--RGBA8 with red in the low byte, multiplied into the fragment colour--//
+        uint32_t colour = 0xFFFFFFFF;
     };
 }
 
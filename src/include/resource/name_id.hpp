@@ -0,0 +1,30 @@
+#ifndef MSCFINALPROJECT_RESOURCE_NAMEID_HPP
+#define MSCFINALPROJECT_RESOURCE_NAMEID_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//--64 bit FNV-1a of a resource name, "name"_id folds to a constant so lookups never touch the string at runtime--//
+namespace resource {
+    typedef uint64_t name_id;
+
+    constexpr name_id hash_name(const char* name, size_t length) {
+        name_id hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ (uint8_t)name[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+    inline name_id hash_name(const std::string& name) {
+        return hash_name(name.data(), name.size());
+    }
+
+    namespace literals {
+        constexpr name_id operator""_id(const char* name, size_t length) {
+            return hash_name(name, length);
+        }
+    }
+}
+
+#endif//MSCFINALPROJECT_RESOURCE_NAMEID_HPP
@@ -0,0 +1,16 @@
+#ifndef MSCFINALPROJECT_RESOURCE_PNG_HPP
+#define MSCFINALPROJECT_RESOURCE_PNG_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//--Minimal PNG writer for debug images, RGBA8 with rows stored uncompressed so it needs no zlib--//
+namespace resource::png {
+    //--pixels holds width * height RGBA values in rows from the top--//
+    std::vector<uint8_t> encode(const uint8_t* pixels, uint32_t width, uint32_t height);
+    //--Path is used as given rather than inside the resource folder--//
+    bool write(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height);
+}
+
+#endif//MSCFINALPROJECT_RESOURCE_PNG_HPP
@@ -0,0 +1,40 @@
+#ifndef MSCFINALPROJECT_RESOURCE_REGIONFILE_HPP
+#define MSCFINALPROJECT_RESOURCE_REGIONFILE_HPP
+
+#include <cstdint>
+#include <resource/name_id.hpp>
+#include <string>
+#include <vector>
+
+//--Tile chunks grouped REGION_SIZE x REGION_SIZE to a file, an index at the front lets a single chunk be read without the rest--//
+//--Everything is big endian like the atlas files, chunks store a palette of sprite name ids and run length encoded palette indices--//
+namespace resource::region_file {
+    const uint32_t REGION_SIZE = 16;
+    const uint32_t HEADER_SIZE = 12;
+    const uint32_t INDEX_SIZE = HEADER_SIZE + REGION_SIZE * REGION_SIZE * 8;
+
+    struct index {
+        uint32_t chunk_size = 0;
+        //--Per chunk slot in row order, an offset of 0 means the chunk is not in the file--//
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> sizes;
+    };
+
+    struct chunk {
+        //--Name id 0 is an empty tile--//
+        std::vector<name_id> palette;
+        std::vector<uint16_t> tiles;
+    };
+
+    int32_t region_of(int32_t chunk_coordinate);
+    uint32_t slot_of(int32_t cx, int32_t cy);
+    std::string get_file_name(int32_t rx, int32_t ry);
+
+    bool read_index(const std::vector<uint8_t>& data, index& out);
+    bool decode_chunk(const std::vector<uint8_t>& data, uint32_t tile_count, chunk& out);
+    std::vector<uint8_t> encode_chunk(const chunk& c);
+    //--chunks holds REGION_SIZE * REGION_SIZE encoded chunks by slot, empty entries are left out of the file--//
+    std::vector<uint8_t> encode_region(uint32_t chunk_size, const std::vector<std::vector<uint8_t>>& chunks);
+}
+
+#endif//MSCFINALPROJECT_RESOURCE_REGIONFILE_HPP
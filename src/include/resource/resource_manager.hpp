@@ -1,12 +1,18 @@
 #ifndef MSCFINALPROJECT_RESOURCE_RESOURCEMANAGER_HPP
 #define MSCFINALPROJECT_RESOURCE_RESOURCEMANAGER_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace resource::resource_manager {
     void init(const std::string& folder, char separator);
+    //--Full path of a resource sub folder, ending in a separator--//
+    std::string get_folder_path(const std::vector<std::string>& folders);
     std::vector<uint8_t> read_binary_file(const std::string& file_name, const std::vector<std::string>& folders);
+    //--Reads size bytes from offset, empty if the file is missing or shorter, safe to call from workers--//
+    std::vector<uint8_t> read_binary_file_range(const std::string& file_name, const std::vector<std::string>& folders, uint64_t offset, uint32_t size);
+    bool write_binary_file(const std::string& file_name, const std::vector<std::string>& folders, const std::vector<uint8_t>& data);
 }
 
 #endif//MSCFINALPROJECT_RESOURCEMANAGER_HPP
@@ -23,6 +23,8 @@ namespace vml {
         vec4& operator[](int i);
         vec4 const& operator[](int i) const;
 
+        mat4 inverse() const;
+
         static mat4 identity();
         static mat4 extend(const mat2& m);
         static mat4 extend(const mat3& m);
@@ -4,30 +4,107 @@
 #include "vulkan/vulkan.hpp"
 
 namespace vulkan_wrapper {
+    //--Translucent pipelines blend and only test depth, opaque ones replace the colour and write depth--//
+    //--The overdraw variants test and write depth the same way but add their output to the target instead--//
+    enum class pipeline_variant : uint8_t {
+        translucent,
+        opaque,
+        overdraw_translucent,
+        overdraw_opaque
+    };
+
+    //--Counted as the frame is recorded, waits include the fence in begin_frame and acquiring the swapchain image--//
+    struct frame_stats {
+        uint32_t draws = 0;
+        //--Indirect draws only count as draws, their instance counts never leave the device--//
+        uint32_t instances = 0;
+        uint32_t pipeline_binds = 0;
+        uint32_t vertex_binds = 0;
+        uint32_t push_constant_bytes = 0;
+        //--Buffer writes, staging copies and anything passed to add_uploaded_bytes--//
+        uint64_t uploaded_bytes = 0;
+        //--Vulkan doesn't report a command buffer's size, so this counts the commands recorded into it--//
+        uint32_t commands = 0;
+        double fence_wait_ms = 0.0;
+        double acquire_wait_ms = 0.0;
+    };
 
     bool create_instance(std::vector<const char*> extensions);
     bool create_surface(bool(*fn)(const vk::Instance&, vk::SurfaceKHR&), void (*r)(int*, int*));
-    bool create_others();
+    //--The depth buffer is optional, pipelines only test and write depth when it was created--//
+    bool create_others(bool depth_buffer = false);
     bool create_swapchain();
+    //--In place of create_surface and create_others, frames go to an offscreen image of this size and are never presented--//
+    //--The instance needs no extensions, so it runs without a window on software drivers--//
+    bool create_headless(uint32_t width, uint32_t height, bool depth_buffer = false);
 
     bool create_vertex_buffer(vk::Buffer& buffer, vk::DeviceMemory& memory, uint32_t size);
+    //--Host visible buffers are coherent and can be mapped, the rest are only written by transfers and shaders--//
+    bool create_buffer(vk::Buffer& buffer, vk::DeviceMemory& memory, uint32_t size, const vk::BufferUsageFlags& usage, bool host_visible);
     void map_vertex_buffer(const vk::DeviceMemory& memory, uint32_t size, const void* data);
+    //--Keeps the memory mapped for buffers rewritten every frame, unmap before destroying--//
+    void* map_memory(const vk::DeviceMemory& memory, uint32_t size);
+    void unmap_memory(const vk::DeviceMemory& memory);
     void destroy_vertex_buffer(const vk::Buffer& buffer, const vk::DeviceMemory& memory);
+    //--Destroys the buffer once no frame in flight can still be reading it--//
+    void retire_vertex_buffer(const vk::Buffer& buffer, const vk::DeviceMemory& memory);
 
     bool create_shader_module(vk::ShaderModule& shader_module, const std::vector<uint8_t>& src);
     void destroy_shader_module(const vk::ShaderModule& shader_module);
 
     bool create_pipeline_layout(vk::PipelineLayout& pipeline_layout, const vk::PipelineLayoutCreateInfo& pipeline_layout_create_info);
     void destroy_pipeline_layout(const vk::PipelineLayout& pipeline_layout);
-    bool create_pipeline(vk::Pipeline& pipeline, const vk::PipelineLayout& pipeline_layout, uint32_t shader_module_count, const vk::PipelineShaderStageCreateInfo* shader_modules, uint32_t vertex_binding_description_count, const vk::VertexInputBindingDescription* vertex_binding_descriptions, uint32_t vertex_attribute_description_count, const vk::VertexInputAttributeDescription* vertex_attribute_descriptions, float target_aspect);
+    bool create_pipeline(vk::Pipeline& pipeline, const vk::PipelineLayout& pipeline_layout, uint32_t shader_module_count, const vk::PipelineShaderStageCreateInfo* shader_modules, uint32_t vertex_binding_description_count, const vk::VertexInputBindingDescription* vertex_binding_descriptions, uint32_t vertex_attribute_description_count, const vk::VertexInputAttributeDescription* vertex_attribute_descriptions, float target_aspect, pipeline_variant variant = pipeline_variant::translucent);
     void destroy_pipeline(const vk::Pipeline& pipeline);
+    //--Destroys a pipeline and its layout once no frame in flight can still be using them--//
+    void retire_pipeline(const vk::Pipeline& pipeline, const vk::PipelineLayout& pipeline_layout);
+
+    //--Whether the graphics queue can also dispatch, compute is only recorded in the frame's one command buffer--//
+    bool supports_compute();
+    bool create_compute_pipeline(vk::Pipeline& pipeline, const vk::PipelineLayout& pipeline_layout, const vk::PipelineShaderStageCreateInfo& shader_module);
+    //--Bindings 0 to binding_count - 1 are each a single storage buffer--//
+    bool create_storage_descriptor_set_layout(vk::DescriptorSetLayout& layout, uint32_t binding_count, const vk::ShaderStageFlags& stage);
+    void destroy_descriptor_set_layout(const vk::DescriptorSetLayout& layout);
+    bool allocate_descriptor_set(vk::DescriptorSet& set, const vk::DescriptorSetLayout& layout);
+    void write_storage_buffers(const vk::DescriptorSet& set, uint32_t count, const vk::Buffer* buffers);
+    void free_descriptor_set(const vk::DescriptorSet& set);
+
+    bool has_depth_buffer();
+    //--Counts fragment shader invocations with a pipeline statistics query, returns false if the device can't--//
+    bool set_fragment_counting(bool enabled);
+    //--From the most recent frame whose fence has been waited on, so it trails by the frames in flight--//
+    uint64_t get_fragment_invocations();
+    void get_extent(uint32_t& width, uint32_t& height);
 
-    bool render_frame(void (*external_render)());
+    //--Copies the colour target of the next rendered frame to host memory, false if the target can't be copied from--//
+    bool request_capture();
+    //--RGBA8 rows from the top, true once per capture when its frame has finished on the device--//
+    bool read_capture(std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height);
+
+    //--From the most recently submitted frame--//
+    const frame_stats& get_frame_stats();
+    //--For writes into persistently mapped memory, which never pass through the wrapper--//
+    void add_uploaded_bytes(uint64_t bytes);
+
+    uint32_t get_frame_count();
+    uint32_t begin_frame();
+    //--external_prepare records transfers and dispatches before the render pass begins, it may be null--//
+    bool render_frame(void (*external_render)(), void (*external_prepare)() = nullptr);
 
     void bind_pipeline(const vk::Pipeline& pipeline);
     void bind_vertex_buffers(uint32_t count, const vk::Buffer* buffers, const vk::DeviceSize* offsets);
     void push_constants(const vk::PipelineLayout& layout, const vk::ShaderStageFlags& stage, uint32_t offset, uint32_t size, const void* ptr);
     void draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance);
+    void draw_indirect(const vk::Buffer& buffer, vk::DeviceSize offset, uint32_t draw_count, uint32_t stride);
+    void bind_descriptor_set(const vk::PipelineBindPoint& bind_point, const vk::PipelineLayout& layout, const vk::DescriptorSet& set);
+
+    //--Only recorded from the external_prepare callback of render_frame--//
+    void bind_compute_pipeline(const vk::Pipeline& pipeline);
+    void dispatch(uint32_t x, uint32_t y, uint32_t z);
+    void copy_buffer(const vk::Buffer& src, const vk::Buffer& dst, uint32_t region_count, const vk::BufferCopy* regions);
+    void update_buffer(const vk::Buffer& buffer, vk::DeviceSize offset, uint32_t size, const void* data);
+    void fill_buffer(const vk::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size, uint32_t data);
+    void memory_barrier(const vk::PipelineStageFlags& src_stage, const vk::AccessFlags& src_access, const vk::PipelineStageFlags& dst_stage, const vk::AccessFlags& dst_access);
 
     bool reload_swapchain();
     void destroy_swapchain();
@@ -0,0 +1,228 @@
+#include "entity/entity_store.hpp"
+
+#include <cmath>
+#include <job/job_system.hpp>
+#include <memory/frame_arena.hpp>
+#include <render/render_queue.hpp>
+#include <render/sprite_manager.hpp>
+
+namespace entity {
+    namespace {
+        const uint32_t INDEX_BITS = 24;
+        const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+        const uint32_t NO_INDEX = 0xFFFFFFFF;
+        const uint32_t UPDATE_GRAIN = 4096;
+
+        uint32_t slot_of(entity_id id) {
+            return id & INDEX_MASK;
+        }
+        uint8_t generation_of(entity_id id) {
+            return (uint8_t)(id >> INDEX_BITS);
+        }
+    }
+
+    entity_store::entity_store(float cell_size) : grid(cell_size) {
+    }
+
+    entity_id entity_store::create(const transform& t, uint32_t sprite, const vml::vec4& colour, uint8_t layer, const vml::vec2& velocity) {
+        uint32_t slot;
+        if (!this->free_slots.empty()) {
+            slot = this->free_slots.back();
+            this->free_slots.pop_back();
+        }
+        else {
+            slot = (uint32_t)this->sparse.size();
+            if (slot > INDEX_MASK) {
+                return INVALID_ENTITY;
+            }
+            this->sparse.push_back(NO_INDEX);
+            this->generations.push_back(0);
+        }
+        entity_id id = slot | ((entity_id)this->generations[slot] << INDEX_BITS);
+        this->sparse[slot] = (uint32_t)this->dense.size();
+
+        this->dense.push_back(id);
+        this->positions.push_back(t.position);
+        this->scales.push_back(t.scale);
+        this->rotations.push_back(t.rotation);
+        this->sprites.push_back(sprite);
+        this->colours.push_back(colour);
+        this->layers.push_back(layer);
+        this->velocities.push_back(velocity);
+        this->grid.insert(slot, render::model_bounds(this->model_of(this->sparse[slot])));
+        return id;
+    }
+
+    void entity_store::destroy(entity_id id) {
+        uint32_t index = this->index_of(id);
+        if (index == NO_INDEX) {
+            return;
+        }
+        uint32_t last = (uint32_t)this->dense.size() - 1;
+        if (index != last) {
+            entity_id moved = this->dense[last];
+            this->dense[index] = moved;
+            this->positions[index] = this->positions[last];
+            this->scales[index] = this->scales[last];
+            this->rotations[index] = this->rotations[last];
+            this->sprites[index] = this->sprites[last];
+            this->colours[index] = this->colours[last];
+            this->layers[index] = this->layers[last];
+            this->velocities[index] = this->velocities[last];
+            this->sparse[slot_of(moved)] = index;
+        }
+        this->dense.pop_back();
+        this->positions.pop_back();
+        this->scales.pop_back();
+        this->rotations.pop_back();
+        this->sprites.pop_back();
+        this->colours.pop_back();
+        this->layers.pop_back();
+        this->velocities.pop_back();
+
+        uint32_t slot = slot_of(id);
+        this->grid.remove(slot);
+        this->sparse[slot] = NO_INDEX;
+        this->generations[slot]++;
+        this->free_slots.push_back(slot);
+    }
+
+    bool entity_store::alive(entity_id id) const {
+        return this->index_of(id) != NO_INDEX;
+    }
+
+    void entity_store::clear() {
+        for (entity_id id : this->dense) {
+            uint32_t slot = slot_of(id);
+            this->sparse[slot] = NO_INDEX;
+            this->generations[slot]++;
+            this->free_slots.push_back(slot);
+        }
+        this->dense.clear();
+        this->positions.clear();
+        this->scales.clear();
+        this->rotations.clear();
+        this->sprites.clear();
+        this->colours.clear();
+        this->layers.clear();
+        this->velocities.clear();
+        this->grid.clear();
+    }
+
+    uint32_t entity_store::size() const {
+        return (uint32_t)this->dense.size();
+    }
+
+    uint32_t entity_store::index_of(entity_id id) const {
+        uint32_t slot = slot_of(id);
+        if (id == INVALID_ENTITY || slot >= this->sparse.size() || this->generations[slot] != generation_of(id)) {
+            return NO_INDEX;
+        }
+        return this->sparse[slot];
+    }
+
+    void entity_store::set_position(entity_id id, const vml::vec2& position) {
+        uint32_t index = this->index_of(id);
+        if (index != NO_INDEX) {
+            this->positions[index] = position;
+            this->update_bounds(index);
+        }
+    }
+    void entity_store::set_scale(entity_id id, const vml::vec2& scale) {
+        uint32_t index = this->index_of(id);
+        if (index != NO_INDEX) {
+            this->scales[index] = scale;
+            this->update_bounds(index);
+        }
+    }
+    void entity_store::set_rotation(entity_id id, float rotation) {
+        uint32_t index = this->index_of(id);
+        if (index != NO_INDEX) {
+            this->rotations[index] = rotation;
+            this->update_bounds(index);
+        }
+    }
+    void entity_store::set_sprite(entity_id id, uint32_t sprite) {
+        uint32_t index = this->index_of(id);
+        if (index != NO_INDEX) {
+            this->sprites[index] = sprite;
+            this->update_bounds(index);
+        }
+    }
+    void entity_store::set_colour(entity_id id, const vml::vec4& colour) {
+        uint32_t index = this->index_of(id);
+        if (index != NO_INDEX) this->colours[index] = colour;
+    }
+    void entity_store::set_layer(entity_id id, uint8_t layer) {
+        uint32_t index = this->index_of(id);
+        if (index != NO_INDEX) this->layers[index] = layer;
+    }
+    void entity_store::set_velocity(entity_id id, const vml::vec2& velocity) {
+        uint32_t index = this->index_of(id);
+        if (index != NO_INDEX) this->velocities[index] = velocity;
+    }
+
+    void entity_store::update(float dt) {
+        vml::vec2* p = this->positions.data();
+        const vml::vec2* v = this->velocities.data();
+        this->cell_changes.assign(this->size(), 0);
+        uint8_t* changed = this->cell_changes.data();
+        //--Bounds are rebuilt alongside the move, only entities that cross into other cells are left for the serial pass--//
+        job::job_system::parallel_for(this->size(), UPDATE_GRAIN, [this, p, v, changed, dt](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                if (v[i].data[0] == 0.0f && v[i].data[1] == 0.0f) {
+                    continue;
+                }
+                p[i].data[0] += v[i].data[0] * dt;
+                p[i].data[1] += v[i].data[1] * dt;
+                changed[i] = this->grid.set_bounds(slot_of(this->dense[i]), render::model_bounds(this->model_of(i))) ? 1 : 0;
+            }
+        });
+        for (uint32_t i = 0; i < this->size(); i++) {
+            if (changed[i]) {
+                uint32_t slot = slot_of(this->dense[i]);
+                this->grid.update(slot, this->grid.get_bounds(slot));
+            }
+        }
+    }
+
+    vml::mat4 entity_store::model_of(uint32_t index) const {
+        const vml::vec2& p = this->positions[index];
+        const vml::vec2& s = this->scales[index];
+        float cr = std::cos(this->rotations[index]);
+        float sr = std::sin(this->rotations[index]);
+        //--Only the trimmed part of the sprite is drawn, so the quad is shrunk and offset inside the full sprite--//
+        const vml::vec4& trim = render::sprite_manager::get_trim(this->sprites[index]);
+        float ux = cr * s[0], uy = sr * s[0];
+        float vx = -sr * s[1], vy = cr * s[1];
+        return vml::mat4(ux * trim[2], uy * trim[2], 0.0f, 0.0f,
+                         vx * trim[3], vy * trim[3], 0.0f, 0.0f,
+                         0.0f, 0.0f, 1.0f, 0.0f,
+                         p[0] + ux * trim[0] + vx * trim[1], p[1] + uy * trim[0] + vy * trim[1], 0.0f, 1.0f);
+    }
+
+    void entity_store::update_bounds(uint32_t index) {
+        this->grid.update(slot_of(this->dense[index]), render::model_bounds(this->model_of(index)));
+    }
+
+    void entity_store::render(uint32_t pipeline, const render::bounds& view) {
+        memory::frame_arena::vector<uint32_t> visible;
+        this->grid.query(view, visible);
+        for (uint32_t slot : visible) {
+            uint32_t i = this->sparse[slot];
+            const vml::vec4& c = this->colours[i];
+            uint32_t sprite = this->sprites[i];
+            render::render_queue::draw_command command = {
+                    pipeline, render::render_queue::geometry::rect_2D, 6, 0,
+                    this->model_of(i),
+                    render::sprite_manager::get_transform(sprite),
+                    vml::mat4(c[0], 0.0f, 0.0f, 0.0f,
+                              0.0f, c[1], 0.0f, 0.0f,
+                              0.0f, 0.0f, c[2], 0.0f,
+                              0.0f, 0.0f, 0.0f, c[3])};
+            //--Depth is the dense index so entities within a layer keep their store order--//
+            render::render_queue::submit(render::render_queue::make_key(this->layers[i], (uint16_t)pipeline,
+                                                                        (uint8_t)render::sprite_manager::get_page(sprite), i), command);
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "vulkan_wrapper.hpp"
+#include "entity/entity_store.hpp"
+#include "job/job_system.hpp"
+#include "memory/frame_arena.hpp"
+#include "platform/platform.hpp"
+#include "render/render_manager.hpp"
+#include "render/render_queue.hpp"
+#include "render/sprite_manager.hpp"
+#include "resource/resource_manager.hpp"
+
+namespace {
+    entity::entity_store* scene = nullptr;
+    uint32_t scene_pipeline = 0;
+    double render_ms = 0.0;
+
+    //--Culling, submission, sorting and command recording all happen here, so they are timed together--//
+    void render_scene() {
+        auto start = std::chrono::steady_clock::now();
+        scene->render(scene_pipeline, render::view_bounds(render::render_manager::get_perspective(), render::render_manager::get_view()));
+        render::render_queue::flush();
+        render_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    //--Same seed every run so results from different builds are comparable--//
+    uint32_t seed = 0x9E3779B9;
+    float random(float min, float max) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return min + (max - min) * (float)(seed >> 8) * (1.0f / 16777216.0f);
+    }
+}
+
+//--Times a full store of moving entities being updated and rendered each frame on an offscreen target--//
+//--Needs no window or surface, so it runs in CI on a software Vulkan driver--//
+int main(int argc, char* argv[]) {
+    uint32_t count = 100000;
+    uint32_t frames = 120;
+    uint32_t runs = 3;
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    std::string out;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        if (flag == "--count" && arg + 1 < argc) {
+            count = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--frames" && arg + 1 < argc) {
+            frames = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--runs" && arg + 1 < argc) {
+            runs = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--width" && arg + 1 < argc) {
+            width = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--height" && arg + 1 < argc) {
+            height = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--out" && arg + 1 < argc) {
+            out = argv[++arg];
+        }
+        else {
+            printf("Usage: <command> [--count <entities>] [--frames <frames>] [--runs <runs>] [--width <pixels>] [--height <pixels>] [--out <file.json>]\n");
+            return 0;
+        }
+    }
+
+    if (!vulkan_wrapper::create_instance({}) || !vulkan_wrapper::create_headless(width, height)) {
+        printf("Could not create a headless device\n");
+        return 1;
+    }
+    job::job_system::init();
+    //--Every entity is visible, so the arena has to hold a full frame of draw commands--//
+    memory::frame_arena::init(vulkan_wrapper::get_frame_count(), std::max<size_t>(4 * 1024 * 1024, (size_t)count * 512));
+    resource::resource_manager::init(platform::files::get_resource_folder(), platform::files::FILE_SEPARATOR);
+    render::render_manager::init();
+    render::render_manager::create_graphics_pipeline("default");
+    render::render_manager::load_shaders();
+    render::render_queue::init();
+    //--Entities draw untextured, so the benchmark runs without a packed atlas--//
+    if (!render::sprite_manager::init()) {
+        fprintf(stderr, "No sprite atlas was loaded, entities use the whole quad\n");
+    }
+
+    int result = 1;
+    scene_pipeline = render::render_manager::get_pipeline("default");
+    FILE* fp = nullptr;
+    if (scene_pipeline == 0) {
+        printf("Could not build the default pipeline\n");
+    }
+    else if (!(fp = out.empty() ? stdout : fopen(out.c_str(), "w"))) {
+        printf("Could not open %s\n", out.c_str());
+    }
+    else {
+        const float dt = 1.0f / 60.0f;
+        //--The fastest run is kept, the slower ones only measure scheduling noise--//
+        double best_update = 0.0, best_render = 0.0, best_frame = 0.0;
+        uint64_t drawn = 0;
+        bool rendered = true;
+        for (uint32_t run = 0; run < runs && rendered; run++) {
+            seed = 0x9E3779B9;
+            //--Entities are at most 0.02 across, cells a few times that keep each cell's list short--//
+            entity::entity_store store(0.05f);
+            for (uint32_t i = 0; i < count; i++) {
+                float size = random(0.005f, 0.02f);
+                entity::transform t = {vml::vec2(random(-0.9f, 0.9f), random(-0.9f, 0.9f)), vml::vec2(size, size), random(0.0f, 6.2831853f)};
+                store.create(t, 0, vml::vec4(1.0f, 1.0f, 1.0f, 1.0f), (uint8_t)(i % 4), vml::vec2(random(-0.05f, 0.05f), random(-0.05f, 0.05f)));
+            }
+            scene = &store;
+
+            double update = 0.0, total = 0.0;
+            render_ms = 0.0;
+            drawn = 0;
+            for (uint32_t frame_number = 0; frame_number < frames; frame_number++) {
+                auto start = std::chrono::steady_clock::now();
+                uint32_t frame = vulkan_wrapper::begin_frame();
+                memory::frame_arena::begin_frame(frame);
+                render::render_manager::begin_frame(frame);
+                auto update_start = std::chrono::steady_clock::now();
+                store.update(dt);
+                update += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - update_start).count();
+                if (!vulkan_wrapper::render_frame(render_scene)) {
+                    rendered = false;
+                    break;
+                }
+                total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                drawn += render::render_queue::get_stats().commands;
+            }
+            vulkan_wrapper::wait_idle();
+            scene = nullptr;
+            if (run == 0 || total < best_frame) {
+                best_update = update;
+                best_render = render_ms;
+                best_frame = total;
+            }
+        }
+
+        if (rendered) {
+            fprintf(fp, "{\n  \"count\": %u,\n  \"frames\": %u,\n  \"runs\": %u,\n  \"workers\": %u,\n  \"drawn_per_frame\": %.0f,\n"
+                        "  \"update_ms\": %.3f,\n  \"render_ms\": %.3f,\n  \"frame_ms\": %.3f,\n  \"entities_per_ms\": %.0f\n}\n",
+                    count, frames, runs, job::job_system::get_worker_count(), (double)drawn / frames,
+                    best_update / frames, best_render / frames, best_frame / frames,
+                    best_frame > 0.0 ? (double)count * frames / best_frame : 0.0);
+            result = 0;
+        }
+        else {
+            printf("A frame could not be rendered\n");
+        }
+        if (fp != stdout) {
+            fclose(fp);
+        }
+    }
+
+    render::render_queue::terminate();
+    render::render_manager::terminate();
+    memory::frame_arena::terminate();
+    job::job_system::terminate();
+    vulkan_wrapper::terminate();
+    return result;
+}
@@ -1,31 +1,49 @@
 #include <game.hpp>
 
+#include <entity/entity_store.hpp>
 #include <render/render_manager.hpp>
+#include <render/render_queue.hpp>
+#include <render/render_stats.hpp>
 
+#include <chrono>
 #include <memory>
 
 namespace game {
+    using namespace resource::literals;
+
     namespace {
+        //--The default view is identity, so the world spans -1 to 1 and a grid cell covers an eighth of it--//
+        const float GRID_CELL = 0.25f;
+
         struct info {
             uint32_t shader_id;
+            entity::entity_store entities{GRID_CELL};
+            std::chrono::steady_clock::time_point last_update;
         };
         std::unique_ptr<info> info_p;
     }
     void init() {
         info_p = std::make_unique<info>();
+        info_p->last_update = std::chrono::steady_clock::now();
         if (!render::render_manager::create_graphics_pipeline("default")) {
 
             return;
         }
-        info_p->shader_id = render::render_manager::get_pipeline("default");
+        info_p->shader_id = render::render_manager::get_pipeline("default"_id);
     }
 
     void render() {
-        render::render_manager::bind_pipeline(info_p->shader_id);
+        info_p->entities.render(info_p->shader_id, render::view_bounds(render::render_manager::get_perspective(), render::render_manager::get_view()));
+        render::render_stats::render_overlay();
+        render::render_queue::flush();
     }
     void handle_event() {
     }
     void update() {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        float dt = std::chrono::duration<float>(now - info_p->last_update).count();
+        info_p->last_update = now;
+        info_p->entities.update(dt);
     }
 
     bool should_quit() {
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "vulkan_wrapper.hpp"
+#include "job/job_system.hpp"
+#include "memory/frame_arena.hpp"
+#include "platform/platform.hpp"
+#include "render/gpu_sprites.hpp"
+#include "render/render_manager.hpp"
+#include "render/sprite_manager.hpp"
+#include "resource/resource_manager.hpp"
+
+namespace {
+    uint32_t fallback_pipeline = 0;
+
+    void render_sprites() {
+        render::gpu_sprites::render(fallback_pipeline);
+    }
+
+    //--Same seed every run so a failure reproduces--//
+    uint32_t seed = 0x9E3779B9;
+    float random(float min, float max) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return min + (max - min) * (float)(seed >> 8) * (1.0f / 16777216.0f);
+    }
+
+    struct placed {
+        uint32_t id;
+        render::bounds b;
+    };
+
+    uint32_t count_visible(const std::vector<placed>& sprites, const render::bounds& view) {
+        return (uint32_t)std::count_if(sprites.begin(), sprites.end(), [&view](const placed& p) { return p.id != 0 && p.b.overlaps(view); });
+    }
+}
+
+//--Culls a fixed set of sprites with the compute pass offscreen and checks the indirect draw's instance count against a CPU cull--//
+//--Sprites are moved and destroyed after the first frame so partial uploads are covered, on the CPU fallback the same count is checked--//
+int main(int argc, char* argv[]) {
+    uint32_t count = 10000;
+    bool require_gpu = false;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        if (flag == "--count" && arg + 1 < argc) {
+            //--More than one frame's upload limit would leave changes for later frames than the one checked--//
+            count = std::min(65536u, std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10)));
+        }
+        else if (flag == "--require-gpu") {
+            require_gpu = true;
+        }
+        else {
+            printf("Usage: <command> [--count <sprites>] [--require-gpu]\n");
+            return 0;
+        }
+    }
+
+    if (!vulkan_wrapper::create_instance({}) || !vulkan_wrapper::create_headless(256, 256)) {
+        printf("Could not create a headless device\n");
+        return 1;
+    }
+    job::job_system::init();
+    memory::frame_arena::init(vulkan_wrapper::get_frame_count(), 4 * 1024 * 1024);
+    resource::resource_manager::init(platform::files::get_resource_folder(), platform::files::FILE_SEPARATOR);
+    render::render_manager::init();
+    render::render_manager::create_graphics_pipeline("default");
+    render::render_manager::load_shaders();
+    //--Sprite 0 is the whole quad, so the check needs no packed atlas--//
+    render::sprite_manager::init();
+    render::gpu_sprites::init(count);
+
+    int result = 1;
+    fallback_pipeline = render::render_manager::get_pipeline("default");
+    if (fallback_pipeline == 0) {
+        printf("Could not build the default pipeline\n");
+    }
+    else if (require_gpu && !render::gpu_sprites::is_gpu()) {
+        printf("The compute culling pass could not be created\n");
+    }
+    else {
+        std::vector<placed> sprites(count);
+        for (placed& p : sprites) {
+            float size = random(0.01f, 0.05f);
+            vml::vec2 position(random(-1.0f, 1.0f), random(-1.0f, 1.0f));
+            p.id = render::gpu_sprites::create(0, position, vml::vec2(size, size), vml::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+            p.b = {position[0], position[1], position[0] + size, position[1] + size};
+        }
+        render::bounds view = {-0.5f, -0.5f, 0.5f, 0.5f};
+        render::gpu_sprites::set_view(view);
+
+        //--The compute count comes back once a frame slot comes round again, so enough frames run for the changed scene to be read--//
+        uint32_t frame_count = vulkan_wrapper::get_frame_count();
+        uint32_t frames = frame_count + 2;
+        uint32_t expected = 0, drawn = 0;
+        bool rendered = true;
+        for (uint32_t frame_number = 0; frame_number < frames && rendered; frame_number++) {
+            uint32_t frame = vulkan_wrapper::begin_frame();
+            memory::frame_arena::begin_frame(frame);
+            render::render_manager::begin_frame(frame);
+            render::gpu_sprites::begin_frame(frame);
+            //--Read from the frame recorded after the scene changed, which used this slot last--//
+            if (render::gpu_sprites::is_gpu() && frame_number == frames - 1) {
+                drawn = render::gpu_sprites::get_stats().drawn;
+            }
+            if (frame_number == 1) {
+                for (uint32_t i = 0; i < count; i += 7) {
+                    render::gpu_sprites::destroy(sprites[i].id);
+                    sprites[i].id = 0;
+                }
+                for (uint32_t i = 3; i < count; i += 5) {
+                    if (sprites[i].id != 0) {
+                        vml::vec2 position(random(-1.0f, 1.0f), random(-1.0f, 1.0f));
+                        render::gpu_sprites::set_position(sprites[i].id, position);
+                        float size = sprites[i].b.max_x - sprites[i].b.min_x;
+                        sprites[i].b = {position[0], position[1], position[0] + size, position[1] + size};
+                    }
+                }
+                expected = count_visible(sprites, view);
+            }
+            rendered = vulkan_wrapper::render_frame(render_sprites, render::gpu_sprites::prepare);
+            if (!render::gpu_sprites::is_gpu() && frame_number == 1) {
+                drawn = render::gpu_sprites::get_stats().drawn;
+            }
+        }
+        vulkan_wrapper::wait_idle();
+
+        if (!rendered) {
+            printf("A frame could not be rendered\n");
+        }
+        else {
+            bool gpu = render::gpu_sprites::is_gpu();
+            printf("{\n  \"count\": %u,\n  \"culling\": \"%s\",\n  \"expected\": %u,\n  \"drawn\": %u\n}\n", count, gpu ? "compute" : "cpu", expected, drawn);
+            if (drawn == expected) {
+                result = 0;
+            }
+            else {
+                printf("The %s cull drew %u sprites where %u overlap the view\n", gpu ? "compute" : "CPU", drawn, expected);
+            }
+        }
+    }
+
+    render::gpu_sprites::terminate();
+    render::render_manager::terminate();
+    memory::frame_arena::terminate();
+    job::job_system::terminate();
+    vulkan_wrapper::terminate();
+    return result;
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "render/sprite_grid.hpp"
+
+namespace {
+    //--Same seed every run so results from different builds are comparable--//
+    uint32_t seed = 0x9E3779B9;
+    float random(float min, float max) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return min + (max - min) * (float)(seed >> 8) * (1.0f / 16777216.0f);
+    }
+
+    double elapsed(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const float SPRITE_SIZE = 32.0f;
+    const float VIEW_WIDTH = 1920.0f;
+    const float VIEW_HEIGHT = 1080.0f;
+}
+
+//--Sweeps world size and sprite count with a screen sized camera panning across the world--//
+//--Reports the grid query, the incremental update of moving sprites and a linear scan of every sprite for comparison--//
+int main(int argc, char* argv[]) {
+    uint32_t frames = 120;
+    uint32_t runs = 3;
+    float cell = 256.0f;
+    float moving = 0.1f;
+    std::string out;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        if (flag == "--frames" && arg + 1 < argc) {
+            frames = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--runs" && arg + 1 < argc) {
+            runs = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--cell" && arg + 1 < argc) {
+            cell = std::max(1.0f, strtof(argv[++arg], nullptr));
+        }
+        else if (flag == "--moving" && arg + 1 < argc) {
+            moving = std::min(1.0f, std::max(0.0f, strtof(argv[++arg], nullptr)));
+        }
+        else if (flag == "--out" && arg + 1 < argc) {
+            out = argv[++arg];
+        }
+        else {
+            printf("Usage: <command> [--frames <frames>] [--runs <runs>] [--cell <size>] [--moving <fraction>] [--out <file.json>]\n");
+            return 0;
+        }
+    }
+
+    FILE* fp = out.empty() ? stdout : fopen(out.c_str(), "w");
+    if (!fp) {
+        printf("Could not open %s\n", out.c_str());
+        return 1;
+    }
+
+    const float worlds[] = {2048.0f, 8192.0f, 32768.0f, 131072.0f};
+    const uint32_t counts[] = {1000, 10000, 100000};
+    fprintf(fp, "{\n  \"frames\": %u,\n  \"runs\": %u,\n  \"cell\": %.0f,\n  \"moving\": %.2f,\n  \"results\": [", frames, runs, cell, moving);
+    bool first = true;
+    for (float world : worlds) {
+        for (uint32_t count : counts) {
+            //--The fastest run is kept, the slower ones only measure scheduling noise--//
+            double best_query = 0.0, best_update = 0.0, best_scan = 0.0;
+            uint64_t visible = 0;
+            for (uint32_t run = 0; run < runs; run++) {
+                seed = 0x9E3779B9;
+                render::sprite_grid grid(cell);
+                std::vector<render::bounds> sprites(count);
+                std::vector<float> velocities((size_t)count * 2);
+                for (uint32_t i = 0; i < count; i++) {
+                    float x = random(0.0f, world - SPRITE_SIZE);
+                    float y = random(0.0f, world - SPRITE_SIZE);
+                    sprites[i] = {x, y, x + SPRITE_SIZE, y + SPRITE_SIZE};
+                    velocities[i * 2] = random(-4.0f, 4.0f);
+                    velocities[i * 2 + 1] = random(-4.0f, 4.0f);
+                    grid.insert(i, sprites[i]);
+                }
+                uint32_t movers = (uint32_t)(moving * (float)count);
+                std::vector<uint32_t> result;
+                result.reserve(count);
+
+                double query = 0.0, update = 0.0, scan = 0.0;
+                visible = 0;
+                for (uint32_t frame = 0; frame < frames; frame++) {
+                    auto start = std::chrono::steady_clock::now();
+                    for (uint32_t i = 0; i < movers; i++) {
+                        render::bounds& b = sprites[i];
+                        float dx = velocities[i * 2], dy = velocities[i * 2 + 1];
+                        b = {b.min_x + dx, b.min_y + dy, b.max_x + dx, b.max_y + dy};
+                        grid.update(i, b);
+                    }
+                    update += elapsed(start);
+
+                    //--The camera crosses the world diagonally over the run--//
+                    float t = (float)frame / (float)frames;
+                    float x = t * std::max(0.0f, world - VIEW_WIDTH);
+                    float y = t * std::max(0.0f, world - VIEW_HEIGHT);
+                    render::bounds view = {x, y, x + VIEW_WIDTH, y + VIEW_HEIGHT};
+                    result.clear();
+                    start = std::chrono::steady_clock::now();
+                    grid.query(view, result);
+                    query += elapsed(start);
+                    visible += result.size();
+
+                    start = std::chrono::steady_clock::now();
+                    uint32_t scanned = 0;
+                    for (const render::bounds& b : sprites) {
+                        scanned += b.overlaps(view) ? 1 : 0;
+                    }
+                    scan += elapsed(start);
+                    if (scanned != result.size()) {
+                        printf("The grid returned %u sprites where a linear scan found %u\n", (uint32_t)result.size(), scanned);
+                        if (fp != stdout) {
+                            fclose(fp);
+                        }
+                        return 1;
+                    }
+                }
+                if (run == 0 || query + update < best_query + best_update) {
+                    best_query = query;
+                    best_update = update;
+                }
+                if (run == 0 || scan < best_scan) {
+                    best_scan = scan;
+                }
+            }
+            fprintf(fp, "%s\n    {\"world\": %.0f, \"sprites\": %u, \"visible_per_frame\": %.1f, \"query_ms\": %.4f, \"update_ms\": %.4f, \"linear_scan_ms\": %.4f}",
+                    first ? "" : ",", world, count, (double)visible / frames,
+                    best_query / frames, best_update / frames, best_scan / frames);
+            first = false;
+            fflush(fp);
+        }
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    if (fp != stdout) {
+        fclose(fp);
+    }
+    return 0;
+}
@@ -0,0 +1,271 @@
+#include "job/job_system.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace job::job_system {
+    namespace {
+        //--Each thread owns a deque, the owner pops from the back and thieves steal from the front--//
+        struct worker {
+            std::deque<job> jobs;
+            std::mutex lock;
+            std::thread thread;
+        };
+        struct info {
+            std::vector<std::unique_ptr<worker>> workers;
+            std::atomic<uint32_t> next_queue{0};
+
+            std::mutex main_lock;
+            std::vector<job> main_jobs;
+
+            std::mutex sleep_lock;
+            std::condition_variable sleep_cv;
+            std::atomic<uint32_t> queued{0};
+            std::atomic<uint32_t> sleeping{0};
+            std::atomic<bool> running{false};
+        };
+        std::unique_ptr<info> info_p;
+
+        //--Index 0 is the main thread, -1 is any thread the job system did not create--//
+        thread_local int32_t worker_index = -1;
+
+        void execute(job& j);
+
+        void push(job&& j) {
+            //--Without init there is nothing to queue on, so the job runs on the caller like parallel_for does--//
+            if (!info_p) {
+                execute(j);
+                return;
+            }
+            uint32_t index;
+            if (worker_index >= 0) {
+                index = (uint32_t)worker_index;
+            }
+            else {
+                index = info_p->next_queue.fetch_add(1, std::memory_order_relaxed) % (uint32_t)info_p->workers.size();
+            }
+            worker& w = *info_p->workers[index];
+            {
+                std::lock_guard<std::mutex> guard(w.lock);
+                w.jobs.push_back(std::move(j));
+            }
+            info_p->queued.fetch_add(1);
+            if (info_p->sleeping.load() > 0) {
+                //--Taking the lock orders this wake against a worker that is about to sleep--//
+                { std::lock_guard<std::mutex> guard(info_p->sleep_lock); }
+                info_p->sleep_cv.notify_one();
+            }
+        }
+
+        bool pop(job& out) {
+            if (!info_p) {
+                return false;
+            }
+            if (worker_index >= 0) {
+                worker& own = *info_p->workers[worker_index];
+                std::lock_guard<std::mutex> guard(own.lock);
+                if (!own.jobs.empty()) {
+                    out = std::move(own.jobs.back());
+                    own.jobs.pop_back();
+                    info_p->queued.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            uint32_t count = (uint32_t)info_p->workers.size();
+            uint32_t start = (uint32_t)std::max(worker_index, 0) + 1;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t victim = (start + i) % count;
+                if ((int32_t)victim == worker_index) {
+                    continue;
+                }
+                worker& w = *info_p->workers[victim];
+                std::unique_lock<std::mutex> guard(w.lock, std::try_to_lock);
+                if (guard.owns_lock() && !w.jobs.empty()) {
+                    out = std::move(w.jobs.front());
+                    w.jobs.pop_front();
+                    info_p->queued.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //--The decrement happens under the lock so a waiter can't destroy the counter while it is held--//
+        void finish(counter* c) {
+            if (!c) {
+                return;
+            }
+            std::vector<job> released;
+            {
+                std::lock_guard<std::mutex> guard(c->lock);
+                if (c->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                    return;
+                }
+                released.swap(c->continuations);
+            }
+            for (job& j : released) {
+                push(std::move(j));
+            }
+        }
+
+        void execute(job& j) {
+            j.fn();
+            finish(j.signal);
+        }
+
+        bool run_main_job() {
+            if (!info_p) {
+                return false;
+            }
+            job j;
+            {
+                std::lock_guard<std::mutex> guard(info_p->main_lock);
+                if (info_p->main_jobs.empty()) {
+                    return false;
+                }
+                j = std::move(info_p->main_jobs.front());
+                info_p->main_jobs.erase(info_p->main_jobs.begin());
+            }
+            execute(j);
+            return true;
+        }
+
+        void worker_loop(int32_t index) {
+            worker_index = index;
+            job j;
+            while (info_p->running.load(std::memory_order_acquire)) {
+                if (pop(j)) {
+                    execute(j);
+                    continue;
+                }
+                std::unique_lock<std::mutex> guard(info_p->sleep_lock);
+                info_p->sleeping.fetch_add(1);
+                info_p->sleep_cv.wait(guard, [] {
+                    return info_p->queued.load() > 0 || !info_p->running.load();
+                });
+                info_p->sleeping.fetch_sub(1);
+            }
+        }
+    }
+
+    void init(uint32_t worker_count) {
+        if (info_p) {
+            return;
+        }
+        if (worker_count == 0) {
+            uint32_t hardware = std::thread::hardware_concurrency();
+            worker_count = hardware > 1 ? hardware - 1 : 0;
+        }
+        info_p = std::make_unique<info>();
+        info_p->running = true;
+        worker_index = 0;
+        for (uint32_t i = 0; i <= worker_count; i++) {
+            info_p->workers.push_back(std::make_unique<worker>());
+        }
+        for (uint32_t i = 1; i <= worker_count; i++) {
+            info_p->workers[i]->thread = std::thread(worker_loop, (int32_t)i);
+        }
+    }
+
+    uint32_t get_worker_count() {
+        return info_p ? (uint32_t)info_p->workers.size() - 1 : 0;
+    }
+    bool is_main_thread() {
+        return worker_index == 0;
+    }
+
+    void run(std::function<void()> fn, counter* signal) {
+        if (signal) {
+            signal->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        push({std::move(fn), signal});
+    }
+
+    void run_after(counter* dependency, std::function<void()> fn, counter* signal) {
+        if (signal) {
+            signal->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (dependency) {
+            std::lock_guard<std::mutex> guard(dependency->lock);
+            if (!dependency->done()) {
+                dependency->continuations.push_back({std::move(fn), signal});
+                return;
+            }
+        }
+        push({std::move(fn), signal});
+    }
+
+    void run_on_main(std::function<void()> fn, counter* signal) {
+        if (signal) {
+            signal->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!info_p) {
+            job j = {std::move(fn), signal};
+            execute(j);
+            return;
+        }
+        std::lock_guard<std::mutex> guard(info_p->main_lock);
+        info_p->main_jobs.push_back({std::move(fn), signal});
+    }
+
+    void wait(counter* c) {
+        job j;
+        while (!c->done()) {
+            if (is_main_thread() && run_main_job()) {
+                continue;
+            }
+            if (pop(j)) {
+                execute(j);
+                continue;
+            }
+            std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> guard(c->lock);
+    }
+
+    void parallel_for(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)>& fn) {
+        if (count == 0) {
+            return;
+        }
+        if (grain == 0) {
+            grain = std::max(1U, count / ((get_worker_count() + 1) * 4));
+        }
+        if (!info_p || grain >= count) {
+            fn(0, count);
+            return;
+        }
+        counter c;
+        for (uint32_t begin = grain; begin < count; begin += grain) {
+            uint32_t end = std::min(count, begin + grain);
+            run([&fn, begin, end] { fn(begin, end); }, &c);
+        }
+        fn(0, grain);
+        wait(&c);
+    }
+
+    void process_main_jobs() {
+        while (run_main_job());
+    }
+
+    void terminate() {
+        if (!info_p) {
+            return;
+        }
+        process_main_jobs();
+        {
+            std::lock_guard<std::mutex> guard(info_p->sleep_lock);
+            info_p->running = false;
+        }
+        info_p->sleep_cv.notify_all();
+        for (std::unique_ptr<worker>& w : info_p->workers) {
+            if (w->thread.joinable()) {
+                w->thread.join();
+            }
+        }
+        worker_index = -1;
+        info_p.reset(nullptr);
+    }
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "job/job_system.hpp"
+
+namespace {
+    //--Enough arithmetic per item that the split, not memory bandwidth, decides the scaling--//
+    void work(std::vector<float>& data, uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            float x = data[i];
+            for (uint32_t step = 0; step < 32; step++) {
+                x = std::sqrt(x * x + 1.0f) * 0.5f + std::sin(x) * 0.25f;
+            }
+            data[i] = x;
+        }
+    }
+
+    double elapsed(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+//--Times parallel_for and a fan out of small jobs on 1..N cores, 1 core runs the same work without the job system--//
+int main(int argc, char* argv[]) {
+    uint32_t count = 1 << 20;
+    uint32_t grain = 0;
+    uint32_t jobs = 4096;
+    uint32_t runs = 3;
+    uint32_t max_cores = std::max(1u, std::thread::hardware_concurrency());
+    std::string out;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        if (flag == "--count" && arg + 1 < argc) {
+            count = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--grain" && arg + 1 < argc) {
+            grain = (uint32_t)strtoul(argv[++arg], nullptr, 10);
+        }
+        else if (flag == "--jobs" && arg + 1 < argc) {
+            jobs = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--runs" && arg + 1 < argc) {
+            runs = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--max-cores" && arg + 1 < argc) {
+            max_cores = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--out" && arg + 1 < argc) {
+            out = argv[++arg];
+        }
+        else {
+            printf("Usage: <command> [--count <items>] [--grain <items>] [--jobs <jobs>] [--runs <runs>] [--max-cores <cores>] [--out <file.json>]\n");
+            return 0;
+        }
+    }
+
+    FILE* fp = out.empty() ? stdout : fopen(out.c_str(), "w");
+    if (!fp) {
+        printf("Could not open %s\n", out.c_str());
+        return 1;
+    }
+
+    std::vector<float> data(count);
+    uint32_t job_size = std::max(1u, count / jobs);
+    fprintf(fp, "{\n  \"count\": %u,\n  \"grain\": %u,\n  \"jobs\": %u,\n  \"runs\": %u,\n  \"hardware_threads\": %u,\n  \"results\": [",
+            count, grain, jobs, runs, std::thread::hardware_concurrency());
+    double base_for = 0.0, base_jobs = 0.0;
+    for (uint32_t cores = 1; cores <= max_cores; cores++) {
+        if (cores > 1) {
+            job::job_system::init(cores - 1);
+        }
+        //--The fastest run is kept, the slower ones only measure scheduling noise--//
+        double best_for = 0.0, best_jobs = 0.0;
+        for (uint32_t run = 0; run < runs; run++) {
+            std::fill(data.begin(), data.end(), 1.0f);
+            auto start = std::chrono::steady_clock::now();
+            if (cores > 1) {
+                job::job_system::parallel_for(count, grain, [&data](uint32_t begin, uint32_t end) { work(data, begin, end); });
+            }
+            else {
+                work(data, 0, count);
+            }
+            double time_for = elapsed(start);
+
+            //--Many independent jobs against one counter, the pattern batch building and decoding use--//
+            start = std::chrono::steady_clock::now();
+            if (cores > 1) {
+                job::job_system::counter c;
+                for (uint32_t j = 0; j < jobs; j++) {
+                    uint32_t begin = std::min(count, j * job_size);
+                    uint32_t end = std::min(count, begin + job_size);
+                    job::job_system::run([&data, begin, end] { work(data, begin, end); }, &c);
+                }
+                job::job_system::wait(&c);
+            }
+            else {
+                for (uint32_t j = 0; j < jobs; j++) {
+                    uint32_t begin = std::min(count, j * job_size);
+                    work(data, begin, std::min(count, begin + job_size));
+                }
+            }
+            double time_jobs = elapsed(start);
+
+            if (run == 0 || time_for < best_for) {
+                best_for = time_for;
+            }
+            if (run == 0 || time_jobs < best_jobs) {
+                best_jobs = time_jobs;
+            }
+        }
+        if (cores == 1) {
+            base_for = best_for;
+            base_jobs = best_jobs;
+        }
+        fprintf(fp, "%s\n    {\"cores\": %u, \"parallel_for_ms\": %.3f, \"parallel_for_speedup\": %.2f, \"jobs_ms\": %.3f, \"jobs_speedup\": %.2f}",
+                cores == 1 ? "" : ",", cores, best_for, best_for > 0.0 ? base_for / best_for : 0.0,
+                best_jobs, best_jobs > 0.0 ? base_jobs / best_jobs : 0.0);
+        fflush(fp);
+        job::job_system::terminate();
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    if (fp != stdout) {
+        fclose(fp);
+    }
+    return 0;
+}
@@ -1,9 +1,15 @@
 #include "game.hpp"
 #include "glfw_wrapper.hpp"
 #include "vulkan_wrapper.hpp"
+#include "job/job_system.hpp"
+#include "memory/frame_arena.hpp"
 #include "platform/platform.hpp"
+#include "render/gpu_sprites.hpp"
 #include "render/render_manager.hpp"
+#include "render/render_queue.hpp"
+#include "render/render_stats.hpp"
 #include "render/sprite_manager.hpp"
+#include "render/text.hpp"
 #include "resource/resource_manager.hpp"
 
 int main(int argc, char** args) {
@@ -13,28 +19,81 @@ int main(int argc, char** args) {
     }
     if (!vulkan_wrapper::create_instance(extensions) ||
         !vulkan_wrapper::create_surface(glfw_wrapper::create_surface, glfw_wrapper::get_resolution) ||
-        !vulkan_wrapper::create_others()) {
+        !vulkan_wrapper::create_others(true)) {
         return 0;
     }
+    job::job_system::init();
+    memory::frame_arena::init(vulkan_wrapper::get_frame_count(), 4 * 1024 * 1024);
     resource::resource_manager::init(platform::files::get_resource_folder(), platform::files::FILE_SEPARATOR);
 
     render::render_manager::init();
     render::render_manager::load_shaders();
+    render::render_manager::watch_shaders();
+    render::render_queue::init();
 
     render::sprite_manager::init();
+    //--Capacity of the compute culled sprite buffers, they are sized once here--//
+    render::gpu_sprites::init(65536);
+    render::text::init();
+    render::render_stats::init();
+    for (int arg = 1; arg + 1 < argc; arg++) {
+        if (std::string(args[arg]) == "--stats-log") {
+            render::render_stats::start_log(args[++arg]);
+        }
+    }
 
     game::init();
 
+#ifdef DEBUG_MODE
+    if (!vulkan_wrapper::set_fragment_counting(true)) {
+        printf("Fragment counting isn't supported, overdraw won't be reported\n");
+    }
+#endif
+
+    uint64_t frame_number = 0;
     while (!(glfw_wrapper::should_quit() || game::should_quit())) {
         glfw_wrapper::poll_events();
+        job::job_system::process_main_jobs();
+        render::render_manager::update_shaders();
+        uint32_t frame = vulkan_wrapper::begin_frame();
+        memory::frame_arena::begin_frame(frame);
+        render::render_manager::begin_frame(frame);
+        render::gpu_sprites::begin_frame(frame);
         game::update();
-        if (!vulkan_wrapper::render_frame(game::render)) {
+        if (!vulkan_wrapper::render_frame(game::render, render::gpu_sprites::prepare)) {
             break;
         }
+        render::render_stats::end_frame();
+        if (++frame_number % 600 == 0) {
+#ifdef TRACK_ALLOCATIONS
+            memory::frame_arena::stats stats = memory::frame_arena::get_stats();
+            printf("Frame arena: %zu/%zu bytes (peak %zu), %u allocations, %u overflowed, %llu global allocations\n",
+                   stats.used, stats.capacity, stats.peak, stats.allocations, stats.overflow_allocations, (unsigned long long)stats.global_allocations);
+#endif
+#ifdef DEBUG_MODE
+            render::render_queue::stats queue_stats = render::render_queue::get_stats();
+            printf("Render queue: %u commands, %u pipeline binds (%u saved), %u vertex binds (%u saved)\n",
+                   queue_stats.commands, queue_stats.pipeline_binds, queue_stats.pipeline_binds_saved, queue_stats.vertex_binds, queue_stats.vertex_binds_saved);
+            printf("Sprite culling: %s\n", render::gpu_sprites::is_gpu() ? "compute pass" : "CPU fallback");
+            uint32_t width, height;
+            vulkan_wrapper::get_extent(width, height);
+            if (width * height > 0) {
+                //--Fragments shaded per pixel, 1 is every pixel shaded exactly once--//
+                printf("Overdraw: %.2f, %u opaque commands\n",
+                       (double)vulkan_wrapper::get_fragment_invocations() / ((double)width * height), queue_stats.opaque);
+            }
+#endif
+        }
     }
     vulkan_wrapper::wait_idle();
 
+    render::render_stats::terminate();
+    render::gpu_sprites::terminate();
+    render::text::terminate();
+    render::render_queue::terminate();
     render::render_manager::terminate();
+    memory::frame_arena::terminate();
+    job::job_system::terminate();
     vulkan_wrapper::terminate();
     glfw_wrapper::terminate();
     return 0;
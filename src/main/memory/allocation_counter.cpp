@@ -0,0 +1,52 @@
+#include "memory/allocation_counter.hpp"
+
+#ifdef TRACK_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> allocation_count{0};
+}
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace memory::allocation_counter {
+    bool enabled() {
+        return true;
+    }
+    uint64_t get_allocation_count() {
+        return allocation_count.load(std::memory_order_relaxed);
+    }
+}
+#else
+namespace memory::allocation_counter {
+    bool enabled() {
+        return false;
+    }
+    uint64_t get_allocation_count() {
+        return 0;
+    }
+}
+#endif
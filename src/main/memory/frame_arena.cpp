@@ -0,0 +1,106 @@
+#include "memory/frame_arena.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "memory/allocation_counter.hpp"
+
+namespace memory::frame_arena {
+    namespace {
+        struct arena {
+            std::unique_ptr<uint8_t[]> block;
+            size_t capacity = 0;
+            std::atomic<size_t> offset{0};
+            std::atomic<uint32_t> allocations{0};
+
+            //--Allocations that did not fit, freed on reset and used to grow the block--//
+            std::mutex overflow_lock;
+            std::vector<std::unique_ptr<uint8_t[]>> overflow;
+            size_t overflow_bytes = 0;
+        };
+        struct info {
+            std::vector<std::unique_ptr<arena>> arenas;
+            uint32_t current = 0;
+            size_t peak = 0;
+            uint64_t global_at_begin = 0;
+            stats last = {};
+        };
+        std::unique_ptr<info> info_p;
+
+        void* allocate_overflow(arena& a, size_t size, size_t alignment) {
+            std::lock_guard<std::mutex> guard(a.overflow_lock);
+            a.overflow.push_back(std::make_unique<uint8_t[]>(size + alignment));
+            a.overflow_bytes += size + alignment;
+            uintptr_t p = (uintptr_t)a.overflow.back().get();
+            return (void*)((p + alignment - 1) & ~(uintptr_t)(alignment - 1));
+        }
+
+        void reset(arena& a) {
+            size_t needed = a.offset.load() + a.overflow_bytes;
+            if (!a.overflow.empty()) {
+                size_t grown = a.capacity;
+                while (grown < needed) {
+                    grown *= 2;
+                }
+                a.block = std::make_unique<uint8_t[]>(grown);
+                a.capacity = grown;
+                a.overflow.clear();
+                a.overflow_bytes = 0;
+            }
+            a.offset = 0;
+            a.allocations = 0;
+        }
+    }
+
+    void init(uint32_t frame_count, size_t capacity) {
+        info_p = std::make_unique<info>();
+        for (uint32_t i = 0; i < frame_count; i++) {
+            info_p->arenas.push_back(std::make_unique<arena>());
+            info_p->arenas.back()->block = std::make_unique<uint8_t[]>(capacity);
+            info_p->arenas.back()->capacity = capacity;
+        }
+        info_p->global_at_begin = allocation_counter::get_allocation_count();
+    }
+
+    void begin_frame(uint32_t frame) {
+        arena& finished = *info_p->arenas[info_p->current];
+        size_t used = finished.offset.load() + finished.overflow_bytes;
+        uint64_t global = allocation_counter::get_allocation_count();
+        if (used > info_p->peak) {
+            info_p->peak = used;
+        }
+        info_p->last = {finished.capacity, used, info_p->peak, finished.allocations.load(),
+                        (uint32_t)finished.overflow.size(), global - info_p->global_at_begin};
+
+        //--The caller has waited on this frame's fence so nothing on the GPU still reads from it--//
+        info_p->current = frame;
+        reset(*info_p->arenas[frame]);
+        info_p->global_at_begin = allocation_counter::get_allocation_count();
+    }
+
+    void* allocate(size_t size, size_t alignment) {
+        arena& a = *info_p->arenas[info_p->current];
+        a.allocations.fetch_add(1, std::memory_order_relaxed);
+
+        uintptr_t base = (uintptr_t)a.block.get();
+        size_t offset = a.offset.load(std::memory_order_relaxed);
+        size_t aligned, end;
+        do {
+            aligned = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+            end = aligned + size;
+            if (end > a.capacity) {
+                return allocate_overflow(a, size, alignment);
+            }
+        } while (!a.offset.compare_exchange_weak(offset, end, std::memory_order_relaxed));
+        return (void*)(base + aligned);
+    }
+
+    stats get_stats() {
+        return info_p->last;
+    }
+
+    void terminate() {
+        info_p.reset(nullptr);
+    }
+}
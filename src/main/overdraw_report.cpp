@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "vulkan_wrapper.hpp"
+#include "entity/entity_store.hpp"
+#include "job/job_system.hpp"
+#include "memory/frame_arena.hpp"
+#include "platform/platform.hpp"
+#include "render/render_manager.hpp"
+#include "render/render_queue.hpp"
+#include "render/sprite_manager.hpp"
+#include "resource/resource_manager.hpp"
+
+namespace {
+    entity::entity_store* scene = nullptr;
+    uint32_t scene_pipeline = 0;
+
+    void render_scene() {
+        scene->render(scene_pipeline, render::view_bounds(render::render_manager::get_perspective(), render::render_manager::get_view()));
+        render::render_queue::flush();
+    }
+
+    //--Same seed every run so reports from different builds are comparable--//
+    uint32_t seed = 0x9E3779B9;
+    float random(float min, float max) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return min + (max - min) * (float)(seed >> 8) * (1.0f / 16777216.0f);
+    }
+}
+
+//--Renders a fixed scene of overlapping sprites offscreen in overdraw mode and reports how often each pixel was shaded--//
+//--Needs no window or surface, so it runs in CI on a software Vulkan driver--//
+int main(int argc, char* argv[]) {
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    uint32_t sprites = 2000;
+    uint32_t layers = 4;
+    uint32_t frames = 3;
+    bool depth = true;
+    std::string out;
+    std::string heatmap;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        if (flag == "--width" && arg + 1 < argc) {
+            width = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--height" && arg + 1 < argc) {
+            height = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--sprites" && arg + 1 < argc) {
+            sprites = (uint32_t)strtoul(argv[++arg], nullptr, 10);
+        }
+        else if (flag == "--layers" && arg + 1 < argc) {
+            layers = std::min(256u, std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10)));
+        }
+        else if (flag == "--frames" && arg + 1 < argc) {
+            frames = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--no-depth") {
+            depth = false;
+        }
+        else if (flag == "--out" && arg + 1 < argc) {
+            out = argv[++arg];
+        }
+        else if (flag == "--heatmap" && arg + 1 < argc) {
+            heatmap = argv[++arg];
+        }
+        else {
+            printf("Usage: <command> [--width <pixels>] [--height <pixels>] [--sprites <count>] [--layers <count>] [--frames <frames>] [--no-depth] [--out <file.json>] [--heatmap <file.png>]\n");
+            return 0;
+        }
+    }
+
+    if (!vulkan_wrapper::create_instance({}) || !vulkan_wrapper::create_headless(width, height, depth)) {
+        printf("Could not create a headless device\n");
+        return 1;
+    }
+    job::job_system::init();
+    memory::frame_arena::init(vulkan_wrapper::get_frame_count(), 4 * 1024 * 1024);
+    resource::resource_manager::init(platform::files::get_resource_folder(), platform::files::FILE_SEPARATOR);
+    render::render_manager::init();
+    render::render_manager::create_graphics_pipeline("default");
+    render::render_manager::load_shaders();
+    render::render_queue::init();
+    //--Overdraw only depends on the quads, so the report still runs without a packed atlas--//
+    if (!render::sprite_manager::init()) {
+        fprintf(stderr, "No sprite atlas was loaded, sprites use the whole quad\n");
+    }
+
+    int result = 1;
+    scene_pipeline = render::render_manager::get_pipeline("default");
+    if (scene_pipeline == 0 || !render::render_manager::set_overdraw_mode(true)) {
+        printf("Could not build the overdraw pipelines\n");
+    }
+    else {
+        //--Sprites are up to 0.4 across in a -1 to 1 world--//
+        entity::entity_store store(0.25f);
+        for (uint32_t i = 0; i < sprites; i++) {
+            float size = random(0.05f, 0.4f);
+            entity::transform t = {vml::vec2(random(-1.0f, 1.0f), random(-1.0f, 1.0f)), vml::vec2(size, size), 0.0f};
+            store.create(t, 0, vml::vec4(1.0f, 1.0f, 1.0f, 0.5f), (uint8_t)(i % layers), vml::vec2(0.0f, 0.0f));
+        }
+        scene = &store;
+
+        bool rendered = true;
+        for (uint32_t frame_number = 0; frame_number < frames && rendered; frame_number++) {
+            uint32_t frame = vulkan_wrapper::begin_frame();
+            memory::frame_arena::begin_frame(frame);
+            render::render_manager::begin_frame(frame);
+            if (frame_number + 1 == frames && !render::render_manager::capture_overdraw()) {
+                printf("The colour target can't be read back\n");
+                rendered = false;
+                break;
+            }
+            rendered = vulkan_wrapper::render_frame(render_scene);
+        }
+        vulkan_wrapper::wait_idle();
+
+        render::render_manager::overdraw_stats stats;
+        if (rendered && render::render_manager::get_overdraw(stats)) {
+            FILE* fp = out.empty() ? stdout : fopen(out.c_str(), "w");
+            if (fp) {
+                fprintf(fp, "{\n  \"width\": %u,\n  \"height\": %u,\n  \"sprites\": %u,\n  \"depth\": %s,\n  \"average\": %.4f,\n  \"max\": %u,\n  \"histogram\": [",
+                        stats.width, stats.height, sprites, vulkan_wrapper::has_depth_buffer() ? "true" : "false", stats.average, stats.max);
+                for (uint32_t i = 0; i < render::render_manager::OVERDRAW_BUCKETS; i++) {
+                    fprintf(fp, "%s%u", i == 0 ? "" : ", ", stats.histogram[i]);
+                }
+                fprintf(fp, "]\n}\n");
+                if (fp != stdout) {
+                    fclose(fp);
+                }
+                result = 0;
+            }
+            else {
+                printf("Could not open %s\n", out.c_str());
+            }
+            if (!heatmap.empty() && !render::render_manager::write_overdraw_heatmap(heatmap)) {
+                printf("Could not write %s\n", heatmap.c_str());
+                result = 1;
+            }
+        }
+        else if (rendered) {
+            printf("No overdraw capture was read back\n");
+        }
+        scene = nullptr;
+    }
+
+    render::render_queue::terminate();
+    render::render_manager::terminate();
+    memory::frame_arena::terminate();
+    job::job_system::terminate();
+    vulkan_wrapper::terminate();
+    return result;
+}
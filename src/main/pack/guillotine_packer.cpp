@@ -0,0 +1,190 @@
+#include "pack/guillotine_packer.hpp"
+
+#include <algorithm>
+
+namespace pack {
+    guillotine_packer::guillotine_packer(uint32_t w, uint32_t h) {
+        this->reset(w, h);
+    }
+
+    void guillotine_packer::reset(uint32_t w, uint32_t h) {
+        //--Nodes are kept in the pool, clearing only forgets them so a reused packer doesn't reallocate--//
+        this->nodes.clear();
+        this->free_nodes.clear();
+        this->used_area = 0;
+        this->root = this->create({0, 0, w, h}, INVALID_HANDLE);
+    }
+
+    uint32_t guillotine_packer::insert(uint32_t w, uint32_t h, rect& out) {
+        if (w == 0 || h == 0) {
+            return INVALID_HANDLE;
+        }
+        uint32_t index = this->find(this->root, w, h);
+        //--A claim splits at most twice, the new nodes must still fit in the index bits of a handle--//
+        if (index == INVALID_HANDLE || (this->free_nodes.size() < 4 && this->nodes.size() + 4 > INDEX_MASK)) {
+            return INVALID_HANDLE;
+        }
+        index = this->claim(index, w, h);
+        out = this->nodes[index].r;
+        return index | (this->nodes[index].generation << INDEX_BITS);
+    }
+
+    void guillotine_packer::remove(uint32_t handle) {
+        uint32_t index = handle & INDEX_MASK;
+        if (index >= this->nodes.size() || this->nodes[index].s != state::used ||
+            (this->nodes[index].generation << INDEX_BITS) != (handle & ~INDEX_MASK)) {
+            return;
+        }
+        node& n = this->nodes[index];
+        n.s = state::free;
+        //--The leaf may stay in the tree and be claimed again, so the handle just removed has to stop matching--//
+        n.generation++;
+        this->used_area -= (uint64_t)n.r.w * n.r.h;
+        while (this->nodes[index].parent != INVALID_HANDLE) {
+            uint32_t parent = this->nodes[index].parent;
+            node& p = this->nodes[parent];
+            if (this->nodes[p.first].s != state::free || this->nodes[p.second].s != state::free) {
+                break;
+            }
+            this->release(p.first);
+            this->release(p.second);
+            p.first = p.second = INVALID_HANDLE;
+            p.s = state::free;
+            index = parent;
+        }
+        this->refresh(index);
+    }
+
+    void guillotine_packer::occupy(const rect& r) {
+        if (r.w > 0 && r.h > 0) {
+            this->carve(this->root, r);
+        }
+    }
+
+    uint32_t guillotine_packer::get_width() const {
+        return this->nodes[this->root].r.w;
+    }
+
+    uint32_t guillotine_packer::get_height() const {
+        return this->nodes[this->root].r.h;
+    }
+
+    uint64_t guillotine_packer::get_used_area() const {
+        return this->used_area;
+    }
+
+    size_t guillotine_packer::get_node_count() const {
+        return this->nodes.size() - this->free_nodes.size();
+    }
+
+    uint32_t guillotine_packer::create(const rect& r, uint32_t parent) {
+        node n = {r, parent, INVALID_HANDLE, INVALID_HANDLE, r.w, r.h, 0, state::free};
+        if (!this->free_nodes.empty()) {
+            uint32_t index = this->free_nodes.back();
+            this->free_nodes.pop_back();
+            n.generation = this->nodes[index].generation;
+            this->nodes[index] = n;
+            return index;
+        }
+        this->nodes.push_back(n);
+        return (uint32_t)this->nodes.size() - 1;
+    }
+
+    void guillotine_packer::release(uint32_t index) {
+        //--Marked free so a stale handle to a released node is ignored by remove--//
+        this->nodes[index].s = state::free;
+        this->nodes[index].generation++;
+        this->free_nodes.push_back(index);
+    }
+
+    uint32_t guillotine_packer::find(uint32_t index, uint32_t w, uint32_t h) const {
+        const node& n = this->nodes[index];
+        if (n.max_w < w || n.max_h < h) {
+            return INVALID_HANDLE;
+        }
+        if (n.s == state::free) {
+            return index;
+        }
+        uint32_t out = this->find(n.first, w, h);
+        return out != INVALID_HANDLE ? out : this->find(n.second, w, h);
+    }
+
+    //--Horizontal cuts keep the full width above and below, vertical cuts keep the full height left and right--//
+    void guillotine_packer::split(uint32_t index, bool horizontal, uint32_t at) {
+        rect r = this->nodes[index].r;
+        rect first = horizontal ? rect{r.x, r.y, r.w, at} : rect{r.x, r.y, at, r.h};
+        rect second = horizontal ? rect{r.x, r.y + at, r.w, r.h - at} : rect{r.x + at, r.y, r.w - at, r.h};
+        uint32_t a = this->create(first, index);
+        uint32_t b = this->create(second, index);
+        node& n = this->nodes[index];
+        n.first = a;
+        n.second = b;
+        n.s = state::split;
+    }
+
+    //--Cuts the placement from the top left of a free leaf, the strip to its right is searched before the space below--//
+    uint32_t guillotine_packer::claim(uint32_t index, uint32_t w, uint32_t h) {
+        while (true) {
+            const rect& r = this->nodes[index].r;
+            if (r.h > h) {
+                this->split(index, true, h);
+            }
+            else if (r.w > w) {
+                this->split(index, false, w);
+            }
+            else {
+                break;
+            }
+            index = this->nodes[index].first;
+        }
+        this->nodes[index].s = state::used;
+        this->used_area += (uint64_t)w * h;
+        this->refresh(index);
+        return index;
+    }
+
+    //--The region may span several free leaves when the other layout wasn't cut the same way, each gets its overlap removed--//
+    void guillotine_packer::carve(uint32_t index, const rect& r) {
+        rect n = this->nodes[index].r;
+        uint32_t x0 = std::max(r.x, n.x), y0 = std::max(r.y, n.y);
+        uint32_t x1 = std::min(r.x + r.w, n.x + n.w), y1 = std::min(r.y + r.h, n.y + n.h);
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+        if (this->nodes[index].s == state::split) {
+            uint32_t second = this->nodes[index].second;
+            this->carve(this->nodes[index].first, r);
+            this->carve(second, r);
+            return;
+        }
+        if (this->nodes[index].s == state::used) {
+            return;
+        }
+        if (y0 > n.y) {
+            this->split(index, true, y0 - n.y);
+            index = this->nodes[index].second;
+        }
+        if (x0 > n.x) {
+            this->split(index, false, x0 - n.x);
+            index = this->nodes[index].second;
+        }
+        this->claim(index, x1 - x0, y1 - y0);
+    }
+
+    void guillotine_packer::refresh(uint32_t index) {
+        while (index != INVALID_HANDLE) {
+            node& n = this->nodes[index];
+            if (n.s == state::split) {
+                const node& a = this->nodes[n.first];
+                const node& b = this->nodes[n.second];
+                n.max_w = std::max(a.max_w, b.max_w);
+                n.max_h = std::max(a.max_h, b.max_h);
+            }
+            else {
+                n.max_w = n.s == state::free ? n.r.w : 0;
+                n.max_h = n.s == state::free ? n.r.h : 0;
+            }
+            index = n.parent;
+        }
+    }
+}
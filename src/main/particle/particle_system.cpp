@@ -0,0 +1,275 @@
+#include "particle/particle_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <job/job_system.hpp>
+#include <render/render_manager.hpp>
+#include <render/render_queue.hpp>
+#include <render/sprite_manager.hpp>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define PARTICLE_SSE 1
+#endif
+
+namespace particle {
+    namespace {
+        //--Groups of four particles per job, small enough to spread a few thousand particles over every worker--//
+        const uint32_t UPDATE_GRAIN = 1024;
+        const uint32_t WRITE_GRAIN = 2048;
+
+        uint32_t pack_colour(float r, float g, float b, float a) {
+            auto channel = [](float c) { return (uint32_t)(std::min(1.0f, std::max(0.0f, c)) * 255.0f + 0.5f); };
+            return channel(r) | channel(g) << 8 | channel(b) << 16 | channel(a) << 24;
+        }
+    }
+
+    particle_system::particle_system(uint32_t capacity, uint32_t sprite) {
+        this->max_count = capacity;
+        this->sprite = sprite;
+        size_t padded = ((size_t)capacity + 3) & ~(size_t)3;
+        for (std::vector<float>* v : {&this->x, &this->y, &this->vx, &this->vy, &this->r, &this->g, &this->b, &this->a,
+                                      &this->dr, &this->dg, &this->db, &this->da, &this->life, &this->size_of}) {
+            v->assign(padded, 0.0f);
+        }
+    }
+
+    uint32_t particle_system::add_emitter(const emitter_settings& settings) {
+        uint32_t id;
+        if (!this->free_emitters.empty()) {
+            id = this->free_emitters.back();
+            this->free_emitters.pop_back();
+        }
+        else {
+            this->emitters.emplace_back();
+            id = (uint32_t)this->emitters.size();
+        }
+        emitter& e = this->emitters[id - 1];
+        e.settings = settings;
+        e.accumulator = 0.0f;
+        e.alive = true;
+        return id;
+    }
+
+    void particle_system::remove_emitter(uint32_t id) {
+        if (id == 0 || id > this->emitters.size() || !this->emitters[id - 1].alive) {
+            return;
+        }
+        //--Particles already emitted live out their lifetime--//
+        this->emitters[id - 1].alive = false;
+        this->free_emitters.push_back(id);
+    }
+
+    void particle_system::set_emitter_position(uint32_t id, const vml::vec2& position) {
+        if (id != 0 && id <= this->emitters.size()) {
+            this->emitters[id - 1].settings.position = position;
+        }
+    }
+
+    void particle_system::set_emitter_rate(uint32_t id, float rate) {
+        if (id != 0 && id <= this->emitters.size()) {
+            this->emitters[id - 1].settings.rate = rate;
+        }
+    }
+
+    void particle_system::burst(uint32_t id, uint32_t burst_count) {
+        if (id == 0 || id > this->emitters.size() || !this->emitters[id - 1].alive) {
+            return;
+        }
+        this->spawn(this->emitters[id - 1].settings, burst_count);
+    }
+
+    void particle_system::set_sprite(uint32_t sprite) {
+        this->sprite = sprite;
+    }
+
+    void particle_system::set_acceleration(const vml::vec2& acceleration) {
+        this->acceleration = acceleration;
+    }
+
+    void particle_system::set_drag(float drag) {
+        this->drag = std::max(0.0f, drag);
+    }
+
+    void particle_system::set_threaded(bool threaded) {
+        this->threaded = threaded;
+    }
+
+    float particle_system::random(float min, float max) {
+        //--xorshift32, plenty for particle jitter and cheaper than the standard engines--//
+        this->seed ^= this->seed << 13;
+        this->seed ^= this->seed >> 17;
+        this->seed ^= this->seed << 5;
+        return min + (max - min) * (float)(this->seed >> 8) * (1.0f / 16777216.0f);
+    }
+
+    void particle_system::spawn(const emitter_settings& settings, uint32_t spawn_count) {
+        spawn_count = std::min(spawn_count, this->max_count - this->count);
+        for (uint32_t n = 0; n < spawn_count; n++) {
+            uint32_t i = this->count++;
+            float lifetime = std::max(1e-4f, this->random(settings.lifetime_min, settings.lifetime_max));
+            float inverse = 1.0f / lifetime;
+            this->x[i] = settings.position[0] + this->random(-settings.radius, settings.radius);
+            this->y[i] = settings.position[1] + this->random(-settings.radius, settings.radius);
+            this->vx[i] = this->random(settings.velocity_min[0], settings.velocity_max[0]);
+            this->vy[i] = this->random(settings.velocity_min[1], settings.velocity_max[1]);
+            this->r[i] = settings.colour_start[0];
+            this->g[i] = settings.colour_start[1];
+            this->b[i] = settings.colour_start[2];
+            this->a[i] = settings.colour_start[3];
+            //--Stored as a rate so integration is one multiply-add per channel like position--//
+            this->dr[i] = (settings.colour_end[0] - settings.colour_start[0]) * inverse;
+            this->dg[i] = (settings.colour_end[1] - settings.colour_start[1]) * inverse;
+            this->db[i] = (settings.colour_end[2] - settings.colour_start[2]) * inverse;
+            this->da[i] = (settings.colour_end[3] - settings.colour_start[3]) * inverse;
+            this->life[i] = lifetime;
+            this->size_of[i] = this->random(settings.size_min, settings.size_max);
+        }
+    }
+
+    void particle_system::integrate(uint32_t begin, uint32_t end, float dt, float damping) {
+        float ax = this->acceleration[0] * dt, ay = this->acceleration[1] * dt;
+#ifdef PARTICLE_SSE
+        const __m128 vdt = _mm_set1_ps(dt), vdamp = _mm_set1_ps(damping);
+        const __m128 vax = _mm_set1_ps(ax), vay = _mm_set1_ps(ay);
+        float* px = this->x.data();
+        float* py = this->y.data();
+        float* pvx = this->vx.data();
+        float* pvy = this->vy.data();
+        float* colour[4] = {this->r.data(), this->g.data(), this->b.data(), this->a.data()};
+        const float* rate[4] = {this->dr.data(), this->dg.data(), this->db.data(), this->da.data()};
+        float* pl = this->life.data();
+        for (uint32_t i = begin; i < end; i += 4) {
+            __m128 velx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(pvx + i), vax), vdamp);
+            __m128 vely = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(pvy + i), vay), vdamp);
+            _mm_storeu_ps(pvx + i, velx);
+            _mm_storeu_ps(pvy + i, vely);
+            _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(velx, vdt)));
+            _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(vely, vdt)));
+            for (uint32_t c = 0; c < 4; c++) {
+                _mm_storeu_ps(colour[c] + i, _mm_add_ps(_mm_loadu_ps(colour[c] + i), _mm_mul_ps(_mm_loadu_ps(rate[c] + i), vdt)));
+            }
+            _mm_storeu_ps(pl + i, _mm_sub_ps(_mm_loadu_ps(pl + i), vdt));
+        }
+#else
+        for (uint32_t i = begin; i < end; i++) {
+            this->vx[i] = (this->vx[i] + ax) * damping;
+            this->vy[i] = (this->vy[i] + ay) * damping;
+            this->x[i] += this->vx[i] * dt;
+            this->y[i] += this->vy[i] * dt;
+            this->r[i] += this->dr[i] * dt;
+            this->g[i] += this->dg[i] * dt;
+            this->b[i] += this->db[i] * dt;
+            this->a[i] += this->da[i] * dt;
+            this->life[i] -= dt;
+        }
+#endif
+    }
+
+    void particle_system::compact() {
+        //--Swap the last live particle into each dead slot, order isn't kept but nothing moves more than once--//
+        uint32_t i = 0;
+        while (i < this->count) {
+            if (this->life[i] > 0.0f) {
+                i++;
+                continue;
+            }
+            uint32_t last = --this->count;
+            for (std::vector<float>* v : {&this->x, &this->y, &this->vx, &this->vy, &this->r, &this->g, &this->b, &this->a,
+                                          &this->dr, &this->dg, &this->db, &this->da, &this->life, &this->size_of}) {
+                (*v)[i] = (*v)[last];
+            }
+        }
+    }
+
+    void particle_system::update(float dt) {
+        if (dt <= 0.0f) {
+            return;
+        }
+        //--Existing particles move first so new ones start exactly at their emitter--//
+        if (this->count > 0) {
+            float damping = 1.0f / (1.0f + this->drag * dt);
+            uint32_t groups = (this->count + 3) / 4;
+            if (this->threaded) {
+                job::job_system::parallel_for(groups, UPDATE_GRAIN, [this, dt, damping](uint32_t begin, uint32_t end) {
+                    this->integrate(begin * 4, end * 4, dt, damping);
+                });
+            }
+            else {
+                this->integrate(0, groups * 4, dt, damping);
+            }
+            this->compact();
+        }
+        for (emitter& e : this->emitters) {
+            if (!e.alive || e.settings.rate <= 0.0f) {
+                continue;
+            }
+            e.accumulator += e.settings.rate * dt;
+            uint32_t n = (uint32_t)e.accumulator;
+            e.accumulator -= (float)n;
+            this->spawn(e.settings, n);
+        }
+    }
+
+    uint32_t particle_system::write_vertices(render::vertex* out, const vml::mat3& transform, const vml::vec4& trim) const {
+        //--Same corner order as the rect_2D quad, UVs are the same for every particle so they're worked out once--//
+        const float corners[6][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+        float uvs[6][2], offsets[6][2];
+        for (uint32_t c = 0; c < 6; c++) {
+            vml::vec3 uv = transform * vml::vec3(corners[c][0], corners[c][1], 1.0f);
+            uvs[c][0] = uv[0];
+            uvs[c][1] = uv[1];
+            //--Particles are centred on their position, the trim keeps transparent borders out of the quad--//
+            offsets[c][0] = trim[0] + corners[c][0] * trim[2] - 0.5f;
+            offsets[c][1] = trim[1] + corners[c][1] * trim[3] - 0.5f;
+        }
+        auto write = [&](uint32_t begin, uint32_t end) {
+            render::vertex* v = out + (size_t)begin * 6;
+            for (uint32_t i = begin; i < end; i++) {
+                uint32_t colour = pack_colour(this->r[i], this->g[i], this->b[i], this->a[i]);
+                float s = this->size_of[i], px = this->x[i], py = this->y[i];
+                //--Straight to the components, the vml operators aren't inlined and dominate this loop otherwise--//
+                for (uint32_t c = 0; c < 6; c++) {
+                    v->pos.data[0] = px + offsets[c][0] * s;
+                    v->pos.data[1] = py + offsets[c][1] * s;
+                    v->uv.data[0] = uvs[c][0];
+                    v->uv.data[1] = uvs[c][1];
+                    v->colour = colour;
+                    v++;
+                }
+            }
+        };
+        if (this->threaded) {
+            job::job_system::parallel_for(this->count, WRITE_GRAIN, write);
+        }
+        else {
+            write(0, this->count);
+        }
+        return this->count * 6;
+    }
+
+    void particle_system::render(uint32_t pipeline, uint8_t layer) {
+        if (this->count == 0 || this->sprite == 0) {
+            return;
+        }
+        uint32_t geometry, first;
+        render::vertex* out = render::render_manager::allocate_stream(this->count * 6, geometry, first);
+        //--Out of stream space this frame, the buffer grows for the next one--//
+        if (!out) {
+            return;
+        }
+        const vml::mat3& transform = render::sprite_manager::get_transform(this->sprite);
+        uint32_t vertex_count = this->write_vertices(out, transform, render::sprite_manager::get_trim(this->sprite));
+        //--UVs are baked into the vertices and the colour is per vertex, only the page's layer is left for the draw--//
+        render::render_queue::draw_command command = {
+                pipeline, render::render_queue::geometry::buffer, vertex_count, first,
+                vml::mat4::identity(),
+                vml::mat3(1.0f, 0.0f, 0.0f,
+                          0.0f, 1.0f, 0.0f,
+                          0.0f, 0.0f, transform[2][2]),
+                vml::mat4::identity(),
+                geometry};
+        uint8_t page = (uint8_t)render::sprite_manager::get_page(this->sprite);
+        render::render_queue::submit(render::render_queue::make_key(layer, (uint16_t)pipeline, page, 0), command);
+    }
+}
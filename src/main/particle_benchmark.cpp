@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "job/job_system.hpp"
+#include "particle/particle_system.hpp"
+#include "render/vertex.hpp"
+
+//--Times update and vertex writing for a full pool, the pool is topped up each frame so the live count stays at capacity--//
+int main(int argc, char* argv[]) {
+    uint32_t count = 100000;
+    uint32_t frames = 120;
+    uint32_t runs = 3;
+    std::string out;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        if (flag == "--count" && arg + 1 < argc) {
+            count = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--frames" && arg + 1 < argc) {
+            frames = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--runs" && arg + 1 < argc) {
+            runs = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--out" && arg + 1 < argc) {
+            out = argv[++arg];
+        }
+        else {
+            printf("Usage: <command> [--count <particles>] [--frames <frames>] [--runs <runs>] [--out <file.json>]\n");
+            return 0;
+        }
+    }
+
+    FILE* fp = out.empty() ? stdout : fopen(out.c_str(), "w");
+    if (!fp) {
+        printf("Could not open %s\n", out.c_str());
+        return 1;
+    }
+
+    job::job_system::init();
+    particle::emitter_settings settings;
+    settings.radius = 16.0f;
+    settings.velocity_min = vml::vec2(-50.0f, -50.0f);
+    settings.velocity_max = vml::vec2(50.0f, 50.0f);
+    settings.lifetime_min = 0.5f;
+    settings.lifetime_max = 2.0f;
+    settings.size_min = 2.0f;
+    settings.size_max = 6.0f;
+    const float dt = 1.0f / 60.0f;
+    //--The sprite transform is only used for UVs, identity keeps the benchmark free of the sprite atlas--//
+    const vml::mat3 transform(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    const vml::vec4 trim(0.0f, 0.0f, 1.0f, 1.0f);
+    std::vector<render::vertex> vertices((size_t)count * 6);
+
+    fprintf(fp, "{\n  \"count\": %u,\n  \"frames\": %u,\n  \"runs\": %u,\n  \"workers\": %u,\n  \"results\": [",
+            count, frames, runs, job::job_system::get_worker_count());
+    bool first = true;
+    for (bool threaded : {false, true}) {
+        //--The fastest run is kept, the slower ones only measure scheduling noise--//
+        double bestUpdate = 0.0, bestWrite = 0.0;
+        uint64_t processed = 0;
+        for (uint32_t run = 0; run < runs; run++) {
+            particle::particle_system system(count);
+            system.set_threaded(threaded);
+            system.set_acceleration(vml::vec2(0.0f, -98.0f));
+            system.set_drag(0.5f);
+            uint32_t emitter = system.add_emitter(settings);
+            double update = 0.0, write = 0.0;
+            processed = 0;
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                system.burst(emitter, system.capacity() - system.size());
+                processed += system.size();
+                auto start = std::chrono::steady_clock::now();
+                system.update(dt);
+                auto middle = std::chrono::steady_clock::now();
+                system.write_vertices(vertices.data(), transform, trim);
+                auto end = std::chrono::steady_clock::now();
+                update += std::chrono::duration<double, std::milli>(middle - start).count();
+                write += std::chrono::duration<double, std::milli>(end - middle).count();
+            }
+            if (run == 0 || update + write < bestUpdate + bestWrite) {
+                bestUpdate = update;
+                bestWrite = write;
+            }
+        }
+        fprintf(fp, "%s\n    {\"threaded\": %s, \"particles\": %llu, \"update_ms\": %.3f, \"write_ms\": %.3f, "
+                    "\"update_particles_per_ms\": %.0f, \"write_particles_per_ms\": %.0f}",
+                first ? "" : ",", threaded ? "true" : "false", (unsigned long long)processed, bestUpdate, bestWrite,
+                bestUpdate > 0.0 ? (double)processed / bestUpdate : 0.0, bestWrite > 0.0 ? (double)processed / bestWrite : 0.0);
+        first = false;
+        fflush(fp);
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    if (fp != stdout) {
+        fclose(fp);
+    }
+    job::job_system::terminate();
+    return 0;
+}
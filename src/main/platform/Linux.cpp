@@ -0,0 +1,79 @@
+#include "platform/platform.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <fcntl.h>
+#include <memory>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace platform::files {
+    const char FILE_SEPARATOR = '/';
+    std::string get_resource_folder() {
+        char path[PATH_MAX];
+        ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+        if (length <= 0) {
+            return "resources/";
+        }
+        std::string path_str(path, (size_t)length);
+        return path_str.substr(0, path_str.find_last_of('/') + 1).append("resources/");
+    }
+    void create_folder(const std::string& folder) {
+        mkdir(folder.c_str(), 0755);
+    }
+}
+
+namespace platform::watcher {
+    namespace {
+        struct info {
+            int fd = -1;
+            std::unordered_map<int, std::string> folders;
+        };
+        std::unique_ptr<info> info_p;
+    }
+    bool watch(const std::string& folder) {
+        if (!info_p) {
+            info_p = std::make_unique<info>();
+            info_p->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        }
+        if (info_p->fd < 0) {
+            return false;
+        }
+        //--Close after write and moves in catch both editors saving in place and compilers renaming a temporary over the file--//
+        int wd = inotify_add_watch(info_p->fd, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            return false;
+        }
+        info_p->folders[wd] = folder;
+        return true;
+    }
+    std::vector<std::string> poll() {
+        std::vector<std::string> changed;
+        if (!info_p || info_p->fd < 0) {
+            return changed;
+        }
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(info_p->fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                if (event->len > 0 && info_p->folders.count(event->wd) > 0) {
+                    std::string name(event->name);
+                    if (std::find(changed.begin(), changed.end(), name) == changed.end()) {
+                        changed.push_back(name);
+                    }
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        return changed;
+    }
+    void terminate() {
+        if (info_p && info_p->fd >= 0) {
+            close(info_p->fd);
+        }
+        info_p.reset(nullptr);
+    }
+}
@@ -16,4 +16,14 @@ namespace platform::files {
     }
     void create_folder(const std::string& folder) {
     }
+}
+namespace platform::watcher {
+    bool watch(const std::string& folder) {
+        return false;
+    }
+    std::vector<std::string> poll() {
+        return {};
+    }
+    void terminate() {
+    }
 }
\ No newline at end of file
@@ -13,4 +13,14 @@ namespace Platform::Files {
     }
     void createFolder(const std::string& folder) {
     }
+}
+namespace platform::watcher {
+    bool watch(const std::string& folder) {
+        return false;
+    }
+    std::vector<std::string> poll() {
+        return {};
+    }
+    void terminate() {
+    }
 }
\ No newline at end of file
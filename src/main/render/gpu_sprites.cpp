@@ -0,0 +1,493 @@
+#include "render/gpu_sprites.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "vulkan_wrapper.hpp"
+#include "render/push_constants.hpp"
+#include "render/render_manager.hpp"
+#include "render/sprite_manager.hpp"
+#include "render/vertex.hpp"
+#include "resource/resource_manager.hpp"
+
+namespace render::gpu_sprites {
+    namespace {
+        //--Matches local_size_x in sprite_cull.cs.glsl--//
+        const uint32_t GROUP_SIZE = 64;
+        //--Per frame upload limit, anything past it stays dirty for the next frame--//
+        const uint32_t STAGING_INSTANCES = 65536;
+
+        struct device_buffer {
+            vk::Buffer buffer;
+            vk::DeviceMemory memory;
+        };
+
+        struct cull_constants {
+            float view[4];
+            uint32_t count;
+        };
+
+        struct draw_indirect_command {
+            uint32_t vertex_count;
+            uint32_t instance_count;
+            uint32_t first_vertex;
+            uint32_t first_instance;
+        };
+
+        struct source {
+            uint32_t sprite;
+            vml::vec2 position;
+            vml::vec2 size;
+        };
+
+        struct info {
+            uint32_t capacity = 0;
+            //--Handles are indices plus one, freed slots are reused--//
+            std::vector<instance> instances;
+            std::vector<source> sources;
+            std::vector<uint32_t> free_instances;
+            std::vector<uint32_t> dirty;
+            std::vector<uint8_t> is_dirty;
+            bounds view = {0.0f, 0.0f, 0.0f, 0.0f};
+            uint32_t frame = 0;
+            stats last = {0, 0, 0, 0, false};
+
+            bool gpu = false;
+            //--Slots that haven't been uploaded yet must read as hidden, so the device copy is zeroed once first--//
+            bool cleared = false;
+            device_buffer device_instances;
+            device_buffer survivors;
+            device_buffer indirect;
+            std::vector<device_buffer> staging;
+            std::vector<instance*> staging_memory;
+            std::vector<vk::BufferCopy> regions;
+            //--Per frame slot, the culled draw command is copied back here and read once the slot's fence has passed--//
+            std::vector<device_buffer> readback;
+            std::vector<draw_indirect_command*> readback_memory;
+            std::vector<uint8_t> readback_ready;
+
+            vk::DescriptorSetLayout set_layout;
+            vk::DescriptorSet set;
+            vk::PipelineLayout cull_layout;
+            vk::Pipeline cull;
+            vk::PipelineLayout draw_layout;
+            vk::Pipeline draw;
+            //--Swapped in while render_manager is in overdraw mode, left unset if the counting shader is missing--//
+            vk::Pipeline draw_overdraw;
+        };
+        std::unique_ptr<info> info_p;
+
+        uint32_t pack_colour(const vml::vec4& colour) {
+            auto channel = [](float c) { return (uint32_t)(std::min(1.0f, std::max(0.0f, c)) * 255.0f + 0.5f); };
+            return channel(colour[0]) | channel(colour[1]) << 8 | channel(colour[2]) << 16 | channel(colour[3]) << 24;
+        }
+
+        bool load_shader(vk::ShaderModule& module, const std::string& file) {
+            std::vector<uint8_t> code = resource::resource_manager::read_binary_file(file, {"shaders"});
+            if (code.empty()) {
+                printf("Could not read shader '%s'\n", file.c_str());
+                return false;
+            }
+            return vulkan_wrapper::create_shader_module(module, code);
+        }
+
+        bool create_pipelines() {
+            vk::ShaderModule cull, vert, frag;
+            if (!load_shader(cull, "sprite_cull.cs.spv") || !load_shader(vert, "gpu_sprite.vs.spv") || !load_shader(frag, "default.fs.spv")) {
+                vulkan_wrapper::destroy_shader_module(cull);
+                vulkan_wrapper::destroy_shader_module(vert);
+                vulkan_wrapper::destroy_shader_module(frag);
+                return false;
+            }
+            bool built = false;
+            if (vulkan_wrapper::create_storage_descriptor_set_layout(info_p->set_layout, 3, vk::ShaderStageFlagBits::eCompute)) {
+                vk::PushConstantRange cull_range = {vk::ShaderStageFlagBits::eCompute, 0, sizeof(cull_constants)};
+                vk::PipelineLayoutCreateInfo cull_layout_create_info = {vk::PipelineLayoutCreateFlags(), 1, &info_p->set_layout, 1, &cull_range};
+                vk::PushConstantRange draw_range = {vk::ShaderStageFlagBits::eVertex, 0, sizeof(push_constants)};
+                vk::PipelineLayoutCreateInfo draw_layout_create_info = {vk::PipelineLayoutCreateFlags(), 0, nullptr, 1, &draw_range};
+                if (vulkan_wrapper::create_pipeline_layout(info_p->cull_layout, cull_layout_create_info) &&
+                    vulkan_wrapper::create_pipeline_layout(info_p->draw_layout, draw_layout_create_info)) {
+                    vk::PipelineShaderStageCreateInfo cull_stage = {vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eCompute, cull, "main"};
+                    vk::PipelineShaderStageCreateInfo draw_stages[2] = {
+                            {vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eVertex, vert, "main"},
+                            {vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eFragment, frag, "main"}};
+                    //--One instance per survivor, the quad's corners come from the vertex index--//
+                    vk::VertexInputBindingDescription binding = {0, sizeof(instance), vk::VertexInputRate::eInstance};
+                    vk::VertexInputAttributeDescription attributes[3] = {
+                            {0, 0, vk::Format::eR32G32B32A32Sfloat, (uint32_t)offsetof(instance, x)},
+                            {1, 0, vk::Format::eR32G32B32A32Sfloat, (uint32_t)offsetof(instance, u)},
+                            {2, 0, vk::Format::eR8G8B8A8Unorm, (uint32_t)offsetof(instance, colour)}};
+                    built = vulkan_wrapper::create_compute_pipeline(info_p->cull, info_p->cull_layout, cull_stage) &&
+                            vulkan_wrapper::create_pipeline(info_p->draw, info_p->draw_layout, 2, draw_stages, 1, &binding, 3, attributes, 1.0f);
+                    std::vector<uint8_t> code = resource::resource_manager::read_binary_file("overdraw.fs.spv", {"shaders"});
+                    vk::ShaderModule count;
+                    if (built && !code.empty() && vulkan_wrapper::create_shader_module(count, code)) {
+                        draw_stages[1] = {vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eFragment, count, "main"};
+                        vulkan_wrapper::create_pipeline(info_p->draw_overdraw, info_p->draw_layout, 2, draw_stages, 1, &binding, 3, attributes, 1.0f, vulkan_wrapper::pipeline_variant::overdraw_translucent);
+                        vulkan_wrapper::destroy_shader_module(count);
+                    }
+                }
+            }
+            vulkan_wrapper::destroy_shader_module(cull);
+            vulkan_wrapper::destroy_shader_module(vert);
+            vulkan_wrapper::destroy_shader_module(frag);
+            return built;
+        }
+
+        bool create_buffers() {
+            uint32_t size = (uint32_t)sizeof(instance) * info_p->capacity;
+            if (!vulkan_wrapper::create_buffer(info_p->device_instances.buffer, info_p->device_instances.memory, size,
+                                               vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, false) ||
+                !vulkan_wrapper::create_buffer(info_p->survivors.buffer, info_p->survivors.memory, size,
+                                               vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer, false) ||
+                !vulkan_wrapper::create_buffer(info_p->indirect.buffer, info_p->indirect.memory, (uint32_t)sizeof(draw_indirect_command),
+                                               vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer |
+                                               vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc, false)) {
+                return false;
+            }
+            uint32_t staging_size = (uint32_t)sizeof(instance) * std::min(info_p->capacity, STAGING_INSTANCES);
+            for (uint32_t i = 0; i < vulkan_wrapper::get_frame_count(); i++) {
+                device_buffer b;
+                if (!vulkan_wrapper::create_buffer(b.buffer, b.memory, staging_size, vk::BufferUsageFlagBits::eTransferSrc, true)) {
+                    return false;
+                }
+                info_p->staging.push_back(b);
+                info_p->staging_memory.push_back(static_cast<instance*>(vulkan_wrapper::map_memory(b.memory, staging_size)));
+                if (!vulkan_wrapper::create_buffer(b.buffer, b.memory, (uint32_t)sizeof(draw_indirect_command), vk::BufferUsageFlagBits::eTransferDst, true)) {
+                    return false;
+                }
+                info_p->readback.push_back(b);
+                info_p->readback_memory.push_back(static_cast<draw_indirect_command*>(vulkan_wrapper::map_memory(b.memory, (uint32_t)sizeof(draw_indirect_command))));
+                info_p->readback_ready.push_back(0);
+            }
+            if (!vulkan_wrapper::allocate_descriptor_set(info_p->set, info_p->set_layout)) {
+                return false;
+            }
+            vk::Buffer bound[3] = {info_p->device_instances.buffer, info_p->survivors.buffer, info_p->indirect.buffer};
+            vulkan_wrapper::write_storage_buffers(info_p->set, 3, bound);
+            return true;
+        }
+
+        void destroy_buffer(device_buffer& b) {
+            if (b.buffer) {
+                vulkan_wrapper::destroy_vertex_buffer(b.buffer, b.memory);
+            }
+            b = device_buffer();
+        }
+
+        void destroy_gpu() {
+            for (uint32_t i = 0; i < info_p->staging.size(); i++) {
+                vulkan_wrapper::unmap_memory(info_p->staging[i].memory);
+                destroy_buffer(info_p->staging[i]);
+            }
+            info_p->staging.clear();
+            info_p->staging_memory.clear();
+            for (device_buffer& b : info_p->readback) {
+                vulkan_wrapper::unmap_memory(b.memory);
+                destroy_buffer(b);
+            }
+            info_p->readback.clear();
+            info_p->readback_memory.clear();
+            info_p->readback_ready.clear();
+            destroy_buffer(info_p->device_instances);
+            destroy_buffer(info_p->survivors);
+            destroy_buffer(info_p->indirect);
+            if (info_p->set) {
+                vulkan_wrapper::free_descriptor_set(info_p->set);
+            }
+            if (info_p->cull) {
+                vulkan_wrapper::destroy_pipeline(info_p->cull);
+            }
+            if (info_p->draw) {
+                vulkan_wrapper::destroy_pipeline(info_p->draw);
+            }
+            if (info_p->draw_overdraw) {
+                vulkan_wrapper::destroy_pipeline(info_p->draw_overdraw);
+            }
+            if (info_p->cull_layout) {
+                vulkan_wrapper::destroy_pipeline_layout(info_p->cull_layout);
+            }
+            if (info_p->draw_layout) {
+                vulkan_wrapper::destroy_pipeline_layout(info_p->draw_layout);
+            }
+            if (info_p->set_layout) {
+                vulkan_wrapper::destroy_descriptor_set_layout(info_p->set_layout);
+            }
+            info_p->set = vk::DescriptorSet();
+            info_p->cull = info_p->draw = info_p->draw_overdraw = vk::Pipeline();
+            info_p->cull_layout = info_p->draw_layout = vk::PipelineLayout();
+            info_p->set_layout = vk::DescriptorSetLayout();
+            info_p->gpu = false;
+        }
+
+        void mark_dirty(uint32_t index) {
+            if (!info_p->is_dirty[index]) {
+                info_p->is_dirty[index] = 1;
+                info_p->dirty.push_back(index);
+            }
+        }
+
+        void build(uint32_t index) {
+            const source& s = info_p->sources[index];
+            instance& i = info_p->instances[index];
+            if (s.sprite == 0) {
+                i = {s.position[0], s.position[1], s.size[0], s.size[1], 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, i.colour, 1, 0.0f};
+            }
+            else {
+                const vml::vec4& trim = sprite_manager::get_trim(s.sprite);
+                const vml::mat3& t = sprite_manager::get_transform(s.sprite);
+                i.x = s.position[0] + trim[0] * s.size[0];
+                i.y = s.position[1] + trim[1] * s.size[1];
+                i.w = trim[2] * s.size[0];
+                i.h = trim[3] * s.size[1];
+                i.u = t[2][0];
+                i.v = t[2][1];
+                i.du = t[0][0];
+                i.dv = t[1][1];
+                i.layer = t[2][2];
+                i.visible = 1;
+            }
+            mark_dirty(index);
+        }
+
+        //--Corners in the same order as the rect_2D quad and gpu_sprite.vs.glsl--//
+        const float CORNERS[6][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+        void render_cpu(uint32_t pipeline) {
+            const bounds& view = info_p->view;
+            uint32_t drawn = 0;
+            for (const instance& i : info_p->instances) {
+                drawn += i.visible && bounds{i.x, i.y, i.x + i.w, i.y + i.h}.overlaps(view);
+            }
+            info_p->last.drawn = drawn;
+            if (drawn == 0) {
+                return;
+            }
+            uint32_t geometry, first;
+            vertex* out = render_manager::allocate_stream(drawn * 6, geometry, first);
+            if (!out) {
+                return;
+            }
+            //--Runs of one atlas layer share a draw, the layer is the only part of the texture transform left per draw--//
+            render_manager::bind_pipeline(pipeline);
+            render_manager::bind_geometry(geometry);
+            render_manager::set_model(vml::mat4::identity());
+            render_manager::set_colour_mult(vml::mat4::identity());
+            uint32_t run_first = first, run_count = 0;
+            float run_layer = 0.0f;
+            for (const instance& i : info_p->instances) {
+                if (!i.visible || !bounds{i.x, i.y, i.x + i.w, i.y + i.h}.overlaps(view)) {
+                    continue;
+                }
+                if (run_count > 0 && i.layer != run_layer) {
+                    render_manager::set_texture_transform(vml::mat3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, run_layer));
+                    render_manager::draw(run_count, 1, run_first, 0);
+                    run_first += run_count;
+                    run_count = 0;
+                }
+                run_layer = i.layer;
+                for (const float* c : CORNERS) {
+                    out->pos.data[0] = i.x + c[0] * i.w;
+                    out->pos.data[1] = i.y + c[1] * i.h;
+                    out->uv.data[0] = i.u + c[0] * i.du;
+                    out->uv.data[1] = i.v + c[1] * i.dv;
+                    out->colour = i.colour;
+                    out++;
+                }
+                run_count += 6;
+            }
+            render_manager::set_texture_transform(vml::mat3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, run_layer));
+            render_manager::draw(run_count, 1, run_first, 0);
+        }
+    }
+
+    void init(uint32_t capacity) {
+        info_p = std::make_unique<info>();
+        info_p->capacity = std::max(1u, capacity);
+        info_p->instances.reserve(info_p->capacity);
+        info_p->sources.reserve(info_p->capacity);
+        info_p->is_dirty.reserve(info_p->capacity);
+        if (!vulkan_wrapper::supports_compute()) {
+            printf("The graphics queue can't dispatch compute, sprites will be culled on the CPU\n");
+            return;
+        }
+        info_p->gpu = create_pipelines() && create_buffers();
+        if (!info_p->gpu) {
+            printf("Could not create the sprite culling pass, sprites will be culled on the CPU\n");
+            destroy_gpu();
+        }
+    }
+
+    bool is_gpu() {
+        return info_p && info_p->gpu;
+    }
+
+    uint32_t create(uint32_t sprite, const vml::vec2& position, const vml::vec2& size, const vml::vec4& colour) {
+        uint32_t index;
+        if (!info_p->free_instances.empty()) {
+            index = info_p->free_instances.back();
+            info_p->free_instances.pop_back();
+        }
+        else if (info_p->instances.size() < info_p->capacity) {
+            index = (uint32_t)info_p->instances.size();
+            info_p->instances.emplace_back();
+            info_p->sources.emplace_back();
+            info_p->is_dirty.push_back(0);
+        }
+        else {
+            return 0;
+        }
+        info_p->last.instances++;
+        info_p->sources[index] = {sprite, position, size};
+        info_p->instances[index].colour = pack_colour(colour);
+        build(index);
+        return index + 1;
+    }
+
+    void set(uint32_t id, uint32_t sprite, const vml::vec2& position, const vml::vec2& size, const vml::vec4& colour) {
+        if (id == 0 || id > info_p->instances.size() || !info_p->instances[id - 1].visible) {
+            return;
+        }
+        info_p->sources[id - 1] = {sprite, position, size};
+        info_p->instances[id - 1].colour = pack_colour(colour);
+        build(id - 1);
+    }
+
+    void set_position(uint32_t id, const vml::vec2& position) {
+        if (id == 0 || id > info_p->instances.size() || !info_p->instances[id - 1].visible) {
+            return;
+        }
+        info_p->sources[id - 1].position = position;
+        build(id - 1);
+    }
+
+    void destroy(uint32_t id) {
+        if (id == 0 || id > info_p->instances.size() || !info_p->instances[id - 1].visible) {
+            return;
+        }
+        //--The slot stays in the device buffer hidden until it is reused--//
+        info_p->instances[id - 1].visible = 0;
+        mark_dirty(id - 1);
+        info_p->free_instances.push_back(id - 1);
+        info_p->last.instances--;
+    }
+
+    void set_view(const bounds& view) {
+        info_p->view = view;
+    }
+
+    void begin_frame(uint32_t frame) {
+        if (!info_p) {
+            return;
+        }
+        info_p->frame = frame;
+        info_p->last.uploaded = 0;
+        info_p->last.upload_regions = 0;
+        info_p->last.drawn = 0;
+        info_p->last.gpu = info_p->gpu;
+        if (frame < info_p->readback_ready.size() && info_p->readback_ready[frame]) {
+            info_p->last.drawn = info_p->readback_memory[frame]->instance_count;
+        }
+    }
+
+    void prepare() {
+        if (!info_p) {
+            return;
+        }
+        if (!info_p->gpu) {
+            //--The CPU path reads the instances directly--//
+            for (uint32_t index : info_p->dirty) {
+                info_p->is_dirty[index] = 0;
+            }
+            info_p->dirty.clear();
+            return;
+        }
+        //--Last frame's draw, cull and readback copy read and wrote the buffers about to be overwritten--//
+        vulkan_wrapper::memory_barrier(vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eDrawIndirect |
+                                       vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+                                       vk::AccessFlagBits::eShaderWrite,
+                                       vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader,
+                                       vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite);
+        if (!info_p->cleared) {
+            vulkan_wrapper::fill_buffer(info_p->device_instances.buffer, 0, VK_WHOLE_SIZE, 0);
+            vulkan_wrapper::memory_barrier(vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite,
+                                           vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite);
+            info_p->cleared = true;
+        }
+
+        //--Changed instances are copied in index order so neighbours merge into one region--//
+        std::vector<uint32_t>& dirty = info_p->dirty;
+        std::sort(dirty.begin(), dirty.end());
+        uint32_t count = std::min((uint32_t)dirty.size(), std::min(info_p->capacity, STAGING_INSTANCES));
+        instance* staging = info_p->staging_memory[info_p->frame];
+        info_p->regions.clear();
+        for (uint32_t n = 0; n < count; n++) {
+            uint32_t index = dirty[n];
+            staging[n] = info_p->instances[index];
+            info_p->is_dirty[index] = 0;
+            if (!info_p->regions.empty() && n > 0 && dirty[n - 1] + 1 == index) {
+                info_p->regions.back().size += sizeof(instance);
+            }
+            else {
+                info_p->regions.push_back({(vk::DeviceSize)n * sizeof(instance), (vk::DeviceSize)index * sizeof(instance), sizeof(instance)});
+            }
+        }
+        dirty.erase(dirty.begin(), dirty.begin() + count);
+        vulkan_wrapper::copy_buffer(info_p->staging[info_p->frame].buffer, info_p->device_instances.buffer, (uint32_t)info_p->regions.size(), info_p->regions.data());
+        draw_indirect_command reset = {6, 0, 0, 0};
+        vulkan_wrapper::update_buffer(info_p->indirect.buffer, 0, sizeof(reset), &reset);
+        info_p->last.uploaded = count;
+        info_p->last.upload_regions = (uint32_t)info_p->regions.size();
+
+        vulkan_wrapper::memory_barrier(vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite,
+                                       vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+        uint32_t used = (uint32_t)info_p->instances.size();
+        cull_constants constants = {{info_p->view.min_x, info_p->view.min_y, info_p->view.max_x, info_p->view.max_y}, used};
+        vulkan_wrapper::bind_compute_pipeline(info_p->cull);
+        vulkan_wrapper::bind_descriptor_set(vk::PipelineBindPoint::eCompute, info_p->cull_layout, info_p->set);
+        vulkan_wrapper::push_constants(info_p->cull_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(constants), &constants);
+        vulkan_wrapper::dispatch((used + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+        vulkan_wrapper::memory_barrier(vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite,
+                                       vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eTransfer,
+                                       vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eTransferRead);
+        vk::BufferCopy count_copy = {0, 0, sizeof(draw_indirect_command)};
+        vulkan_wrapper::copy_buffer(info_p->indirect.buffer, info_p->readback[info_p->frame].buffer, 1, &count_copy);
+        info_p->readback_ready[info_p->frame] = 1;
+    }
+
+    void render(uint32_t fallback_pipeline) {
+        if (!info_p || info_p->instances.empty()) {
+            return;
+        }
+        if (!info_p->gpu) {
+            render_cpu(fallback_pipeline);
+            return;
+        }
+        push_constants pc;
+        pc.p = render_manager::get_perspective();
+        pc.v = render_manager::get_view();
+        pc.m = vml::mat4::identity();
+        pc.tt = vml::mat3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+        pc.cm = vml::mat4::identity();
+        vk::DeviceSize offset = 0;
+        vulkan_wrapper::bind_pipeline(render_manager::get_overdraw_mode() && info_p->draw_overdraw ? info_p->draw_overdraw : info_p->draw);
+        vulkan_wrapper::bind_vertex_buffers(1, &info_p->survivors.buffer, &offset);
+        vulkan_wrapper::push_constants(info_p->draw_layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(push_constants), &pc);
+        vulkan_wrapper::draw_indirect(info_p->indirect.buffer, 0, 1, sizeof(draw_indirect_command));
+    }
+
+    stats get_stats() {
+        return info_p ? info_p->last : stats{0, 0, 0, 0, false};
+    }
+
+    void terminate() {
+        if (!info_p) {
+            return;
+        }
+        destroy_gpu();
+        info_p.reset(nullptr);
+    }
+}
@@ -1,35 +1,103 @@
 #include "render/render_manager.hpp"
 
 #include "vulkan_wrapper.hpp"
+#include "job/job_system.hpp"
+#include "platform/platform.hpp"
 #include "render/push_constants.hpp"
 #include "render/vertex.hpp"
+#include "resource/png.hpp"
 #include "resource/resource_manager.hpp"
 
-#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
 
 namespace render::render_manager {
         namespace {
+            //--Both variants share the layout and shaders, only blending and depth writes differ--//
             struct pipeline {
                 vk::PipelineLayout layout;
                 vk::Pipeline pl;
+                vk::Pipeline opaque;
+                //--Only built in overdraw mode, the same again with the counting fragment shader--//
+                vk::Pipeline overdraw;
+                vk::Pipeline overdraw_opaque;
+            };
+
+            struct geometry {
+                vk::Buffer buffer;
+                vk::DeviceMemory memory;
+            };
+
+            struct static_range {
+                uint32_t block;
+                uint32_t first;
+                uint32_t count;
+            };
+            //--A persistently mapped buffer that many static allocations share, free ranges are kept sorted by first--//
+            struct static_block {
+                uint32_t geometry;
+                vertex* memory;
+                uint32_t capacity;
+                std::vector<static_range> free;
             };
 
             struct info {
-                std::map<std::string, uint32_t> name_id_map;
-                std::map<uint32_t, pipeline> id_pipeline_map;
-                uint32_t next_id = 1;
+                //--Handles are indices into the name and pipeline lists plus one, 0 is no pipeline--//
+                std::unordered_map<resource::name_id, uint32_t> name_id_map;
+                std::vector<std::string> name_list;
+                std::vector<pipeline> pipeline_list;
                 bool loaded = false;
 
+                //--Per pipeline, whether a rebuild is running and whether its files changed again since it started--//
+                std::vector<uint8_t> rebuild_state;
+                job::job_system::counter rebuilds;
+                bool watching = false;
+
                 vk::Buffer rect_2D;
                 vk::DeviceMemory rect_2D_memory;
                 vk::DeviceSize* offsets = nullptr;
 
+                //--Handles are indices plus one like pipelines, freed slots are reused--//
+                std::vector<geometry> geometry_list;
+                std::vector<uint32_t> free_geometry;
+
+                //--One persistently mapped buffer per frame in flight, entries in geometry_list so they bind like any other--//
+                std::vector<uint32_t> stream_geometry;
+                std::vector<vertex*> stream_memory;
+                std::vector<uint32_t> stream_capacity;
+                uint32_t stream_frame = 0;
+                uint32_t stream_used = 0;
+                uint32_t stream_wanted = 0;
+
+                std::vector<static_block> static_blocks;
+                //--Ranges released while a frame slot was recording, they go back to the blocks when that slot comes round again--//
+                std::vector<std::vector<static_range>> static_retired;
+
                 push_constants current_pc;
-                pipeline* current_pl = nullptr;
+                //--An id rather than a pointer, pipeline_list can reallocate while a pipeline is bound--//
+                uint32_t current_pl = 0;
+
+                bool overdraw = false;
+                //--Per pixel counts from the most recent capture--//
+                std::vector<uint8_t> overdraw_counts;
+                uint32_t overdraw_width = 0;
+                uint32_t overdraw_height = 0;
+                uint32_t overdraw_max = 0;
             };
             std::unique_ptr<info> info_p;
 
-            bool load_pipeline(const std::string& name, pipeline& pipeline) {
+            //--Starting size of each stream buffer, they grow to the most any frame asked for--//
+            const uint32_t STREAM_VERTICES = 65536;
+            //--Size of each shared static buffer, larger allocations get a block of their own--//
+            const uint32_t STATIC_BLOCK_VERTICES = 262144;
+
+            const uint8_t REBUILD_IDLE = 0;
+            const uint8_t REBUILD_RUNNING = 1;
+            const uint8_t REBUILD_AGAIN = 2;
+
+            bool load_pipeline(const std::string& name, pipeline& pipeline, bool overdraw) {
                 vk::ShaderModule vert, frag;
                 if (!vulkan_wrapper::create_shader_module(vert,
                                                        resource::resource_manager::read_binary_file(name + ".vs.spv",
@@ -66,20 +134,142 @@ namespace render::render_manager {
                 vk::VertexInputBindingDescription vertexInputBindingDescription = {0,
                                                                                    sizeof(vertex),
                                                                                    vk::VertexInputRate::eVertex};
-                vk::VertexInputAttributeDescription vertexInputAttributeDescriptions[2];
+                vk::VertexInputAttributeDescription vertexInputAttributeDescriptions[3];
                 vertexInputAttributeDescriptions[0] = {0, 0, vk::Format::eR32G32Sfloat, (uint32_t)offsetof(vertex, pos)};
                 vertexInputAttributeDescriptions[1] = {1, 0, vk::Format::eR32G32Sfloat, (uint32_t)offsetof(vertex, uv)};
+                vertexInputAttributeDescriptions[2] = {2, 0, vk::Format::eR8G8B8A8Unorm, (uint32_t)offsetof(vertex, colour)};
 
-                if (!vulkan_wrapper::create_pipeline(pipeline.pl, pipeline.layout, 2, shader_stage_create_infos, 1, &vertexInputBindingDescription, 2, vertexInputAttributeDescriptions, 1.0f)) {
+                if (!vulkan_wrapper::create_pipeline(pipeline.pl, pipeline.layout, 2, shader_stage_create_infos, 1, &vertexInputBindingDescription, 3, vertexInputAttributeDescriptions, 1.0f)) {
+                    vulkan_wrapper::destroy_shader_module(vert);
+                    vulkan_wrapper::destroy_shader_module(frag);
+                    vulkan_wrapper::destroy_pipeline_layout(pipeline.layout);
+                    return false;
+                }
+                if (!vulkan_wrapper::create_pipeline(pipeline.opaque, pipeline.layout, 2, shader_stage_create_infos, 1, &vertexInputBindingDescription, 3, vertexInputAttributeDescriptions, 1.0f, vulkan_wrapper::pipeline_variant::opaque)) {
                     vulkan_wrapper::destroy_shader_module(vert);
                     vulkan_wrapper::destroy_shader_module(frag);
+                    vulkan_wrapper::destroy_pipeline(pipeline.pl);
                     vulkan_wrapper::destroy_pipeline_layout(pipeline.layout);
                     return false;
                 }
+                bool built = true;
+                if (overdraw) {
+                    vk::ShaderModule count;
+                    std::vector<uint8_t> code = resource::resource_manager::read_binary_file("overdraw.fs.spv", {"shaders"});
+                    built = !code.empty() && vulkan_wrapper::create_shader_module(count, code);
+                    if (built) {
+                        shader_stage_create_infos[1] = vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(),
+                                                                                      vk::ShaderStageFlagBits::eFragment, count,
+                                                                                      "main");
+                        built = vulkan_wrapper::create_pipeline(pipeline.overdraw, pipeline.layout, 2, shader_stage_create_infos, 1, &vertexInputBindingDescription, 3, vertexInputAttributeDescriptions, 1.0f, vulkan_wrapper::pipeline_variant::overdraw_translucent) &&
+                                vulkan_wrapper::create_pipeline(pipeline.overdraw_opaque, pipeline.layout, 2, shader_stage_create_infos, 1, &vertexInputBindingDescription, 3, vertexInputAttributeDescriptions, 1.0f, vulkan_wrapper::pipeline_variant::overdraw_opaque);
+                        vulkan_wrapper::destroy_shader_module(count);
+                    }
+                    if (!built) {
+                        vulkan_wrapper::destroy_pipeline(pipeline.pl);
+                        vulkan_wrapper::destroy_pipeline(pipeline.opaque);
+                        vulkan_wrapper::destroy_pipeline(pipeline.overdraw);
+                        vulkan_wrapper::destroy_pipeline_layout(pipeline.layout);
+                    }
+                }
 
                 vulkan_wrapper::destroy_shader_module(vert);
                 vulkan_wrapper::destroy_shader_module(frag);
-                return true;
+                return built;
+            }
+
+            //--Layouts are shared by every variant so only the first retirement takes it--//
+            void retire_pipeline(const pipeline& pl) {
+                vulkan_wrapper::retire_pipeline(pl.pl, pl.layout);
+                vulkan_wrapper::retire_pipeline(pl.opaque, vk::PipelineLayout());
+                if (pl.overdraw) {
+                    vulkan_wrapper::retire_pipeline(pl.overdraw, vk::PipelineLayout());
+                    vulkan_wrapper::retire_pipeline(pl.overdraw_opaque, vk::PipelineLayout());
+                }
+            }
+
+            //--The old buffer is retired rather than destroyed, though its frame's fence has already been waited on--//
+            void create_stream(uint32_t slot, uint32_t vertices) {
+                geometry& g = info_p->geometry_list[info_p->stream_geometry[slot] - 1];
+                if (g.buffer) {
+                    vulkan_wrapper::unmap_memory(g.memory);
+                    vulkan_wrapper::retire_vertex_buffer(g.buffer, g.memory);
+                    g = geometry();
+                }
+                info_p->stream_memory[slot] = nullptr;
+                info_p->stream_capacity[slot] = 0;
+                if (!vulkan_wrapper::create_vertex_buffer(g.buffer, g.memory, (uint32_t)sizeof(vertex) * vertices)) {
+                    printf("Could not create a stream buffer of %u vertices\n", vertices);
+                    g = geometry();
+                    return;
+                }
+                info_p->stream_memory[slot] = static_cast<vertex*>(vulkan_wrapper::map_memory(g.memory, (uint32_t)sizeof(vertex) * vertices));
+                info_p->stream_capacity[slot] = vertices;
+            }
+
+            //--First fit, the range is taken from the front of the free range it came from--//
+            bool take_static(static_block& b, uint32_t count, uint32_t& first) {
+                for (auto it = b.free.begin(); it != b.free.end(); ++it) {
+                    if (it->count >= count) {
+                        first = it->first;
+                        it->first += count;
+                        it->count -= count;
+                        if (it->count == 0) {
+                            b.free.erase(it);
+                        }
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            //--Merged with its neighbours so the block doesn't fragment into pieces no chunk fits--//
+            void return_static(const static_range& r) {
+                std::vector<static_range>& free = info_p->static_blocks[r.block].free;
+                auto it = std::lower_bound(free.begin(), free.end(), r.first, [](const static_range& a, uint32_t first) { return a.first < first; });
+                it = free.insert(it, r);
+                auto next = it + 1;
+                if (next != free.end() && it->first + it->count == next->first) {
+                    it->count += next->count;
+                    free.erase(next);
+                }
+                if (it != free.begin()) {
+                    auto prev = it - 1;
+                    if (prev->first + prev->count == it->first) {
+                        prev->count += it->count;
+                        free.erase(it);
+                    }
+                }
+            }
+
+            //--Built on a worker, the swap runs on the main thread between frames and the old pipeline is retired rather than destroyed--//
+            void rebuild_pipeline(uint32_t index) {
+                info_p->rebuild_state[index] = REBUILD_RUNNING;
+                std::string name = info_p->name_list[index];
+                bool overdraw = info_p->overdraw;
+                job::job_system::run([index, name, overdraw]() {
+                    pipeline pl;
+                    bool built = load_pipeline(name, pl, overdraw);
+                    job::job_system::run_on_main([index, name, built, pl]() {
+                        if (built && info_p->loaded) {
+                            pipeline& old = info_p->pipeline_list[index];
+                            retire_pipeline(old);
+                            old = pl;
+                            printf("Reloaded pipeline '%s'\n", name.c_str());
+                        }
+                        else if (built) {
+                            retire_pipeline(pl);
+                        }
+                        else {
+                            printf("Could not reload pipeline '%s', keeping the previous one\n", name.c_str());
+                        }
+                        bool again = info_p->rebuild_state[index] == REBUILD_AGAIN;
+                        info_p->rebuild_state[index] = REBUILD_IDLE;
+                        if (again && info_p->loaded) {
+                            rebuild_pipeline(index);
+                        }
+                    }, &info_p->rebuilds);
+                }, &info_p->rebuilds);
             }
         }
 
@@ -95,37 +285,62 @@ namespace render::render_manager {
             vulkan_wrapper::create_vertex_buffer(info_p->rect_2D, info_p->rect_2D_memory, sizeof(vertex) * vertices_2D.size());
             vulkan_wrapper::map_vertex_buffer(info_p->rect_2D_memory, sizeof(vertex) * vertices_2D.size(), vertices_2D.data());
             info_p->offsets = new vk::DeviceSize[1]{0};
+            for (uint32_t i = 0; i < vulkan_wrapper::get_frame_count(); i++) {
+                info_p->geometry_list.push_back(geometry());
+                info_p->stream_geometry.push_back((uint32_t)info_p->geometry_list.size());
+                info_p->stream_memory.push_back(nullptr);
+                info_p->stream_capacity.push_back(0);
+                create_stream(i, STREAM_VERTICES);
+            }
+            info_p->static_retired.resize(vulkan_wrapper::get_frame_count());
             reset_push_constants();
         }
 
         bool create_graphics_pipeline(const std::string& name) {
-            info_p->name_id_map.insert(std::pair<const std::string, uint32_t>(name, info_p->next_id));
+            resource::name_id hash = resource::hash_name(name);
+            auto it = info_p->name_id_map.find(hash);
+            if (it != info_p->name_id_map.end()) {
+                if (info_p->name_list[it->second - 1] != name) {
+                    printf("Pipeline name '%s' collides with '%s'\n", name.c_str(), info_p->name_list[it->second - 1].c_str());
+                    return false;
+                }
+                return true;
+            }
+            //--Loaded before it is registered so a failure can't leave the name and pipeline lists out of step--//
             if (info_p->loaded) {
                 pipeline pl;
-                if (!load_pipeline(name, pl)) {
+                if (!load_pipeline(name, pl, info_p->overdraw)) {
                     return false;
                 }
-                info_p->id_pipeline_map.insert(std::pair<const uint32_t, pipeline>(info_p->next_id, pl));
+                info_p->pipeline_list.push_back(pl);
             }
-            info_p->next_id++;
+            info_p->name_list.push_back(name);
+            info_p->rebuild_state.push_back(REBUILD_IDLE);
+            info_p->name_id_map.insert(std::pair<const resource::name_id, uint32_t>(hash, (uint32_t)info_p->name_list.size()));
             return true;
         }
 
-        uint32_t get_pipeline(const std::string& name) {
+        uint32_t get_pipeline(resource::name_id name) {
             auto it = info_p->name_id_map.find(name);
             if (it != info_p->name_id_map.end()) {
                 return it->second;
             }
             return 0;
         }
+        uint32_t get_pipeline(const std::string& name) {
+            return get_pipeline(resource::hash_name(name));
+        }
 
-        void bind_pipeline(uint32_t id) {
-            if (id > 0) {
-                auto it = info_p->id_pipeline_map.find(id);
-                if (it != info_p->id_pipeline_map.end()) {
-                    vulkan_wrapper::bind_pipeline(it->second.pl);
-                    info_p->current_pl = &it->second;
+        void bind_pipeline(uint32_t id, bool opaque) {
+            if (id > 0 && id <= info_p->pipeline_list.size()) {
+                pipeline& pl = info_p->pipeline_list[id - 1];
+                if (info_p->overdraw && pl.overdraw) {
+                    vulkan_wrapper::bind_pipeline(opaque ? pl.overdraw_opaque : pl.overdraw);
+                }
+                else {
+                    vulkan_wrapper::bind_pipeline(opaque ? pl.opaque : pl.pl);
                 }
+                info_p->current_pl = id;
             }
         }
 
@@ -144,6 +359,12 @@ namespace render::render_manager {
         void set_view(const vml::mat4& view) {
             info_p->current_pc.v = view;
         }
+        const vml::mat4& get_perspective() {
+            return info_p->current_pc.p;
+        }
+        const vml::mat4& get_view() {
+            return info_p->current_pc.v;
+        }
         void set_model(const vml::mat4& mode) {
             info_p->current_pc.m = mode;
         }
@@ -153,49 +374,295 @@ namespace render::render_manager {
         void set_colour_mult(const vml::mat4& cm) {
             info_p->current_pc.cm = cm;
         }
+        void set_depth(float depth) {
+            info_p->current_pc.m[3][2] = depth;
+        }
+
+        bool has_depth_buffer() {
+            return vulkan_wrapper::has_depth_buffer();
+        }
 
         void draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) {
-            vulkan_wrapper::push_constants(info_p->current_pl->layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(push_constants), &info_p->current_pc);
+            if (info_p->current_pl == 0) {
+                return;
+            }
+            const pipeline& pl = info_p->pipeline_list[info_p->current_pl - 1];
+            vulkan_wrapper::push_constants(pl.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(push_constants), &info_p->current_pc);
             vulkan_wrapper::draw(vertex_count, instance_count, first_vertex, first_instance);
         }
-        void draw_rect_2D() {
+        void bind_rect_2D() {
             vulkan_wrapper::bind_vertex_buffers(1, &info_p->rect_2D, info_p->offsets);
+        }
+        void draw_rect_2D() {
+            bind_rect_2D();
             draw(6, 1, 0, 0);
         }
 
+        uint32_t create_geometry(const vertex* vertices, uint32_t count) {
+            if (count == 0) {
+                return 0;
+            }
+            geometry g;
+            uint32_t size = (uint32_t)sizeof(vertex) * count;
+            if (!vulkan_wrapper::create_vertex_buffer(g.buffer, g.memory, size)) {
+                printf("Could not create a vertex buffer of %u vertices\n", count);
+                return 0;
+            }
+            vulkan_wrapper::map_vertex_buffer(g.memory, size, vertices);
+            if (!info_p->free_geometry.empty()) {
+                uint32_t index = info_p->free_geometry.back();
+                info_p->free_geometry.pop_back();
+                info_p->geometry_list[index] = g;
+                return index + 1;
+            }
+            info_p->geometry_list.push_back(g);
+            return (uint32_t)info_p->geometry_list.size();
+        }
+        void destroy_geometry(uint32_t id) {
+            if (id == 0 || id > info_p->geometry_list.size() || !info_p->geometry_list[id - 1].buffer) {
+                return;
+            }
+            geometry& g = info_p->geometry_list[id - 1];
+            vulkan_wrapper::retire_vertex_buffer(g.buffer, g.memory);
+            g = geometry();
+            info_p->free_geometry.push_back(id - 1);
+        }
+        void bind_geometry(uint32_t id) {
+            if (id > 0 && id <= info_p->geometry_list.size()) {
+                vulkan_wrapper::bind_vertex_buffers(1, &info_p->geometry_list[id - 1].buffer, info_p->offsets);
+            }
+        }
+
+        uint32_t allocate_static(const vertex* vertices, uint32_t count, uint32_t& first) {
+            if (count == 0) {
+                return 0;
+            }
+            uint32_t block = 0;
+            while (block < info_p->static_blocks.size() && !take_static(info_p->static_blocks[block], count, first)) {
+                block++;
+            }
+            if (block == info_p->static_blocks.size()) {
+                static_block b = {0, nullptr, std::max(STATIC_BLOCK_VERTICES, count), {}};
+                geometry g;
+                uint32_t size = (uint32_t)sizeof(vertex) * b.capacity;
+                if (!vulkan_wrapper::create_vertex_buffer(g.buffer, g.memory, size)) {
+                    printf("Could not create a static buffer of %u vertices\n", b.capacity);
+                    return 0;
+                }
+                b.memory = static_cast<vertex*>(vulkan_wrapper::map_memory(g.memory, size));
+                info_p->geometry_list.push_back(g);
+                b.geometry = (uint32_t)info_p->geometry_list.size();
+                b.free.push_back({block, count, b.capacity - count});
+                if (b.free.back().count == 0) {
+                    b.free.clear();
+                }
+                first = 0;
+                info_p->static_blocks.push_back(std::move(b));
+            }
+            static_block& b = info_p->static_blocks[block];
+            //--Nothing in flight reads a free range, so it is written in place without a staging copy--//
+            std::copy(vertices, vertices + count, b.memory + first);
+            vulkan_wrapper::add_uploaded_bytes((uint64_t)sizeof(vertex) * count);
+            return b.geometry;
+        }
+        void release_static(uint32_t geometry, uint32_t first, uint32_t count) {
+            if (geometry == 0 || count == 0) {
+                return;
+            }
+            for (uint32_t block = 0; block < info_p->static_blocks.size(); block++) {
+                if (info_p->static_blocks[block].geometry == geometry) {
+                    info_p->static_retired[info_p->stream_frame].push_back({block, first, count});
+                    return;
+                }
+            }
+        }
+
+        vertex* allocate_stream(uint32_t count, uint32_t& geometry, uint32_t& first) {
+            if (info_p->stream_frame >= info_p->stream_memory.size() || !info_p->stream_memory[info_p->stream_frame]) {
+                return nullptr;
+            }
+            if (count > info_p->stream_capacity[info_p->stream_frame] - info_p->stream_used) {
+                //--Every slot is regrown to fit when it next comes round, this frame goes without--//
+                info_p->stream_wanted = std::max(info_p->stream_wanted, info_p->stream_used + count);
+                return nullptr;
+            }
+            geometry = info_p->stream_geometry[info_p->stream_frame];
+            first = info_p->stream_used;
+            info_p->stream_used += count;
+            //--The caller writes straight into mapped memory, so it is counted as uploaded here--//
+            vulkan_wrapper::add_uploaded_bytes((uint64_t)sizeof(vertex) * count);
+            return info_p->stream_memory[info_p->stream_frame] + first;
+        }
+
+        void begin_frame(uint32_t frame) {
+            info_p->stream_frame = frame;
+            info_p->stream_used = 0;
+            if (frame < info_p->static_retired.size()) {
+                for (const static_range& r : info_p->static_retired[frame]) {
+                    return_static(r);
+                }
+                info_p->static_retired[frame].clear();
+            }
+            if (frame < info_p->stream_capacity.size() && info_p->stream_wanted > info_p->stream_capacity[frame]) {
+                create_stream(frame, std::max(info_p->stream_wanted, info_p->stream_capacity[frame] * 2));
+            }
+        }
+
         bool load_shaders() {
-            for (const std::pair<const std::string, uint32_t>& nPair : info_p->name_id_map) {
+            info_p->pipeline_list.reserve(info_p->name_list.size());
+            for (const std::string& name : info_p->name_list) {
                 pipeline pl;
-                if (!load_pipeline(nPair.first, pl)) {
+                if (!load_pipeline(name, pl, info_p->overdraw)) {
                     unload_shaders();
                     return false;
                 }
-                info_p->id_pipeline_map.insert(std::pair<const uint32_t, pipeline>(nPair.second, pl));
+                info_p->pipeline_list.push_back(pl);
             }
             return (info_p->loaded = true);
         }
 
         void unload_shaders() {
-            for (const std::pair<const uint32_t, pipeline>& pPair : info_p->id_pipeline_map) {
-                vulkan_wrapper::destroy_pipeline_layout(pPair.second.layout);
-                vulkan_wrapper::destroy_pipeline(pPair.second.pl);
+            for (const pipeline& pl : info_p->pipeline_list) {
+                vulkan_wrapper::destroy_pipeline_layout(pl.layout);
+                vulkan_wrapper::destroy_pipeline(pl.pl);
+                vulkan_wrapper::destroy_pipeline(pl.opaque);
+                vulkan_wrapper::destroy_pipeline(pl.overdraw);
+                vulkan_wrapper::destroy_pipeline(pl.overdraw_opaque);
             }
-            info_p->id_pipeline_map.clear();
+            info_p->pipeline_list.clear();
+            info_p->current_pl = 0;
             info_p->loaded = false;
         }
 
         bool reload_shaders() {
+            job::job_system::wait(&info_p->rebuilds);
             unload_shaders();
             return load_shaders();
         }
 
+        bool set_overdraw_mode(bool enabled) {
+            if (enabled == info_p->overdraw) {
+                return true;
+            }
+            info_p->overdraw = enabled;
+            if (!info_p->loaded) {
+                return true;
+            }
+            //--Every pipeline is rebuilt, so nothing in flight can still be using the old ones--//
+            vulkan_wrapper::wait_idle();
+            if (reload_shaders()) {
+                return true;
+            }
+            printf("Could not build the overdraw pipelines, check overdraw.fs.spv\n");
+            info_p->overdraw = !enabled;
+            reload_shaders();
+            return false;
+        }
+        bool get_overdraw_mode() {
+            return info_p->overdraw;
+        }
+
+        bool capture_overdraw() {
+            return info_p->overdraw && vulkan_wrapper::request_capture();
+        }
+
+        bool get_overdraw(overdraw_stats& stats) {
+            std::vector<uint8_t> pixels;
+            uint32_t width, height;
+            if (!vulkan_wrapper::read_capture(pixels, width, height)) {
+                return false;
+            }
+            //--Every channel holds the count, red is read--//
+            size_t count = (size_t)width * height;
+            info_p->overdraw_counts.resize(count);
+            stats = overdraw_stats();
+            stats.width = width;
+            stats.height = height;
+            uint64_t total = 0;
+            for (size_t i = 0; i < count; i++) {
+                uint8_t c = pixels[i * 4];
+                info_p->overdraw_counts[i] = c;
+                total += c;
+                stats.max = std::max(stats.max, (uint32_t)c);
+                stats.histogram[std::min((uint32_t)c, OVERDRAW_BUCKETS - 1)]++;
+            }
+            stats.average = count > 0 ? (double)total / (double)count : 0.0;
+            info_p->overdraw_width = width;
+            info_p->overdraw_height = height;
+            info_p->overdraw_max = stats.max;
+            return true;
+        }
+
+        bool write_overdraw_heatmap(const std::string& path) {
+            if (info_p->overdraw_counts.empty()) {
+                return false;
+            }
+            std::vector<uint8_t> pixels(info_p->overdraw_counts.size() * 4);
+            float scale = info_p->overdraw_max > 0 ? 3.0f / (float)info_p->overdraw_max : 0.0f;
+            for (size_t i = 0; i < info_p->overdraw_counts.size(); i++) {
+                //--Red fills in over the first third, then green, then blue--//
+                float t = (float)info_p->overdraw_counts[i] * scale;
+                pixels[i * 4 + 0] = (uint8_t)(std::min(1.0f, t) * 255.0f);
+                pixels[i * 4 + 1] = (uint8_t)(std::min(1.0f, std::max(0.0f, t - 1.0f)) * 255.0f);
+                pixels[i * 4 + 2] = (uint8_t)(std::min(1.0f, std::max(0.0f, t - 2.0f)) * 255.0f);
+                pixels[i * 4 + 3] = 255;
+            }
+            return resource::png::write(path, pixels.data(), info_p->overdraw_width, info_p->overdraw_height);
+        }
+
+        bool watch_shaders() {
+            info_p->watching = platform::watcher::watch(resource::resource_manager::get_folder_path({"shaders"}));
+            return info_p->watching;
+        }
+
+        void update_shaders() {
+            if (!info_p->watching || !info_p->loaded) {
+                return;
+            }
+            for (const std::string& file : platform::watcher::poll()) {
+                //--Both stages share the pipeline name, "name.vs.spv" and "name.fs.spv"--//
+                size_t stage = file.rfind(".spv");
+                if (stage == std::string::npos || stage < 3 || stage + 4 != file.size()) {
+                    continue;
+                }
+                auto it = info_p->name_id_map.find(resource::hash_name(file.substr(0, stage - 3)));
+                if (it == info_p->name_id_map.end()) {
+                    continue;
+                }
+                uint32_t index = it->second - 1;
+                if (info_p->rebuild_state[index] != REBUILD_IDLE) {
+                    info_p->rebuild_state[index] = REBUILD_AGAIN;
+                    continue;
+                }
+                rebuild_pipeline(index);
+            }
+        }
+
         void terminate() {
+            job::job_system::wait(&info_p->rebuilds);
+            if (info_p->watching) {
+                platform::watcher::terminate();
+            }
             if (info_p->loaded) {
                 unload_shaders();
             }
             delete[] info_p->offsets;
             vulkan_wrapper::destroy_vertex_buffer(info_p->rect_2D, info_p->rect_2D_memory);
+            for (uint32_t id : info_p->stream_geometry) {
+                if (info_p->geometry_list[id - 1].buffer) {
+                    vulkan_wrapper::unmap_memory(info_p->geometry_list[id - 1].memory);
+                }
+            }
+            for (const static_block& b : info_p->static_blocks) {
+                vulkan_wrapper::unmap_memory(info_p->geometry_list[b.geometry - 1].memory);
+            }
+            for (const geometry& g : info_p->geometry_list) {
+                if (g.buffer) {
+                    vulkan_wrapper::destroy_vertex_buffer(g.buffer, g.memory);
+                }
+            }
             info_p->name_id_map.clear();
+            info_p->name_list.clear();
             info_p.reset(nullptr);
         }
     }
\ No newline at end of file
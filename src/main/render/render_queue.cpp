@@ -0,0 +1,164 @@
+#include "render/render_queue.hpp"
+
+#include <cstring>
+#include <memory>
+
+#include "memory/frame_arena.hpp"
+#include "render/render_manager.hpp"
+
+namespace render::render_queue {
+    namespace {
+        struct entry {
+            uint64_t key;
+            uint32_t index;
+        };
+        struct info {
+            memory::frame_arena::vector<draw_command> commands;
+            memory::frame_arena::vector<uint64_t> keys;
+            size_t last_count = 0;
+            stats last = {};
+        };
+        std::unique_ptr<info> info_p;
+
+        //--LSD radix sort on 8 bit digits, stable so equal keys keep submission order--//
+        entry* radix_sort(entry* in, entry* scratch, uint32_t count) {
+            for (uint32_t shift = 0; shift < 64; shift += 8) {
+                uint32_t histogram[256] = {0};
+                for (uint32_t i = 0; i < count; i++) {
+                    histogram[(in[i].key >> shift) & 0xFF]++;
+                }
+                //--Every key shares this digit so the pass would not move anything--//
+                if (histogram[(in[0].key >> shift) & 0xFF] == count) {
+                    continue;
+                }
+                uint32_t offset = 0;
+                for (uint32_t& h : histogram) {
+                    uint32_t c = h;
+                    h = offset;
+                    offset += c;
+                }
+                for (uint32_t i = 0; i < count; i++) {
+                    scratch[histogram[(in[i].key >> shift) & 0xFF]++] = in[i];
+                }
+                std::swap(in, scratch);
+            }
+            return in;
+        }
+    }
+
+    uint64_t make_key(uint8_t layer, uint16_t pipeline, uint8_t texture_page, uint32_t depth) {
+        return ((uint64_t)layer << 56) | ((uint64_t)pipeline << 40) | ((uint64_t)texture_page << 32) | (uint64_t)depth;
+    }
+    uint32_t depth_bits(float depth) {
+        uint32_t bits;
+        memcpy(&bits, &depth, sizeof(bits));
+        return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+    }
+
+    void init() {
+        info_p = std::make_unique<info>();
+    }
+
+    void submit(uint64_t key, const draw_command& command) {
+        if (info_p->commands.empty()) {
+            info_p->commands.reserve(info_p->last_count);
+            info_p->keys.reserve(info_p->last_count);
+        }
+        info_p->commands.push_back(command);
+        info_p->keys.push_back(key);
+    }
+
+    void flush() {
+        uint32_t count = (uint32_t)info_p->commands.size();
+        stats s = {count, 0, 0, 0, 0, 0};
+        if (count > 0) {
+            entry* entries = static_cast<entry*>(memory::frame_arena::allocate(sizeof(entry) * count * 2, alignof(entry)));
+            for (uint32_t i = 0; i < count; i++) {
+                entries[i] = {info_p->keys[i], i};
+            }
+            //--Binds drawing in submission order would have made, the baseline for what sorting saved--//
+            uint32_t submitted_pipeline_binds = 0;
+            uint32_t submitted_vertex_binds = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                const draw_command& cmd = info_p->commands[i];
+                const draw_command* prev = i > 0 ? &info_p->commands[i - 1] : nullptr;
+                if (!prev || cmd.pipeline != prev->pipeline || cmd.opaque != prev->opaque) {
+                    submitted_pipeline_binds++;
+                }
+                if (!prev || cmd.geom != prev->geom || cmd.buffer != prev->buffer) {
+                    submitted_vertex_binds++;
+                }
+            }
+            entry* sorted = radix_sort(entries, entries + count, count);
+
+            uint32_t bound_pipeline = 0;
+            bool bound_opaque = false;
+            bool geometry_bound = false;
+            geometry bound_geometry = geometry::rect_2D;
+            uint32_t bound_buffer = 0;
+            float depth_step = 1.0f / (float)(count + 1);
+            auto draw = [&](uint32_t i) {
+                const draw_command& cmd = info_p->commands[sorted[i].index];
+                if (cmd.pipeline != bound_pipeline || cmd.opaque != bound_opaque) {
+                    render_manager::bind_pipeline(cmd.pipeline, cmd.opaque);
+                    bound_pipeline = cmd.pipeline;
+                    bound_opaque = cmd.opaque;
+                    s.pipeline_binds++;
+                }
+                if (!geometry_bound || cmd.geom != bound_geometry || cmd.buffer != bound_buffer) {
+                    if (cmd.geom == geometry::buffer) {
+                        render_manager::bind_geometry(cmd.buffer);
+                    }
+                    else {
+                        render_manager::bind_rect_2D();
+                    }
+                    bound_geometry = cmd.geom;
+                    bound_buffer = cmd.buffer;
+                    geometry_bound = true;
+                    s.vertex_binds++;
+                }
+                render_manager::set_model(cmd.model);
+                render_manager::set_depth(1.0f - (float)(i + 1) * depth_step);
+                render_manager::set_texture_transform(cmd.texture_transform);
+                render_manager::set_colour_mult(cmd.colour_mult);
+                render_manager::draw(cmd.vertex_count, 1, cmd.first_vertex, 0);
+            };
+            if (render_manager::has_depth_buffer()) {
+                //--Nearest first so the depth test rejects hidden fragments before they are shaded--//
+                for (uint32_t i = count; i-- > 0;) {
+                    if (info_p->commands[sorted[i].index].opaque) {
+                        draw(i);
+                        s.opaque++;
+                    }
+                }
+                for (uint32_t i = 0; i < count; i++) {
+                    if (!info_p->commands[sorted[i].index].opaque) {
+                        draw(i);
+                    }
+                }
+            }
+            else {
+                for (uint32_t i = 0; i < count; i++) {
+                    draw(i);
+                }
+            }
+            //--Splitting opaque and translucent passes can cost binds, so this clamps rather than wrapping--//
+            s.pipeline_binds_saved = submitted_pipeline_binds > s.pipeline_binds ? submitted_pipeline_binds - s.pipeline_binds : 0;
+            s.vertex_binds_saved = submitted_vertex_binds > s.vertex_binds ? submitted_vertex_binds - s.vertex_binds : 0;
+        }
+        info_p->last = s;
+        info_p->last_count = count;
+
+        //--The arena is reset under these next time round so drop them without touching the memory--//
+        memory::frame_arena::vector<draw_command>().swap(info_p->commands);
+        memory::frame_arena::vector<uint64_t>().swap(info_p->keys);
+    }
+
+    stats get_stats() {
+        return info_p->last;
+    }
+
+    void terminate() {
+        info_p.reset(nullptr);
+    }
+}
@@ -0,0 +1,118 @@
+#include "render/render_stats.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#include "vulkan_wrapper.hpp"
+#include "render/text.hpp"
+#include "vml/vec4.hpp"
+
+namespace render::render_stats {
+    namespace {
+        //--Rows are flushed this often so a crash loses little of the log--//
+        const uint64_t LOG_FLUSH_FRAMES = 60;
+
+        struct info {
+            uint64_t frame_number = 0;
+            std::chrono::steady_clock::time_point last_end;
+            bool timed = false;
+            double frame_ms = 0.0;
+
+            FILE* log = nullptr;
+
+            bool overlay = false;
+            uint32_t font = 0;
+            float size = 0.0f;
+            uint32_t pipeline = 0;
+            uint8_t layer = 0;
+            vml::vec2 position = vml::vec2(0.0f, 0.0f);
+        };
+        std::unique_ptr<info> info_p;
+    }
+
+    void init() {
+        info_p = std::make_unique<info>();
+    }
+
+    void end_frame() {
+        if (!info_p) {
+            return;
+        }
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        info_p->frame_ms = info_p->timed ? std::chrono::duration<double, std::milli>(now - info_p->last_end).count() : 0.0;
+        info_p->last_end = now;
+        info_p->timed = true;
+        info_p->frame_number++;
+        if (info_p->log) {
+            const vulkan_wrapper::frame_stats& s = vulkan_wrapper::get_frame_stats();
+            fprintf(info_p->log, "%llu,%.3f,%u,%u,%u,%u,%u,%llu,%u,%.3f,%.3f\n",
+                    (unsigned long long)info_p->frame_number, info_p->frame_ms, s.draws, s.instances, s.pipeline_binds, s.vertex_binds,
+                    s.push_constant_bytes, (unsigned long long)s.uploaded_bytes, s.commands, s.fence_wait_ms, s.acquire_wait_ms);
+            if (info_p->frame_number % LOG_FLUSH_FRAMES == 0) {
+                fflush(info_p->log);
+            }
+        }
+    }
+
+    double get_frame_ms() {
+        return info_p ? info_p->frame_ms : 0.0;
+    }
+
+    bool start_log(const std::string& path) {
+        if (!info_p) {
+            return false;
+        }
+        stop_log();
+        info_p->log = fopen(path.c_str(), "w");
+        if (!info_p->log) {
+            printf("Could not open %s\n", path.c_str());
+            return false;
+        }
+        fprintf(info_p->log, "frame,frame_ms,draws,instances,pipeline_binds,vertex_binds,push_constant_bytes,uploaded_bytes,commands,fence_wait_ms,acquire_wait_ms\n");
+        return true;
+    }
+
+    void stop_log() {
+        if (info_p && info_p->log) {
+            fclose(info_p->log);
+            info_p->log = nullptr;
+        }
+    }
+
+    void show_overlay(uint32_t font, float size, uint32_t pipeline, uint8_t layer, const vml::vec2& position) {
+        if (!info_p) {
+            return;
+        }
+        info_p->overlay = true;
+        info_p->font = font;
+        info_p->size = size;
+        info_p->pipeline = pipeline;
+        info_p->layer = layer;
+        info_p->position = position;
+    }
+
+    void hide_overlay() {
+        if (info_p) {
+            info_p->overlay = false;
+        }
+    }
+
+    void render_overlay() {
+        if (!info_p || !info_p->overlay || info_p->font == 0) {
+            return;
+        }
+        const vulkan_wrapper::frame_stats& s = vulkan_wrapper::get_frame_stats();
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "%.2f ms\n%u draws, %u instances\n%u pipeline binds, %u vertex binds\n%u push constant bytes, %llu uploaded\n%u commands\nwaits %.2f ms fence, %.2f ms acquire",
+                 info_p->frame_ms, s.draws, s.instances, s.pipeline_binds, s.vertex_binds, s.push_constant_bytes,
+                 (unsigned long long)s.uploaded_bytes, s.commands, s.fence_wait_ms, s.acquire_wait_ms);
+        text::draw(info_p->font, line, info_p->size, info_p->pipeline, info_p->layer, info_p->position, vml::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+    }
+
+    void terminate() {
+        stop_log();
+        info_p.reset(nullptr);
+    }
+}
@@ -0,0 +1,153 @@
+#include "render/sprite_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace render {
+    namespace {
+        const float CELL_LIMIT = 1073741824.0f;
+
+        void extend(bounds& b, float x, float y) {
+            b.min_x = std::min(b.min_x, x);
+            b.min_y = std::min(b.min_y, y);
+            b.max_x = std::max(b.max_x, x);
+            b.max_y = std::max(b.max_y, y);
+        }
+
+        //--Unprojects an NDC corner as a ray and finds where it crosses z = 0 in world space--//
+        void ground_point(const vml::mat4& inv, float x, float y, float& out_x, float& out_y) {
+            vml::vec4 near = inv * vml::vec4(x, y, 0.0f, 1.0f);
+            vml::vec4 far = inv * vml::vec4(x, y, 1.0f, 1.0f);
+            near /= near[3];
+            far /= far[3];
+            float dz = far[2] - near[2];
+            float t = (std::fabs(dz) > 1e-6f) ? -near[2] / dz : 0.0f;
+            if (t < 0.0f) {
+                //--The plane is behind this corner so fall back to the far plane--//
+                t = 1.0f;
+            }
+            out_x = near[0] + (far[0] - near[0]) * t;
+            out_y = near[1] + (far[1] - near[1]) * t;
+        }
+    }
+
+    bounds view_bounds(const vml::mat4& perspective, const vml::mat4& view) {
+        vml::mat4 inv = (perspective * view).inverse();
+        bounds b = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+        const float corners[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+        for (const float* c : corners) {
+            float x, y;
+            ground_point(inv, c[0], c[1], x, y);
+            extend(b, x, y);
+        }
+        return b;
+    }
+
+    bounds model_bounds(const vml::mat4& model) {
+        float ox = model[3][0], oy = model[3][1];
+        float ux = model[0][0], uy = model[0][1];
+        float vx = model[1][0], vy = model[1][1];
+        bounds b = {ox, oy, ox, oy};
+        extend(b, ox + ux, oy + uy);
+        extend(b, ox + vx, oy + vy);
+        extend(b, ox + ux + vx, oy + uy + vy);
+        return b;
+    }
+
+    sprite_grid::sprite_grid(float cell_size) {
+        this->inverse_cell_size = 1.0f / cell_size;
+    }
+
+    void sprite_grid::insert(uint32_t id, const bounds& b) {
+        if (id >= this->items.size()) {
+            this->items.resize(id + 1);
+        }
+        item& i = this->items[id];
+        if (i.present) {
+            this->update(id, b);
+            return;
+        }
+        i.b = b;
+        i.cells = this->range_of(b);
+        i.present = true;
+        this->link(id, i.cells);
+    }
+
+    void sprite_grid::update(uint32_t id, const bounds& b) {
+        if (id >= this->items.size() || !this->items[id].present) {
+            this->insert(id, b);
+            return;
+        }
+        item& i = this->items[id];
+        i.b = b;
+        cell_range r = this->range_of(b);
+        if (r == i.cells) {
+            return;
+        }
+        this->unlink(id, i.cells);
+        i.cells = r;
+        this->link(id, r);
+    }
+
+    bool sprite_grid::set_bounds(uint32_t id, const bounds& b) {
+        if (id >= this->items.size() || !this->items[id].present) {
+            return true;
+        }
+        item& i = this->items[id];
+        i.b = b;
+        return !(this->range_of(b) == i.cells);
+    }
+
+    void sprite_grid::remove(uint32_t id) {
+        if (id >= this->items.size() || !this->items[id].present) {
+            return;
+        }
+        this->unlink(id, this->items[id].cells);
+        this->items[id].present = false;
+    }
+
+    void sprite_grid::clear() {
+        this->items.clear();
+        this->cells.clear();
+    }
+
+    sprite_grid::cell_range sprite_grid::range_of(const bounds& b) const {
+        auto cell = [this](float v) {
+            return (int32_t)std::floor(std::max(-CELL_LIMIT, std::min(CELL_LIMIT, v * this->inverse_cell_size)));
+        };
+        return {cell(b.min_x), cell(b.min_y), cell(b.max_x), cell(b.max_y)};
+    }
+
+    uint64_t sprite_grid::cell_key(int32_t x, int32_t y) {
+        return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y;
+    }
+
+    void sprite_grid::link(uint32_t id, const cell_range& r) {
+        for (int32_t y = r.y0; y <= r.y1; y++) {
+            for (int32_t x = r.x0; x <= r.x1; x++) {
+                this->cells[cell_key(x, y)].push_back(id);
+            }
+        }
+    }
+
+    void sprite_grid::unlink(uint32_t id, const cell_range& r) {
+        for (int32_t y = r.y0; y <= r.y1; y++) {
+            for (int32_t x = r.x0; x <= r.x1; x++) {
+                auto it = this->cells.find(cell_key(x, y));
+                if (it == this->cells.end()) {
+                    continue;
+                }
+                std::vector<uint32_t>& ids = it->second;
+                auto found = std::find(ids.begin(), ids.end(), id);
+                if (found != ids.end()) {
+                    *found = ids.back();
+                    ids.pop_back();
+                }
+                //--Scrolling worlds would otherwise keep every cell they ever touched--//
+                if (ids.empty()) {
+                    this->cells.erase(it);
+                }
+            }
+        }
+    }
+}
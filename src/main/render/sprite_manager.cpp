@@ -1,27 +1,59 @@
 #include <render/sprite_manager.hpp>
 
+#include <algorithm>
+#include <cstdio>
 #include <memory>
-#include <map>
+#include <unordered_map>
 #include <vml/mat3.hpp>
+#include <vml/mat4.hpp>
+#include <vml/vec4.hpp>
 #include <vector>
+#include <pack/guillotine_packer.hpp>
 #include <render/render_manager.hpp>
+#include <resource/name_id.hpp>
 #include <resource/resource_manager.hpp>
 
 namespace render::sprite_manager {
+    using namespace resource::literals;
+
     namespace {
         struct info {
-            std::map<std::string, uint32_t> name_id_map;
+            //--Names are only compared while loading, lookups afterwards go by hash--//
+            std::unordered_map<resource::name_id, uint32_t> name_id_map;
             std::vector<vml::mat3> transform_list;
+            std::vector<uint32_t> page_list;
+            std::vector<vml::vec4> trim_list;
+            std::vector<pack::rect> region_list;
+
+            //--One packer per layer seeded with the packed sprites, dynamic regions are cut from what is left--//
+            std::vector<pack::guillotine_packer> layer_packers;
+            //--Packer handle per sprite, INVALID_HANDLE for sprites loaded from the atlas--//
+            std::vector<uint32_t> region_handles;
+            //--Name each dynamic region was allocated under, so releasing it erases the map entry by key--//
+            std::vector<resource::name_id> region_names;
+            std::vector<uint32_t> free_ids;
 
             uint32_t unknown_id;
             vml::mat3 unknown_t;
+            vml::vec4 unknown_trim;
 
             float width;
             float height;
             float layers;
+            uint32_t format;
         };
+        const uint32_t INFO_MAGIC = 0x41545332;
+        const int ENTRY_SIZE = 36;
+        //--Matches the gap TexturePackager leaves between images so filtering doesn't bleed across--//
+        const uint32_t GUTTER = 1;
         std::unique_ptr<info> info_p;
 
+        //--Used when no atlas is loaded, the whole unit quad on layer 0 so tools and benchmarks run without sprites.ats--//
+        const vml::mat3 NO_ATLAS_TRANSFORM(1.0f, 0.0f, 0.0f,
+                                           0.0f, 1.0f, 0.0f,
+                                           0.0f, 0.0f, 0.0f);
+        const vml::vec4 NO_ATLAS_TRIM(0.0f, 0.0f, 1.0f, 1.0f);
+
         uint32_t convert_endian(const uint8_t* in) {
             uint32_t out = 0;
             out += ((uint32_t)in[0]) << 24;
@@ -30,61 +62,148 @@ namespace render::sprite_manager {
             out += ((uint32_t)in[3]) << 0;
             return out;
         }
+        //--Entries are written by TexturePackager as x, y, layer, w, h, trim x, trim y, source w, source h--//
         vml::mat3 construct_transform(const uint8_t* data) {
             return vml::mat3(
-                    convert_endian(data) / info_p->width, 0.0f, 0.0f,
-                    0.0f, convert_endian(data + 4) / info_p->height, 0.0f,
-                    convert_endian(data + 8) / info_p->width, convert_endian(data + 12) / info_p->height, convert_endian(data + 16) / info_p->layers);
+                    convert_endian(data + 12) / info_p->width, 0.0f, 0.0f,
+                    0.0f, convert_endian(data + 16) / info_p->height, 0.0f,
+                    convert_endian(data) / info_p->width, convert_endian(data + 4) / info_p->height, convert_endian(data + 8) / info_p->layers);
+        }
+        //--Where the packed texels sit inside the untrimmed sprite, as offset and size in unit quad space--//
+        vml::vec4 construct_trim(const uint8_t* data) {
+            float source_w = (float)std::max(1u, convert_endian(data + 28));
+            float source_h = (float)std::max(1u, convert_endian(data + 32));
+            return vml::vec4(convert_endian(data + 20) / source_w, convert_endian(data + 24) / source_h,
+                             convert_endian(data + 12) / source_w, convert_endian(data + 16) / source_h);
         }
     }
     bool init() {
         info_p = std::make_unique<info>();
 
         std::vector<uint8_t> description_data = resource::resource_manager::read_binary_file("sprites.ats", {"textures"});
-        if (description_data.size() < 4) {
+        //--Header is magic, page width, page height, layer count, texture format and sprite count--//
+        if (description_data.size() < 24 || convert_endian(description_data.data()) != INFO_MAGIC) {
+            info_p.reset(nullptr);
+            return false;
+        }
+        auto it = description_data.begin() + 4;
+        info_p->width = (float)convert_endian(&*it);
+        info_p->height = (float)convert_endian(&*it + 4);
+        info_p->layers = (float)convert_endian(&*it + 8);
+        info_p->format = convert_endian(&*it + 12);
+        it += 16;
+        if (info_p->width <= 0.0f || info_p->height <= 0.0f || info_p->layers <= 0.0f) {
             info_p.reset(nullptr);
             return false;
         }
-        auto it = description_data.begin();
 
         uint32_t sprite_count = convert_endian(&*it);
         it += 4;
+        std::unordered_map<resource::name_id, std::string> names;
+        info_p->name_id_map.reserve(sprite_count);
 
         for (uint32_t i = 0; i < sprite_count; i++) {
-            if (description_data.end() - it < 20) {
+            if (description_data.end() - it < ENTRY_SIZE) {
                 info_p.reset(nullptr);
                 return false;
             }
             info_p->transform_list.push_back(construct_transform(&*it));
-            it += 20;
+            info_p->page_list.push_back(convert_endian(&*it + 8));
+            info_p->trim_list.push_back(construct_trim(&*it));
+            info_p->region_list.push_back({convert_endian(&*it), convert_endian(&*it + 4), convert_endian(&*it + 12), convert_endian(&*it + 16)});
+            info_p->region_handles.push_back(pack::guillotine_packer::INVALID_HANDLE);
+            info_p->region_names.emplace_back();
+            it += ENTRY_SIZE;
             std::string name;
-            while (*it != 0 && it != description_data.end()) {
+            while (it != description_data.end() && *it != 0) {
                 name += *(char*)(&*it);
                 it += 1;
             }
-            if (*it != 0) {
+            //--A name running off the end of the file means the terminator is missing--//
+            if (it == description_data.end()) {
+                printf("Sprite name '%s' is not terminated\n", name.c_str());
                 info_p.reset(nullptr);
                 return false;
             }
-            info_p->name_id_map.insert(std::pair<std::string, uint32_t>(name, i + 1));
+            resource::name_id hash = resource::hash_name(name);
+            auto collision = names.find(hash);
+            if (collision != names.end() && collision->second != name) {
+                printf("Sprite name '%s' collides with '%s'\n", name.c_str(), collision->second.c_str());
+                info_p.reset(nullptr);
+                return false;
+            }
+            names.insert(std::pair<resource::name_id, std::string>(hash, name));
+            info_p->name_id_map.insert(std::pair<resource::name_id, uint32_t>(hash, i + 1));
             it += 1;
         }
-        info_p->unknown_id = get_sprite("unknown");
+        info_p->layer_packers.resize((size_t)info_p->layers);
+        for (pack::guillotine_packer& packer : info_p->layer_packers) {
+            packer.reset((uint32_t)info_p->width, (uint32_t)info_p->height);
+        }
+        for (uint32_t i = 0; i < sprite_count; i++) {
+            const pack::rect& r = info_p->region_list[i];
+            if (info_p->page_list[i] < info_p->layer_packers.size()) {
+                info_p->layer_packers[info_p->page_list[i]].occupy({r.x, r.y, r.w + GUTTER, r.h + GUTTER});
+            }
+        }
+
+        info_p->unknown_id = get_sprite("unknown"_id);
         if (info_p->unknown_id == 0) {
             info_p.reset(nullptr);
             return false;
         }
         info_p->unknown_t = info_p->transform_list.at(info_p->unknown_id - 1);
+        info_p->unknown_trim = info_p->trim_list.at(info_p->unknown_id - 1);
         return true;
     }
-    uint32_t get_sprite(const std::string& name) {
+    uint32_t get_sprite(resource::name_id name) {
+        if (!info_p) {
+            return 0;
+        }
         auto it = info_p->name_id_map.find(name);
         if (it != info_p->name_id_map.end()) {
             return it->second;
         }
         return 0;
     }
+    uint32_t get_sprite(const std::string& name) {
+        return get_sprite(resource::hash_name(name));
+    }
+    uint32_t get_format() {
+        return info_p ? info_p->format : 0;
+    }
+    uint32_t get_page(uint32_t id) {
+        if (!info_p) {
+            return 0;
+        }
+        if (id > 0 && id <= info_p->page_list.size()) {
+            return info_p->page_list.at(id - 1);
+        }
+        return info_p->page_list.at(info_p->unknown_id - 1);
+    }
+    const vml::mat3& get_transform(uint32_t id) {
+        if (!info_p) {
+            return NO_ATLAS_TRANSFORM;
+        }
+        if (id > 0 && id <= info_p->transform_list.size()) {
+            return info_p->transform_list.at(id - 1);
+        }
+        return info_p->unknown_t;
+    }
+    const vml::vec4& get_trim(uint32_t id) {
+        if (!info_p) {
+            return NO_ATLAS_TRIM;
+        }
+        if (id > 0 && id <= info_p->trim_list.size()) {
+            return info_p->trim_list.at(id - 1);
+        }
+        return info_p->unknown_trim;
+    }
     void bind_sprite(uint32_t id) {
+        if (!info_p) {
+            render_manager::set_texture_transform(NO_ATLAS_TRANSFORM);
+            return;
+        }
         vml::mat3 transform = info_p->unknown_t;
         if (id > 0) {
             if (id <= info_p->transform_list.size()) {
@@ -93,4 +212,74 @@ namespace render::sprite_manager {
         }
         render_manager::set_texture_transform(transform);
     }
+    void bind_sprite(uint32_t id, const vml::mat4& model) {
+        bind_sprite(id);
+        const vml::vec4& trim = get_trim(id);
+        render_manager::set_model(model * vml::mat4(trim[2], 0.0f, 0.0f, 0.0f,
+                                                    0.0f, trim[3], 0.0f, 0.0f,
+                                                    0.0f, 0.0f, 1.0f, 0.0f,
+                                                    trim[0], trim[1], 0.0f, 1.0f));
+    }
+    uint32_t allocate_region(const std::string& name, uint32_t w, uint32_t h) {
+        resource::name_id hash = resource::hash_name(name);
+        if (!info_p || w == 0 || h == 0 || info_p->name_id_map.count(hash) > 0) {
+            return 0;
+        }
+        for (uint32_t layer = 0; layer < info_p->layer_packers.size(); layer++) {
+            pack::rect r;
+            uint32_t handle = info_p->layer_packers[layer].insert(w + GUTTER, h + GUTTER, r);
+            if (handle == pack::guillotine_packer::INVALID_HANDLE) {
+                continue;
+            }
+            uint32_t index = (uint32_t)info_p->transform_list.size();
+            if (!info_p->free_ids.empty()) {
+                index = info_p->free_ids.back() - 1;
+                info_p->free_ids.pop_back();
+            }
+            else {
+                info_p->transform_list.emplace_back();
+                info_p->page_list.emplace_back();
+                info_p->trim_list.emplace_back();
+                info_p->region_list.emplace_back();
+                info_p->region_handles.emplace_back();
+                info_p->region_names.emplace_back();
+            }
+            info_p->transform_list[index] = vml::mat3(
+                    w / info_p->width, 0.0f, 0.0f,
+                    0.0f, h / info_p->height, 0.0f,
+                    r.x / info_p->width, r.y / info_p->height, layer / info_p->layers);
+            info_p->page_list[index] = layer;
+            info_p->trim_list[index] = vml::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            info_p->region_list[index] = {r.x, r.y, w, h};
+            info_p->region_handles[index] = handle;
+            info_p->region_names[index] = hash;
+            info_p->name_id_map.insert(std::pair<resource::name_id, uint32_t>(hash, index + 1));
+            return index + 1;
+        }
+        return 0;
+    }
+    void release_region(uint32_t id) {
+        if (!info_p || id == 0 || id > info_p->region_handles.size() || info_p->region_handles[id - 1] == pack::guillotine_packer::INVALID_HANDLE) {
+            return;
+        }
+        uint32_t index = id - 1;
+        info_p->layer_packers[info_p->page_list[index]].remove(info_p->region_handles[index]);
+        info_p->region_handles[index] = pack::guillotine_packer::INVALID_HANDLE;
+        //--The id falls back to the unknown sprite until it is handed out again--//
+        info_p->transform_list[index] = info_p->unknown_t;
+        info_p->page_list[index] = info_p->page_list[info_p->unknown_id - 1];
+        info_p->trim_list[index] = info_p->unknown_trim;
+        info_p->region_list[index] = info_p->region_list[info_p->unknown_id - 1];
+        info_p->name_id_map.erase(info_p->region_names[index]);
+        info_p->free_ids.push_back(id);
+    }
+    pack::rect get_region(uint32_t id) {
+        if (!info_p) {
+            return {0, 0, 0, 0};
+        }
+        if (id > 0 && id <= info_p->region_list.size()) {
+            return info_p->region_list.at(id - 1);
+        }
+        return info_p->region_list.at(info_p->unknown_id - 1);
+    }
 }
\ No newline at end of file
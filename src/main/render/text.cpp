@@ -0,0 +1,338 @@
+#include "render/text.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "render/render_manager.hpp"
+#include "render/render_queue.hpp"
+#include "render/sprite_manager.hpp"
+#include "render/vertex.hpp"
+#include "resource/name_id.hpp"
+#include "resource/resource_manager.hpp"
+
+namespace render::text {
+    namespace {
+        const uint32_t FONT_MAGIC = 0x41544631;
+        const size_t HEADER_SIZE = 20;
+        const size_t ENTRY_SIZE = 16;
+
+        struct glyph {
+            float left;
+            float advance;
+            uint32_t sprite;
+        };
+        //--Metrics are in atlas texels, every glyph image is the cell plus spread on each side--//
+        struct font {
+            float cell_w, cell_h;
+            float spread;
+            uint32_t first;
+            std::vector<glyph> glyphs;
+        };
+        struct page_range {
+            uint32_t page;
+            float layer;
+            uint32_t first;
+            uint32_t count;
+        };
+        struct label {
+            uint32_t geometry = 0;
+            std::vector<page_range> pages;
+            uint32_t font = 0;
+            float size = 0.0f;
+            std::string text;
+            uint32_t references = 0;
+        };
+
+        struct info {
+            //--Handles are indices plus one, 0 is no font or label--//
+            std::vector<font> font_list;
+            std::vector<label> label_list;
+            std::vector<uint32_t> free_labels;
+            std::unordered_map<uint64_t, uint32_t> label_map;
+            std::vector<vertex> scratch;
+            std::vector<page_range> scratch_pages;
+        };
+        std::unique_ptr<info> info_p;
+
+        uint32_t convert_endian(const uint8_t* in) {
+            return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | (uint32_t)in[3];
+        }
+
+        //--UTF-8, a malformed byte is read as the codepoint of its own value--//
+        uint32_t next_codepoint(const std::string& s, size_t& i) {
+            uint8_t c = (uint8_t)s[i++];
+            uint32_t extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+            if (extra == 0 || i + extra > s.size()) {
+                return c;
+            }
+            uint32_t cp = c & (0x3F >> extra);
+            for (uint32_t e = 0; e < extra; e++) {
+                uint8_t n = (uint8_t)s[i + e];
+                if ((n & 0xC0) != 0x80) {
+                    return c;
+                }
+                cp = (cp << 6) | (n & 0x3F);
+            }
+            i += extra;
+            return cp;
+        }
+
+        const glyph* find_glyph(const font& f, uint32_t cp) {
+            if (cp >= f.first && cp - f.first < f.glyphs.size()) {
+                return &f.glyphs[cp - f.first];
+            }
+            //--Characters the sheet doesn't cover fall back to '?' when it does--//
+            if ('?' >= f.first && '?' - f.first < f.glyphs.size()) {
+                return &f.glyphs['?' - f.first];
+            }
+            return nullptr;
+        }
+
+        const font* get_font(uint32_t id) {
+            if (id > 0 && id <= info_p->font_list.size()) {
+                return &info_p->font_list[id - 1];
+            }
+            return nullptr;
+        }
+
+        uint64_t label_key(uint32_t font_id, const std::string& s, float size) {
+            uint32_t size_bits;
+            memcpy(&size_bits, &size, sizeof(size_bits));
+            return resource::hash_name(s) ^ (((uint64_t)font_id << 32 | size_bits) * 0x9E3779B97F4A7C15ULL);
+        }
+
+        //--Quads in string space grouped by texture page, pages gets one contiguous range of vertices per page--//
+        void layout(const font& f, const std::string& s, float size, std::vector<vertex>& vertices, std::vector<page_range>& pages) {
+            pages.clear();
+            for (size_t i = 0; i < s.size();) {
+                const glyph* g = find_glyph(f, next_codepoint(s, i));
+                if (!g || g->sprite == 0) {
+                    continue;
+                }
+                uint32_t page = sprite_manager::get_page(g->sprite);
+                auto it = std::find_if(pages.begin(), pages.end(), [page](const page_range& p) { return p.page == page; });
+                if (it == pages.end()) {
+                    pages.push_back({page, sprite_manager::get_transform(g->sprite)[2][2], 0, 0});
+                    it = pages.end() - 1;
+                }
+                it->count += 6;
+            }
+            std::sort(pages.begin(), pages.end(), [](const page_range& a, const page_range& b) { return a.page < b.page; });
+            uint32_t total = 0;
+            for (page_range& p : pages) {
+                p.first = total;
+                total += p.count;
+                p.count = 0;
+            }
+            vertices.resize(total);
+
+            float scale = size / f.cell_h;
+            float full_w = (f.cell_w + 2.0f * f.spread) * scale, full_h = (f.cell_h + 2.0f * f.spread) * scale;
+            float pen_x = 0.0f, pen_y = 0.0f;
+            for (size_t i = 0; i < s.size();) {
+                uint32_t cp = next_codepoint(s, i);
+                if (cp == '\n') {
+                    pen_x = 0.0f;
+                    pen_y += size;
+                    continue;
+                }
+                const glyph* g = find_glyph(f, cp);
+                if (!g) {
+                    pen_x += f.cell_w * 0.5f * scale;
+                    continue;
+                }
+                if (g->sprite != 0) {
+                    uint32_t page = sprite_manager::get_page(g->sprite);
+                    page_range& p = *std::find_if(pages.begin(), pages.end(), [page](const page_range& r) { return r.page == page; });
+                    const vml::mat3& t = sprite_manager::get_transform(g->sprite);
+                    const vml::vec4& trim = sprite_manager::get_trim(g->sprite);
+                    float x = pen_x - (g->left + f.spread) * scale + trim[0] * full_w;
+                    float y = pen_y - f.spread * scale + trim[1] * full_h;
+                    float w = trim[2] * full_w, h = trim[3] * full_h;
+                    //--Same corner order as the rect_2D quad--//
+                    const float corners[6][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+                    vertex* out = &vertices[p.first + p.count];
+                    for (const float* corner : corners) {
+                        vml::vec3 uv = t * vml::vec3(corner[0], corner[1], 1.0f);
+                        *out++ = {{x + corner[0] * w, y + corner[1] * h}, {uv[0], uv[1]}};
+                    }
+                    p.count += 6;
+                }
+                pen_x += g->advance * scale;
+            }
+        }
+
+        void submit(const std::vector<page_range>& pages, uint32_t geometry, uint32_t first, uint32_t pipeline, uint8_t layer, const vml::vec2& position, const vml::vec4& colour) {
+            vml::mat4 model = vml::mat4::identity();
+            model[3][0] = position[0];
+            model[3][1] = position[1];
+            for (const page_range& p : pages) {
+                //--UVs are baked into the vertices, only the page's layer is left for the texture transform--//
+                render_queue::draw_command command = {
+                        pipeline, render_queue::geometry::buffer, p.count, first + p.first,
+                        model,
+                        vml::mat3(1.0f, 0.0f, 0.0f,
+                                  0.0f, 1.0f, 0.0f,
+                                  0.0f, 0.0f, p.layer),
+                        vml::mat4(colour[0], 0.0f, 0.0f, 0.0f,
+                                  0.0f, colour[1], 0.0f, 0.0f,
+                                  0.0f, 0.0f, colour[2], 0.0f,
+                                  0.0f, 0.0f, 0.0f, colour[3]),
+                        geometry};
+                render_queue::submit(render_queue::make_key(layer, (uint16_t)pipeline, (uint8_t)p.page, 0), command);
+            }
+        }
+    }
+
+    void init() {
+        info_p = std::make_unique<info>();
+    }
+
+    uint32_t load_font(const std::string& name) {
+        std::vector<uint8_t> data = resource::resource_manager::read_binary_file("sprites." + name + ".atf", {"textures"});
+        //--Header is magic, cell width, cell height, spread and glyph count, then codepoint, left, advance and flags per glyph--//
+        if (data.size() < HEADER_SIZE || convert_endian(data.data()) != FONT_MAGIC) {
+            printf("Could not load font '%s'\n", name.c_str());
+            return 0;
+        }
+        font f;
+        f.cell_w = (float)convert_endian(data.data() + 4);
+        f.cell_h = (float)convert_endian(data.data() + 8);
+        f.spread = (float)convert_endian(data.data() + 12);
+        uint32_t count = convert_endian(data.data() + 16);
+        if (f.cell_h <= 0.0f || count == 0 || data.size() < HEADER_SIZE + ENTRY_SIZE * count) {
+            printf("Font '%s' is malformed\n", name.c_str());
+            return 0;
+        }
+        f.first = convert_endian(data.data() + HEADER_SIZE);
+        f.glyphs.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            const uint8_t* entry = data.data() + HEADER_SIZE + ENTRY_SIZE * i;
+            uint32_t cp = convert_endian(entry);
+            glyph& g = f.glyphs[i];
+            g.left = (float)(int32_t)convert_endian(entry + 4);
+            g.advance = (float)convert_endian(entry + 8);
+            g.sprite = (convert_endian(entry + 12) & 1) ? sprite_manager::get_sprite(name + "/" + std::to_string(cp)) : 0;
+        }
+        info_p->font_list.push_back(std::move(f));
+        return (uint32_t)info_p->font_list.size();
+    }
+
+    vml::vec2 measure(uint32_t font_id, const std::string& s, float size) {
+        const font* f = get_font(font_id);
+        if (!f || s.empty()) {
+            return vml::vec2(0.0f, 0.0f);
+        }
+        float scale = size / f->cell_h;
+        float width = 0.0f, pen_x = 0.0f, height = size;
+        for (size_t i = 0; i < s.size();) {
+            uint32_t cp = next_codepoint(s, i);
+            if (cp == '\n') {
+                pen_x = 0.0f;
+                height += size;
+                continue;
+            }
+            const glyph* g = find_glyph(*f, cp);
+            pen_x += (g ? g->advance : f->cell_w * 0.5f) * scale;
+            width = std::max(width, pen_x);
+        }
+        return vml::vec2(width, height);
+    }
+
+    uint32_t create_label(uint32_t font_id, const std::string& s, float size) {
+        const font* f = get_font(font_id);
+        if (!f) {
+            return 0;
+        }
+        uint64_t key = label_key(font_id, s, size);
+        auto it = info_p->label_map.find(key);
+        if (it != info_p->label_map.end()) {
+            label& l = info_p->label_list[it->second - 1];
+            if (l.font == font_id && l.size == size && l.text == s) {
+                l.references++;
+                return it->second;
+            }
+        }
+
+        label l;
+        l.font = font_id;
+        l.size = size;
+        l.text = s;
+        l.references = 1;
+        layout(*f, s, size, info_p->scratch, l.pages);
+        l.geometry = render_manager::create_geometry(info_p->scratch.data(), (uint32_t)info_p->scratch.size());
+        if (l.geometry == 0) {
+            l.pages.clear();
+        }
+        uint32_t id;
+        if (!info_p->free_labels.empty()) {
+            id = info_p->free_labels.back() + 1;
+            info_p->free_labels.pop_back();
+            info_p->label_list[id - 1] = std::move(l);
+        }
+        else {
+            info_p->label_list.push_back(std::move(l));
+            id = (uint32_t)info_p->label_list.size();
+        }
+        //--Only the first label with a key is shared, a colliding string still gets its own label--//
+        info_p->label_map.emplace(key, id);
+        return id;
+    }
+
+    void destroy_label(uint32_t id) {
+        if (id == 0 || id > info_p->label_list.size() || info_p->label_list[id - 1].references == 0) {
+            return;
+        }
+        label& l = info_p->label_list[id - 1];
+        if (--l.references > 0) {
+            return;
+        }
+        auto it = info_p->label_map.find(label_key(l.font, l.text, l.size));
+        if (it != info_p->label_map.end() && it->second == id) {
+            info_p->label_map.erase(it);
+        }
+        render_manager::destroy_geometry(l.geometry);
+        l = label();
+        info_p->free_labels.push_back(id - 1);
+    }
+
+    void draw_label(uint32_t id, uint32_t pipeline, uint8_t layer, const vml::vec2& position, const vml::vec4& colour) {
+        if (id == 0 || id > info_p->label_list.size()) {
+            return;
+        }
+        const label& l = info_p->label_list[id - 1];
+        if (l.geometry != 0) {
+            submit(l.pages, l.geometry, 0, pipeline, layer, position, colour);
+        }
+    }
+
+    void draw(uint32_t font_id, const std::string& s, float size, uint32_t pipeline, uint8_t layer, const vml::vec2& position, const vml::vec4& colour) {
+        const font* f = get_font(font_id);
+        if (!f) {
+            return;
+        }
+        layout(*f, s, size, info_p->scratch, info_p->scratch_pages);
+        if (info_p->scratch.empty()) {
+            return;
+        }
+        uint32_t geometry, first;
+        vertex* out = render_manager::allocate_stream((uint32_t)info_p->scratch.size(), geometry, first);
+        //--The frame's stream space is used up, the text is dropped for this frame rather than stalling--//
+        if (!out) {
+            return;
+        }
+        std::copy(info_p->scratch.begin(), info_p->scratch.end(), out);
+        submit(info_p->scratch_pages, geometry, first, pipeline, layer, position, colour);
+    }
+
+    void terminate() {
+        for (const label& l : info_p->label_list) {
+            render_manager::destroy_geometry(l.geometry);
+        }
+        info_p.reset(nullptr);
+    }
+}
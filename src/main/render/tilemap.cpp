@@ -0,0 +1,224 @@
+#include "render/tilemap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <render/render_manager.hpp>
+#include <render/render_queue.hpp>
+#include <render/sprite_manager.hpp>
+
+namespace render {
+    namespace {
+        const float CHUNK_LIMIT = 1073741824.0f;
+        const uint32_t TILES_PER_CHUNK = tilemap::CHUNK_SIZE * tilemap::CHUNK_SIZE;
+
+        int32_t clamp_chunk(float c) {
+            return (int32_t)std::max(-CHUNK_LIMIT, std::min(CHUNK_LIMIT, std::floor(c)));
+        }
+    }
+
+    tilemap::tilemap(float tile_size, uint8_t layer, uint32_t pipeline) {
+        this->tile_size = tile_size;
+        this->layer = layer;
+        this->pipeline = pipeline;
+    }
+
+    tilemap::~tilemap() {
+        this->clear();
+    }
+
+    void tilemap::set_opaque(bool opaque) {
+        this->opaque = opaque;
+    }
+
+    void tilemap::set_tile(int32_t x, int32_t y, uint32_t sprite) {
+        int32_t cx = chunk_of(x), cy = chunk_of(y);
+        auto it = this->chunks.find(chunk_key(cx, cy));
+        if (it == this->chunks.end() && sprite == 0) {
+            return;
+        }
+        chunk& c = it != this->chunks.end() ? it->second : this->get_chunk(cx, cy);
+        uint32_t& tile = c.tiles[(y - cy * CHUNK_SIZE) * CHUNK_SIZE + (x - cx * CHUNK_SIZE)];
+        if (tile == sprite) {
+            return;
+        }
+        c.tile_count += (sprite != 0) - (tile != 0);
+        tile = sprite;
+        c.dirty = true;
+    }
+
+    uint32_t tilemap::get_tile(int32_t x, int32_t y) const {
+        int32_t cx = chunk_of(x), cy = chunk_of(y);
+        auto it = this->chunks.find(chunk_key(cx, cy));
+        if (it == this->chunks.end()) {
+            return 0;
+        }
+        return it->second.tiles[(y - cy * CHUNK_SIZE) * CHUNK_SIZE + (x - cx * CHUNK_SIZE)];
+    }
+
+    void tilemap::set_chunk(int32_t cx, int32_t cy, const uint32_t* sprites) {
+        chunk& c = this->get_chunk(cx, cy);
+        std::copy(sprites, sprites + TILES_PER_CHUNK, c.tiles.begin());
+        c.tile_count = (uint32_t)(TILES_PER_CHUNK - std::count(c.tiles.begin(), c.tiles.end(), 0u));
+        c.dirty = true;
+    }
+
+    void tilemap::remove_chunk(int32_t cx, int32_t cy) {
+        auto it = this->chunks.find(chunk_key(cx, cy));
+        if (it != this->chunks.end()) {
+            release(it->second);
+            this->chunks.erase(it);
+        }
+    }
+
+    bool tilemap::has_chunk(int32_t cx, int32_t cy) const {
+        return this->chunks.count(chunk_key(cx, cy)) > 0;
+    }
+
+    void tilemap::clear() {
+        for (auto& c : this->chunks) {
+            release(c.second);
+        }
+        this->chunks.clear();
+    }
+
+    void tilemap::render(const bounds& view) {
+        this->last = {(uint32_t)this->chunks.size(), 0, 0, 0, 0};
+        float inverse_extent = 1.0f / this->get_chunk_extent();
+        int32_t x0 = clamp_chunk(view.min_x * inverse_extent), y0 = clamp_chunk(view.min_y * inverse_extent);
+        int32_t x1 = clamp_chunk(view.max_x * inverse_extent), y1 = clamp_chunk(view.max_y * inverse_extent);
+        uint64_t range_chunks = (uint64_t)((int64_t)x1 - x0 + 1) * (uint64_t)((int64_t)y1 - y0 + 1);
+        if (range_chunks > this->chunks.size()) {
+            //--Zoomed far out, walking the stored chunks is cheaper than walking the range--//
+            for (auto& c : this->chunks) {
+                int32_t cx = (int32_t)(uint32_t)(c.first >> 32);
+                int32_t cy = (int32_t)(uint32_t)c.first;
+                if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1) {
+                    this->submit(c.second, cx, cy);
+                }
+            }
+            return;
+        }
+        for (int32_t cy = y0; cy <= y1; cy++) {
+            for (int32_t cx = x0; cx <= x1; cx++) {
+                auto it = this->chunks.find(chunk_key(cx, cy));
+                if (it != this->chunks.end()) {
+                    this->submit(it->second, cx, cy);
+                }
+            }
+        }
+    }
+
+    uint64_t tilemap::chunk_key(int32_t cx, int32_t cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint64_t)(uint32_t)cy;
+    }
+
+    int32_t tilemap::chunk_of(int32_t tile) {
+        //--Rounds towards negative infinity so tile -1 lands in chunk -1 rather than chunk 0--//
+        return tile >= 0 ? tile / CHUNK_SIZE : (tile + 1) / CHUNK_SIZE - 1;
+    }
+
+    tilemap::chunk& tilemap::get_chunk(int32_t cx, int32_t cy) {
+        chunk& c = this->chunks[chunk_key(cx, cy)];
+        if (c.tiles.empty()) {
+            c.tiles.resize(TILES_PER_CHUNK, 0);
+        }
+        return c;
+    }
+
+    void tilemap::release(chunk& c) {
+        render_manager::release_static(c.geometry, c.first, c.vertex_count);
+        c.geometry = 0;
+        c.first = 0;
+        c.vertex_count = 0;
+    }
+
+    //--Quads are laid out in chunk space and grouped by texture page so each page is one contiguous draw--//
+    void tilemap::build(chunk& c) {
+        release(c);
+        c.pages.clear();
+        c.dirty = false;
+        if (c.tile_count == 0) {
+            return;
+        }
+        for (uint32_t sprite : c.tiles) {
+            if (sprite == 0) {
+                continue;
+            }
+            uint32_t page = sprite_manager::get_page(sprite);
+            auto it = std::find_if(c.pages.begin(), c.pages.end(), [page](const page_range& p) { return p.page == page; });
+            if (it == c.pages.end()) {
+                c.pages.push_back({page, sprite_manager::get_transform(sprite)[2][2], 0, 0});
+                it = c.pages.end() - 1;
+            }
+            it->count += 6;
+        }
+        std::sort(c.pages.begin(), c.pages.end(), [](const page_range& a, const page_range& b) { return a.page < b.page; });
+        uint32_t total = 0;
+        for (page_range& p : c.pages) {
+            p.first = total;
+            total += p.count;
+            p.count = 0;
+        }
+
+        std::vector<vertex> vertices(total);
+        for (uint32_t i = 0; i < TILES_PER_CHUNK; i++) {
+            uint32_t sprite = c.tiles[i];
+            if (sprite == 0) {
+                continue;
+            }
+            uint32_t page = sprite_manager::get_page(sprite);
+            page_range& p = *std::find_if(c.pages.begin(), c.pages.end(), [page](const page_range& r) { return r.page == page; });
+            const vml::mat3& t = sprite_manager::get_transform(sprite);
+            const vml::vec4& trim = sprite_manager::get_trim(sprite);
+            float x = ((float)(i % CHUNK_SIZE) + trim[0]) * this->tile_size;
+            float y = ((float)(i / CHUNK_SIZE) + trim[1]) * this->tile_size;
+            float w = trim[2] * this->tile_size, h = trim[3] * this->tile_size;
+            //--Same corner order as the rect_2D quad--//
+            const float corners[6][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+            vertex* out = &vertices[p.first + p.count];
+            for (const float* corner : corners) {
+                vml::vec3 uv = t * vml::vec3(corner[0], corner[1], 1.0f);
+                *out++ = {{x + corner[0] * w, y + corner[1] * h}, {uv[0], uv[1]}};
+            }
+            p.count += 6;
+        }
+        c.geometry = render_manager::allocate_static(vertices.data(), total, c.first);
+        if (c.geometry == 0) {
+            c.pages.clear();
+        }
+        else {
+            c.vertex_count = total;
+        }
+        this->last.rebuilt++;
+    }
+
+    void tilemap::submit(chunk& c, int32_t cx, int32_t cy) {
+        if (c.dirty) {
+            this->build(c);
+        }
+        if (c.geometry == 0) {
+            return;
+        }
+        this->last.visible++;
+        float extent = this->get_chunk_extent();
+        vml::mat4 model = vml::mat4::identity();
+        model[3][0] = (float)cx * extent;
+        model[3][1] = (float)cy * extent;
+        for (const page_range& p : c.pages) {
+            //--UVs are baked into the vertices, only the page's layer is left for the texture transform--//
+            render_queue::draw_command command = {
+                    this->pipeline, render_queue::geometry::buffer, p.count, c.first + p.first,
+                    model,
+                    vml::mat3(1.0f, 0.0f, 0.0f,
+                              0.0f, 1.0f, 0.0f,
+                              0.0f, 0.0f, p.layer),
+                    vml::mat4::identity(),
+                    c.geometry,
+                    this->opaque};
+            //--The key only has 8 bits for the page, later pages share the last bucket and just batch less well--//
+            render_queue::submit(render_queue::make_key(this->layer, (uint16_t)this->pipeline, (uint8_t)std::min(p.page, 255u), 0), command);
+            this->last.draws++;
+            this->last.quads += p.count / 6;
+        }
+    }
+}
@@ -0,0 +1,257 @@
+#include "render/tilemap_streamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <render/sprite_manager.hpp>
+#include <render/vertex.hpp>
+#include <resource/resource_manager.hpp>
+
+namespace render {
+    namespace {
+        const uint32_t TILES_PER_CHUNK = tilemap::CHUNK_SIZE * tilemap::CHUNK_SIZE;
+        const float CHUNK_LIMIT = 1073741824.0f;
+
+        int32_t clamp_chunk(float c) {
+            return (int32_t)std::max(-CHUNK_LIMIT, std::min(CHUNK_LIMIT, std::floor(c)));
+        }
+        float milliseconds_since(std::chrono::steady_clock::time_point t) {
+            return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t).count();
+        }
+    }
+
+    tilemap_streamer::tilemap_streamer(tilemap& map, const std::vector<std::string>& folders) : map(map), folders(folders) {
+    }
+
+    tilemap_streamer::~tilemap_streamer() {
+        this->closing = true;
+        job::job_system::wait(&this->loads);
+    }
+
+    void tilemap_streamer::set_settings(const settings& s) {
+        this->config = s;
+        this->has_centre = false;
+    }
+
+    void tilemap_streamer::update(const vml::vec2& position, const vml::vec2& velocity) {
+        this->frame++;
+        float inverse_extent = 1.0f / this->map.get_chunk_extent();
+        int32_t cx = clamp_chunk(position[0] * inverse_extent), cy = clamp_chunk(position[1] * inverse_extent);
+        int32_t ax = clamp_chunk((position[0] + velocity[0] * this->config.prefetch_time) * inverse_extent);
+        int32_t ay = clamp_chunk((position[1] + velocity[1] * this->config.prefetch_time) * inverse_extent);
+
+        //--The wanted set only changes when the camera or the predicted position crosses into another chunk--//
+        if (!this->has_centre || cx != this->centre_x || cy != this->centre_y || ax != this->ahead_x || ay != this->ahead_y) {
+            this->has_centre = true;
+            this->centre_x = cx;
+            this->centre_y = cy;
+            this->ahead_x = ax;
+            this->ahead_y = ay;
+
+            std::vector<uint64_t> previous;
+            previous.swap(this->desired);
+            for (uint64_t key : previous) {
+                auto it = this->entries.find(key);
+                if (it != this->entries.end()) {
+                    it->second.desired = false;
+                }
+            }
+            this->queue.clear();
+            this->needed.clear();
+
+            //--Rings outwards from the camera so the nearest chunks are started first, then the same around the predicted position--//
+            int32_t radius = (int32_t)this->config.radius;
+            for (int32_t pass = 0; pass < 2; pass++) {
+                int32_t ox = pass == 0 ? cx : ax, oy = pass == 0 ? cy : ay;
+                if (pass == 1 && ox == cx && oy == cy) {
+                    break;
+                }
+                for (int32_t d = 0; d <= radius; d++) {
+                    for (int32_t y = oy - d; y <= oy + d; y++) {
+                        for (int32_t x = ox - d; x <= ox + d; x++) {
+                            if (std::abs(x - ox) == d || std::abs(y - oy) == d) {
+                                this->request(x, y, pass == 0);
+                            }
+                        }
+                    }
+                }
+            }
+
+            //--Anything that fell out of range before it started loading is forgotten, as are known holes--//
+            for (uint64_t key : previous) {
+                auto it = this->entries.find(key);
+                if (it != this->entries.end() && !it->second.desired && (it->second.s == state::queued || it->second.s == state::absent)) {
+                    this->entries.erase(it);
+                }
+            }
+        }
+
+        this->start_loads();
+        this->evict();
+        this->count_misses();
+        this->counts.queued = (uint32_t)this->queue.size();
+    }
+
+    uint64_t tilemap_streamer::chunk_key(int32_t cx, int32_t cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint64_t)(uint32_t)cy;
+    }
+
+    void tilemap_streamer::request(int32_t cx, int32_t cy, bool needed) {
+        uint64_t key = chunk_key(cx, cy);
+        entry& e = this->entries[key];
+        if (!e.desired) {
+            e.desired = true;
+            this->desired.push_back(key);
+            if (e.s == state::unrequested) {
+                e.s = state::queued;
+            }
+            if (e.s == state::queued) {
+                this->queue.push_back(key);
+            }
+            if (needed) {
+                this->needed.push_back(key);
+            }
+        }
+        e.last_used = this->frame;
+    }
+
+    //--Holes in the region files have nothing to draw, so only chunks still queued or loading count--//
+    void tilemap_streamer::count_misses() {
+        for (uint64_t key : this->needed) {
+            auto it = this->entries.find(key);
+            if (it != this->entries.end() && (it->second.s == state::queued || it->second.s == state::loading)) {
+                this->counts.misses++;
+            }
+        }
+    }
+
+    void tilemap_streamer::start_loads() {
+        size_t next = 0;
+        while (next < this->queue.size() && this->counts.loading < this->config.max_in_flight) {
+            uint64_t key = this->queue[next++];
+            entry& e = this->entries[key];
+            e.s = state::loading;
+            e.requested = std::chrono::steady_clock::now();
+            this->counts.loading++;
+            int32_t cx = (int32_t)(uint32_t)(key >> 32);
+            int32_t cy = (int32_t)(uint32_t)key;
+            job::job_system::run([this, cx, cy]() {
+                std::shared_ptr<loaded_chunk> c = std::make_shared<loaded_chunk>(this->load(cx, cy));
+                job::job_system::run_on_main([this, cx, cy, c]() {
+                    this->finish(cx, cy, *c);
+                }, &this->loads);
+            }, &this->loads);
+        }
+        this->queue.erase(this->queue.begin(), this->queue.begin() + (std::ptrdiff_t)next);
+    }
+
+    tilemap_streamer::loaded_chunk tilemap_streamer::load(int32_t cx, int32_t cy) {
+        loaded_chunk out;
+        int32_t rx = resource::region_file::region_of(cx), ry = resource::region_file::region_of(cy);
+        uint64_t region_key = chunk_key(rx, ry);
+        std::string file_name = resource::region_file::get_file_name(rx, ry);
+
+        std::shared_ptr<resource::region_file::index> index;
+        {
+            std::lock_guard<std::mutex> guard(this->index_lock);
+            auto it = this->indices.find(region_key);
+            if (it != this->indices.end()) {
+                index = it->second;
+            }
+        }
+        if (!index) {
+            //--A missing or unreadable region is cached as empty so its chunks don't go back to disk--//
+            index = std::make_shared<resource::region_file::index>();
+            std::vector<uint8_t> header = resource::resource_manager::read_binary_file_range(file_name, this->folders, 0, resource::region_file::INDEX_SIZE);
+            if (!header.empty() && !resource::region_file::read_index(header, *index)) {
+                printf("Region file %s has an invalid index\n", file_name.c_str());
+                index->offsets.clear();
+            }
+            else if (!header.empty() && index->chunk_size != (uint32_t)tilemap::CHUNK_SIZE) {
+                printf("Region file %s holds %u tile chunks, expected %d\n", file_name.c_str(), index->chunk_size, tilemap::CHUNK_SIZE);
+                index->offsets.clear();
+            }
+            std::lock_guard<std::mutex> guard(this->index_lock);
+            index = this->indices.emplace(region_key, index).first->second;
+        }
+
+        uint32_t slot = resource::region_file::slot_of(cx, cy);
+        if (index->offsets.empty() || index->offsets[slot] == 0) {
+            return out;
+        }
+        std::vector<uint8_t> data = resource::resource_manager::read_binary_file_range(file_name, this->folders, index->offsets[slot], index->sizes[slot]);
+        if (!resource::region_file::decode_chunk(data, TILES_PER_CHUNK, out.data)) {
+            printf("Could not decode chunk %d, %d from %s\n", cx, cy, file_name.c_str());
+            return out;
+        }
+        out.found = true;
+        return out;
+    }
+
+    void tilemap_streamer::finish(int32_t cx, int32_t cy, const loaded_chunk& c) {
+        if (this->closing) {
+            return;
+        }
+        this->counts.loading--;
+        auto it = this->entries.find(chunk_key(cx, cy));
+        if (it == this->entries.end()) {
+            return;
+        }
+        entry& e = it->second;
+        if (!c.found) {
+            e.s = state::absent;
+            if (!e.desired) {
+                this->entries.erase(it);
+            }
+            return;
+        }
+
+        //--Palette entries are resolved once, unknown names come back as 0 and stay empty--//
+        std::vector<uint32_t> sprites(c.data.palette.size());
+        for (size_t i = 0; i < sprites.size(); i++) {
+            sprites[i] = c.data.palette[i] == 0 ? 0 : sprite_manager::get_sprite(c.data.palette[i]);
+        }
+        this->scratch.resize(TILES_PER_CHUNK);
+        uint32_t filled = 0;
+        for (uint32_t i = 0; i < TILES_PER_CHUNK; i++) {
+            this->scratch[i] = sprites[c.data.tiles[i]];
+            filled += this->scratch[i] != 0;
+        }
+        this->map.set_chunk(cx, cy, this->scratch.data());
+
+        e.s = state::resident;
+        e.bytes = TILES_PER_CHUNK * sizeof(uint32_t) + filled * 6 * sizeof(vertex);
+        this->counts.bytes += e.bytes;
+        this->counts.resident++;
+        this->counts.loaded++;
+        float latency = milliseconds_since(e.requested);
+        this->counts.last_latency_ms = latency;
+        this->counts.max_latency_ms = std::max(this->counts.max_latency_ms, latency);
+        this->counts.average_latency_ms += (latency - this->counts.average_latency_ms) / (float)this->counts.loaded;
+    }
+
+    //--Least recently wanted chunks go first, anything in the current wanted set is never evicted--//
+    void tilemap_streamer::evict() {
+        if (this->counts.bytes <= this->config.memory_budget) {
+            return;
+        }
+        std::vector<std::pair<uint64_t, uint64_t>> candidates;
+        for (const auto& e : this->entries) {
+            if (e.second.s == state::resident && !e.second.desired) {
+                candidates.emplace_back(e.second.last_used, e.first);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& c : candidates) {
+            if (this->counts.bytes <= this->config.memory_budget) {
+                break;
+            }
+            auto it = this->entries.find(c.second);
+            this->map.remove_chunk((int32_t)(uint32_t)(c.second >> 32), (int32_t)(uint32_t)c.second);
+            this->counts.bytes -= it->second.bytes;
+            this->counts.resident--;
+            this->counts.evicted++;
+            this->entries.erase(it);
+        }
+    }
+}
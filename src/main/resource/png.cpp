@@ -0,0 +1,97 @@
+#include "resource/png.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace resource::png {
+    namespace {
+        //--Stored deflate blocks carry at most this many bytes each--//
+        const uint32_t STORED_BLOCK = 65535;
+
+        uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0xFFFFFFFF) {
+            static uint32_t table[256] = {};
+            if (table[1] == 0) {
+                for (uint32_t n = 0; n < 256; n++) {
+                    uint32_t c = n;
+                    for (uint32_t k = 0; k < 8; k++) {
+                        c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+                    }
+                    table[n] = c;
+                }
+            }
+            for (size_t i = 0; i < size; i++) {
+                crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return crc;
+        }
+
+        void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+            out.push_back((uint8_t)(v >> 24));
+            out.push_back((uint8_t)(v >> 16));
+            out.push_back((uint8_t)(v >> 8));
+            out.push_back((uint8_t)v);
+        }
+
+        void put_chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+            put_u32(out, (uint32_t)data.size());
+            size_t start = out.size();
+            out.insert(out.end(), type, type + 4);
+            out.insert(out.end(), data.begin(), data.end());
+            put_u32(out, crc32(out.data() + start, out.size() - start) ^ 0xFFFFFFFF);
+        }
+    }
+
+    std::vector<uint8_t> encode(const uint8_t* pixels, uint32_t width, uint32_t height) {
+        //--Every row starts with filter type 0, the bytes follow unchanged--//
+        size_t row = (size_t)width * 4;
+        std::vector<uint8_t> raw;
+        raw.reserve((row + 1) * height);
+        for (uint32_t y = 0; y < height; y++) {
+            raw.push_back(0);
+            raw.insert(raw.end(), pixels + row * y, pixels + row * (y + 1));
+        }
+
+        std::vector<uint8_t> zlib = {0x78, 0x01};
+        zlib.reserve(raw.size() + raw.size() / STORED_BLOCK * 5 + 16);
+        size_t offset = 0;
+        do {
+            uint32_t size = (uint32_t)std::min<size_t>(STORED_BLOCK, raw.size() - offset);
+            zlib.push_back(offset + size == raw.size() ? 1 : 0);
+            zlib.push_back((uint8_t)size);
+            zlib.push_back((uint8_t)(size >> 8));
+            zlib.push_back((uint8_t)~size);
+            zlib.push_back((uint8_t)(~size >> 8));
+            zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+            offset += size;
+        } while (offset < raw.size());
+        uint32_t a = 1, b = 0;
+        for (uint8_t v : raw) {
+            a = (a + v) % 65521;
+            b = (b + a) % 65521;
+        }
+        put_u32(zlib, b << 16 | a);
+
+        std::vector<uint8_t> header;
+        put_u32(header, width);
+        put_u32(header, height);
+        //--8 bits per channel, RGBA, default compression, filtering and no interlacing--//
+        header.insert(header.end(), {8, 6, 0, 0, 0});
+
+        std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        put_chunk(out, "IHDR", header);
+        put_chunk(out, "IDAT", zlib);
+        put_chunk(out, "IEND", {});
+        return out;
+    }
+
+    bool write(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height) {
+        std::vector<uint8_t> data = encode(pixels, width, height);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write((const char*)data.data(), (std::streamsize)data.size());
+        return file.good();
+    }
+}
@@ -0,0 +1,131 @@
+#include "resource/region_file.hpp"
+
+namespace resource::region_file {
+    namespace {
+        const uint8_t MAGIC[4] = {'T', 'M', 'R', '1'};
+        const uint32_t MAX_RUN = 0xFFFF;
+
+        uint32_t read_u32(const uint8_t* in) {
+            return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | (uint32_t)in[3];
+        }
+        uint16_t read_u16(const uint8_t* in) {
+            return (uint16_t)(((uint32_t)in[0] << 8) | (uint32_t)in[1]);
+        }
+        void write_u32(std::vector<uint8_t>& out, uint32_t v) {
+            out.push_back((uint8_t)(v >> 24));
+            out.push_back((uint8_t)(v >> 16));
+            out.push_back((uint8_t)(v >> 8));
+            out.push_back((uint8_t)v);
+        }
+        void write_u16(std::vector<uint8_t>& out, uint16_t v) {
+            out.push_back((uint8_t)(v >> 8));
+            out.push_back((uint8_t)v);
+        }
+    }
+
+    int32_t region_of(int32_t chunk_coordinate) {
+        const int32_t size = (int32_t)REGION_SIZE;
+        return chunk_coordinate >= 0 ? chunk_coordinate / size : (chunk_coordinate + 1) / size - 1;
+    }
+
+    uint32_t slot_of(int32_t cx, int32_t cy) {
+        const int32_t size = (int32_t)REGION_SIZE;
+        return (uint32_t)((cy - region_of(cy) * size) * size + (cx - region_of(cx) * size));
+    }
+
+    std::string get_file_name(int32_t rx, int32_t ry) {
+        return "r." + std::to_string(rx) + "." + std::to_string(ry) + ".tmr";
+    }
+
+    bool read_index(const std::vector<uint8_t>& data, index& out) {
+        if (data.size() < INDEX_SIZE || data[0] != MAGIC[0] || data[1] != MAGIC[1] || data[2] != MAGIC[2] || data[3] != MAGIC[3] ||
+            read_u32(data.data() + 8) != REGION_SIZE) {
+            return false;
+        }
+        out.chunk_size = read_u32(data.data() + 4);
+        out.offsets.resize(REGION_SIZE * REGION_SIZE);
+        out.sizes.resize(REGION_SIZE * REGION_SIZE);
+        const uint8_t* entry = data.data() + HEADER_SIZE;
+        for (uint32_t i = 0; i < REGION_SIZE * REGION_SIZE; i++, entry += 8) {
+            out.offsets[i] = read_u32(entry);
+            out.sizes[i] = read_u32(entry + 4);
+        }
+        return true;
+    }
+
+    bool decode_chunk(const std::vector<uint8_t>& data, uint32_t tile_count, chunk& out) {
+        if (data.size() < 4) {
+            return false;
+        }
+        uint32_t palette_count = read_u32(data.data());
+        size_t position = 4;
+        if (palette_count == 0 || palette_count > MAX_RUN + 1 || data.size() < position + palette_count * 8 + 4) {
+            return false;
+        }
+        out.palette.resize(palette_count);
+        for (name_id& id : out.palette) {
+            id = ((name_id)read_u32(data.data() + position) << 32) | read_u32(data.data() + position + 4);
+            position += 8;
+        }
+        uint32_t run_count = read_u32(data.data() + position);
+        position += 4;
+        if (data.size() < position + (size_t)run_count * 4) {
+            return false;
+        }
+        out.tiles.clear();
+        out.tiles.reserve(tile_count);
+        for (uint32_t i = 0; i < run_count; i++, position += 4) {
+            uint16_t length = read_u16(data.data() + position);
+            uint16_t value = read_u16(data.data() + position + 2);
+            if (value >= palette_count || out.tiles.size() + length > tile_count) {
+                return false;
+            }
+            out.tiles.insert(out.tiles.end(), length, value);
+        }
+        return out.tiles.size() == tile_count;
+    }
+
+    std::vector<uint8_t> encode_chunk(const chunk& c) {
+        std::vector<uint8_t> out;
+        write_u32(out, (uint32_t)c.palette.size());
+        for (name_id id : c.palette) {
+            write_u32(out, (uint32_t)(id >> 32));
+            write_u32(out, (uint32_t)id);
+        }
+        size_t run_count_at = out.size();
+        write_u32(out, 0);
+        uint32_t runs = 0;
+        for (size_t i = 0; i < c.tiles.size();) {
+            size_t end = i + 1;
+            while (end < c.tiles.size() && c.tiles[end] == c.tiles[i] && end - i < MAX_RUN) {
+                end++;
+            }
+            write_u16(out, (uint16_t)(end - i));
+            write_u16(out, c.tiles[i]);
+            runs++;
+            i = end;
+        }
+        out[run_count_at] = (uint8_t)(runs >> 24);
+        out[run_count_at + 1] = (uint8_t)(runs >> 16);
+        out[run_count_at + 2] = (uint8_t)(runs >> 8);
+        out[run_count_at + 3] = (uint8_t)runs;
+        return out;
+    }
+
+    std::vector<uint8_t> encode_region(uint32_t chunk_size, const std::vector<std::vector<uint8_t>>& chunks) {
+        std::vector<uint8_t> out(MAGIC, MAGIC + 4);
+        write_u32(out, chunk_size);
+        write_u32(out, REGION_SIZE);
+        uint32_t offset = INDEX_SIZE;
+        for (uint32_t i = 0; i < REGION_SIZE * REGION_SIZE; i++) {
+            uint32_t size = i < chunks.size() ? (uint32_t)chunks[i].size() : 0;
+            write_u32(out, size > 0 ? offset : 0);
+            write_u32(out, size);
+            offset += size;
+        }
+        for (uint32_t i = 0; i < REGION_SIZE * REGION_SIZE && i < chunks.size(); i++) {
+            out.insert(out.end(), chunks[i].begin(), chunks[i].end());
+        }
+        return out;
+    }
+}
@@ -16,13 +16,16 @@ namespace resource::resource_manager {
         info_p->folder = folder;
         info_p->separator = separator;
     }
-    std::vector<uint8_t> read_binary_file(const std::string& file_name, const std::vector<std::string>& folders) {
+    std::string get_folder_path(const std::vector<std::string>& folders) {
         std::string fullPath = info_p->folder;
         for (const std::string& d : folders) {
             fullPath = fullPath.append(d);
             fullPath = fullPath.append(&info_p->separator, 1);
         }
-        fullPath = fullPath.append(file_name);
+        return fullPath;
+    }
+    std::vector<uint8_t> read_binary_file(const std::string& file_name, const std::vector<std::string>& folders) {
+        std::string fullPath = get_folder_path(folders).append(file_name);
         std::ifstream file(fullPath, std::ios::ate | std::ios::binary);
         if (!file.is_open()) {
             return {};
@@ -33,4 +36,27 @@ namespace resource::resource_manager {
         file.read((char*)buffer.data(), fileSize);
         return buffer;
     }
+    std::vector<uint8_t> read_binary_file_range(const std::string& file_name, const std::vector<std::string>& folders, uint64_t offset, uint32_t size) {
+        std::string fullPath = get_folder_path(folders).append(file_name);
+        std::ifstream file(fullPath, std::ios::binary);
+        if (!file.is_open()) {
+            return {};
+        }
+        std::vector<uint8_t> buffer(size);
+        file.seekg((std::streamoff)offset);
+        file.read((char*)buffer.data(), size);
+        if ((uint32_t)file.gcount() != size) {
+            return {};
+        }
+        return buffer;
+    }
+    bool write_binary_file(const std::string& file_name, const std::vector<std::string>& folders, const std::vector<uint8_t>& data) {
+        std::string fullPath = get_folder_path(folders).append(file_name);
+        std::ofstream file(fullPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write((const char*)data.data(), (std::streamsize)data.size());
+        return file.good();
+    }
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "vulkan_wrapper.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <memory>
 #include <vulkan/vulkan.h>
 #include <optional>
@@ -8,11 +11,21 @@
 namespace vulkan_wrapper {
     namespace {
         const int MAX_FRAMES_IN_FLIGHT = 3;
+        const uint32_t MAX_DESCRIPTOR_SETS = 32;
+        const uint32_t MAX_STORAGE_DESCRIPTORS = 128;
         void (*resolution_function)(int*, int*);
         struct Command {
             vk::CommandPool pool;
             std::vector<vk::CommandBuffer> buffers;
         };
+        //--Destroyed once every frame submitted before it was retired has finished, unset handles are skipped--//
+        struct retired_object {
+            vk::Pipeline pipeline;
+            vk::PipelineLayout layout;
+            vk::Buffer buffer;
+            vk::DeviceMemory memory;
+            uint64_t retire_after;
+        };
         struct info {
             vk::Instance instance;
             vk::SurfaceKHR surface;
@@ -24,6 +37,9 @@ namespace vulkan_wrapper {
             vk::Queue present_queue;
             uint32_t graphics_id;
             uint32_t present_id;
+            //--Compute is recorded into the graphics command buffer so it needs the same family--//
+            bool compute_supported = false;
+            vk::DescriptorPool descriptor_pool;
 
             vk::SwapchainKHR swapchain;
             std::vector<vk::Image> swapchain_images;
@@ -33,14 +49,51 @@ namespace vulkan_wrapper {
             std::vector<vk::Framebuffer> swapchain_framebuffers;
             vk::RenderPass render_pass;
 
+            //--One depth image is shared by every framebuffer, the subpass dependency orders its use between frames--//
+            bool depth_enabled = false;
+            vk::Format depth_format = vk::Format::eUndefined;
+            vk::Image depth_image;
+            vk::DeviceMemory depth_memory;
+            vk::ImageView depth_view;
+
+            //--Fragment shader invocations per frame in flight, read back once that frame's fence has signalled--//
+            bool statistics_supported = false;
+            bool count_fragments = false;
+            vk::QueryPool query_pool;
+            std::vector<bool> query_written;
+            uint64_t fragment_invocations = 0;
+
+            //--Headless renders into one offscreen image in place of the swapchain, there is no surface and nothing is presented--//
+            bool headless = false;
+            vk::Extent2D headless_extent;
+            vk::DeviceMemory offscreen_memory;
+
+            //--Per frame in flight, the colour target is copied in after the render pass and read once the frame's fence has signalled--//
+            bool capture_supported = false;
+            bool capture_requested = false;
+            std::vector<vk::Buffer> capture_buffers;
+            std::vector<vk::DeviceMemory> capture_memory;
+            std::vector<bool> capture_written;
+            vk::Extent2D capture_extent;
+            std::vector<uint8_t> capture;
+            bool capture_ready = false;
+
             std::vector<Command> commands;
             std::vector<vk::Semaphore> image_available_semaphores;
             std::vector<vk::Semaphore> render_finished_semaphores;
             std::vector<vk::Fence> in_flight_fences;
             std::vector<vk::Fence> images_in_flight;
 
+            //--The frame being recorded and the last one submitted--//
+            frame_stats recording;
+            frame_stats submitted;
+
             size_t current_frame = 0;
             bool draw = false;
+            //--Set while the prepare callback records transfers and dispatches ahead of the render pass--//
+            bool prepare = false;
+            uint64_t submitted_frames = 0;
+            std::vector<retired_object> retired_objects;
 
             vk::DispatchLoaderDynamic dldi;
 #ifdef DEBUG_MODE
@@ -49,6 +102,10 @@ namespace vulkan_wrapper {
         };
         std::unique_ptr<info> info_p;
 
+        double elapsed_ms(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
 #ifdef DEBUG_MODE
         VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
             printf("%s\n", pCallbackData->pMessage);
@@ -65,6 +122,52 @@ namespace vulkan_wrapper {
             info_p->instance.destroyDebugUtilsMessengerEXT(info_p->debugMessenger, nullptr, info_p->dldi);
         }
 #endif
+        void destroy_retired(bool all) {
+            //--The slot about to be reused held the oldest frame in flight, a fence covers every earlier submission too--//
+            uint64_t completed = info_p->submitted_frames >= MAX_FRAMES_IN_FLIGHT ? info_p->submitted_frames - MAX_FRAMES_IN_FLIGHT + 1 : 0;
+            auto keep = std::remove_if(info_p->retired_objects.begin(), info_p->retired_objects.end(), [all, completed](const retired_object& r) {
+                if (!all && r.retire_after > completed) {
+                    return false;
+                }
+                if (r.pipeline) {
+                    info_p->device.destroyPipeline(r.pipeline);
+                    info_p->device.destroyPipelineLayout(r.layout);
+                }
+                if (r.buffer) {
+                    info_p->device.destroyBuffer(r.buffer);
+                    info_p->device.freeMemory(r.memory);
+                }
+                return true;
+            });
+            info_p->retired_objects.erase(keep, info_p->retired_objects.end());
+        }
+        //--Targets stored as BGRA are swizzled so readers always get RGBA--//
+        void collect_capture(size_t slot) {
+            if (slot >= info_p->capture_written.size() || !info_p->capture_written[slot]) {
+                return;
+            }
+            info_p->capture_written[slot] = false;
+            size_t size = (size_t)info_p->capture_extent.width * info_p->capture_extent.height * 4;
+            const uint8_t* mapped = static_cast<const uint8_t*>(info_p->device.mapMemory(info_p->capture_memory[slot], 0, size));
+            info_p->capture.assign(mapped, mapped + size);
+            info_p->device.unmapMemory(info_p->capture_memory[slot]);
+            if (info_p->swapchain_image_format == vk::Format::eB8G8R8A8Unorm || info_p->swapchain_image_format == vk::Format::eB8G8R8A8Srgb) {
+                for (size_t i = 0; i < size; i += 4) {
+                    std::swap(info_p->capture[i], info_p->capture[i + 2]);
+                }
+            }
+            info_p->capture_ready = true;
+        }
+        void destroy_capture_buffers() {
+            for (size_t i = 0; i < info_p->capture_buffers.size(); i++) {
+                info_p->device.destroyBuffer(info_p->capture_buffers[i]);
+                info_p->device.freeMemory(info_p->capture_memory[i]);
+            }
+            info_p->capture_buffers.clear();
+            info_p->capture_memory.clear();
+            info_p->capture_written.clear();
+            info_p->capture_requested = false;
+        }
         struct queue_family_indices {
             std::optional<uint32_t> graphics_family;
             std::optional<uint32_t> present_family;
@@ -72,6 +175,52 @@ namespace vulkan_wrapper {
                 return graphics_family.has_value() && present_family.has_value();
             }
         };
+        //--Device local memory takes the first device local type, falling back to anything the resource allows--//
+        uint32_t find_memory_type(uint32_t type_bits, bool host_visible) {
+            vk::PhysicalDeviceMemoryProperties physcial_device_memory_properties = info_p->physical_device.getMemoryProperties();
+            vk::MemoryPropertyFlags wanted = host_visible ? vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent : vk::MemoryPropertyFlagBits::eDeviceLocal;
+            uint32_t chosen = std::numeric_limits<uint32_t>::max();
+            for (uint32_t i = 0; i < physcial_device_memory_properties.memoryTypeCount; i++) {
+                if ((type_bits & (1u << i)) && (physcial_device_memory_properties.memoryTypes[i].propertyFlags & wanted) == wanted) {
+                    chosen = i;
+                    if (!host_visible) {
+                        break;
+                    }
+                }
+            }
+            if (chosen == std::numeric_limits<uint32_t>::max() && !host_visible) {
+                for (uint32_t i = 0; i < physcial_device_memory_properties.memoryTypeCount && chosen == std::numeric_limits<uint32_t>::max(); i++) {
+                    if (type_bits & (1u << i)) {
+                        chosen = i;
+                    }
+                }
+            }
+            return chosen;
+        }
+        //--Stands in for the swapchain when headless, a single image that is copied from rather than presented--//
+        bool create_offscreen() {
+            info_p->swapchain_image_format = vk::Format::eR8G8B8A8Unorm;
+            info_p->swapchain_extent = info_p->headless_extent;
+            info_p->capture_supported = true;
+            vk::ImageCreateInfo image_create_info = {vk::ImageCreateFlags(), vk::ImageType::e2D, info_p->swapchain_image_format, {info_p->headless_extent.width, info_p->headless_extent.height, 1}, 1, 1,
+                                                     vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+                                                     vk::SharingMode::eExclusive, 0, nullptr, vk::ImageLayout::eUndefined};
+            vk::Image image = info_p->device.createImage(image_create_info);
+            if (!image) {
+                return false;
+            }
+            vk::MemoryRequirements memory_requirements = info_p->device.getImageMemoryRequirements(image);
+            uint32_t chosen = find_memory_type(memory_requirements.memoryTypeBits, false);
+            if (chosen == std::numeric_limits<uint32_t>::max()) {
+                info_p->device.destroyImage(image);
+                return false;
+            }
+            vk::MemoryAllocateInfo memory_allocate_info = {memory_requirements.size, chosen};
+            info_p->offscreen_memory = info_p->device.allocateMemory(memory_allocate_info);
+            info_p->device.bindImageMemory(image, info_p->offscreen_memory, 0);
+            info_p->swapchain_images = {image};
+            return true;
+        }
         queue_family_indices find_queue_families(vk::PhysicalDevice physical_device) {
             queue_family_indices indices;
             std::vector<vk::QueueFamilyProperties> queue_families = physical_device.getQueueFamilyProperties();
@@ -81,8 +230,12 @@ namespace vulkan_wrapper {
                 if (properties.queueCount > 0) {
                     if (properties.queueFlags & vk::QueueFlagBits::eGraphics) {
                         indices.graphics_family = i;
+                        //--Nothing is presented headless, the graphics queue stands in for the present queue--//
+                        if (info_p->headless) {
+                            indices.present_family = i;
+                        }
                     }
-                    if (physical_device.getSurfaceSupportKHR(i, info_p->surface)) {
+                    if (!info_p->headless && physical_device.getSurfaceSupportKHR(i, info_p->surface)) {
                         indices.present_family = i;
                     }
                     if (indices.is_complete()) {
@@ -159,6 +312,9 @@ namespace vulkan_wrapper {
         }
         bool is_device_suitable(vk::PhysicalDevice physcial_device) {
             queue_family_indices indices = find_queue_families(physcial_device);
+            if (info_p->headless) {
+                return indices.is_complete();
+            }
 
             bool extensions_supported = check_device_extension_support(physcial_device);
 
@@ -220,7 +376,7 @@ namespace vulkan_wrapper {
         return false;
     }
 
-    bool create_others() {
+    bool create_others(bool depth_buffer) {
         /////////////////////////
         //// PHYSICAL DEVICE ////
         /////////////////////////
@@ -250,7 +406,25 @@ namespace vulkan_wrapper {
         }
 
         vk::PhysicalDeviceFeatures device_features = {};
-        const std::vector<const char*> device_extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+        info_p->statistics_supported = info_p->physical_device.getFeatures().pipelineStatisticsQuery;
+        device_features.pipelineStatisticsQuery = info_p->statistics_supported ? VK_TRUE : VK_FALSE;
+
+        if (depth_buffer) {
+            for (vk::Format format : {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint}) {
+                if (info_p->physical_device.getFormatProperties(format).optimalTilingFeatures & vk::FormatFeatureFlagBits::eDepthStencilAttachment) {
+                    info_p->depth_format = format;
+                    info_p->depth_enabled = true;
+                    break;
+                }
+            }
+            if (!info_p->depth_enabled) {
+                printf("No depth format is supported, drawing without a depth buffer\n");
+            }
+        }
+        std::vector<const char*> device_extensions;
+        if (!info_p->headless) {
+            device_extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
 #ifdef DEBUG_MODE
         const std::vector<const char*> validation_layers = {"VK_LAYER_LUNARG_standard_validation"};
 #endif
@@ -270,6 +444,14 @@ namespace vulkan_wrapper {
         info_p->present_queue = info_p->device.getQueue(indices.present_family.value(), 0);
         info_p->graphics_id = indices.graphics_family.value();
         info_p->present_id = indices.present_family.value();
+        info_p->compute_supported = !!(info_p->physical_device.getQueueFamilyProperties()[info_p->graphics_id].queueFlags & vk::QueueFlagBits::eCompute);
+
+        /////////////////////////
+        //// DESCRIPTOR POOL ////
+        /////////////////////////
+        vk::DescriptorPoolSize descriptor_pool_size = {vk::DescriptorType::eStorageBuffer, MAX_STORAGE_DESCRIPTORS};
+        vk::DescriptorPoolCreateInfo descriptor_pool_create_info = {vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, MAX_DESCRIPTOR_SETS, 1, &descriptor_pool_size};
+        info_p->descriptor_pool = info_p->device.createDescriptorPool(descriptor_pool_create_info);
 
         ///////////////////////
         //// COMMAND POOLS ////
@@ -303,41 +485,74 @@ namespace vulkan_wrapper {
             info_p->render_finished_semaphores[i] = info_p->device.createSemaphore(semaphore_create_info);
             info_p->in_flight_fences[i] = info_p->device.createFence(fence_create_info);
         }
+
+        /////////////////////
+        //// QUERY POOL ////
+        /////////////////////
+        if (info_p->statistics_supported) {
+            vk::QueryPoolCreateInfo query_pool_create_info = {vk::QueryPoolCreateFlags(), vk::QueryType::ePipelineStatistics, MAX_FRAMES_IN_FLIGHT, vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations};
+            info_p->query_pool = info_p->device.createQueryPool(query_pool_create_info);
+            info_p->query_written.assign(MAX_FRAMES_IN_FLIGHT, false);
+        }
         return create_swapchain();
     }
 
+    bool create_headless(uint32_t width, uint32_t height, bool depth_buffer) {
+        if (!info_p || width == 0 || height == 0) {
+            return false;
+        }
+        info_p->headless = true;
+        info_p->headless_extent = vk::Extent2D(width, height);
+        return create_others(depth_buffer);
+    }
+
     bool create_swapchain() {
         info_p->device.waitIdle();
         ///////////////////
         //// SWAPCHAIN ////
         ///////////////////
-        swapchain_support_details swapchain_support = query_swapchain_support(info_p->physical_device);
+        if (info_p->headless) {
+            if (!create_offscreen()) {
+                return false;
+            }
+        }
+        else {
+            swapchain_support_details swapchain_support = query_swapchain_support(info_p->physical_device);
 
-        vk::SurfaceFormatKHR surface_format = choose_swapchain_surface_format(swapchain_support.formats);
-        vk::PresentModeKHR present_mode = choose_swapchain_present_mode(swapchain_support.present_modes);
-        vk::Extent2D extent = choose_swapchain_extent(swapchain_support.capabilities);
+            vk::SurfaceFormatKHR surface_format = choose_swapchain_surface_format(swapchain_support.formats);
+            vk::PresentModeKHR present_mode = choose_swapchain_present_mode(swapchain_support.present_modes);
+            vk::Extent2D extent = choose_swapchain_extent(swapchain_support.capabilities);
 
-        uint32_t image_count = swapchain_support.capabilities.minImageCount + 1;
-        if (swapchain_support.capabilities.maxImageCount > 0 && image_count > swapchain_support.capabilities.maxImageCount) {
-            image_count = swapchain_support.capabilities.maxImageCount;
-        }
+            uint32_t image_count = swapchain_support.capabilities.minImageCount + 1;
+            if (swapchain_support.capabilities.maxImageCount > 0 && image_count > swapchain_support.capabilities.maxImageCount) {
+                image_count = swapchain_support.capabilities.maxImageCount;
+            }
 
-        queue_family_indices indices = find_queue_families(info_p->physical_device);
-        uint32_t  queue_family_indices[] = {indices.graphics_family.value(), indices.present_family.value()};
-        bool queue_different = indices.graphics_family != indices.present_family;
+            queue_family_indices indices = find_queue_families(info_p->physical_device);
+            uint32_t  queue_family_indices[] = {indices.graphics_family.value(), indices.present_family.value()};
+            bool queue_different = indices.graphics_family != indices.present_family;
 
-        vk::SwapchainCreateInfoKHR swapchain_create_info = {vk::SwapchainCreateFlagsKHR(), info_p->surface, image_count, surface_format.format,
-                                                            surface_format.colorSpace, extent, 1, vk::ImageUsageFlagBits::eColorAttachment,
-                                                            queue_different ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
-                                                            queue_different ? 2U : 0U, queue_different ? queue_family_indices : nullptr,
-                                                            swapchain_support.capabilities.currentTransform, vk::CompositeAlphaFlagBitsKHR::eOpaque,
-                                                            present_mode, VK_TRUE};
+            //--Frames can only be captured if the surface lets its images be copied from--//
+            info_p->capture_supported = !!(swapchain_support.capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc);
+            vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment;
+            if (info_p->capture_supported) {
+                usage |= vk::ImageUsageFlagBits::eTransferSrc;
+            }
+
+            vk::SwapchainCreateInfoKHR swapchain_create_info = {vk::SwapchainCreateFlagsKHR(), info_p->surface, image_count, surface_format.format,
+                                                                surface_format.colorSpace, extent, 1, usage,
+                                                                queue_different ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+                                                                queue_different ? 2U : 0U, queue_different ? queue_family_indices : nullptr,
+                                                                swapchain_support.capabilities.currentTransform, vk::CompositeAlphaFlagBitsKHR::eOpaque,
+                                                                present_mode, VK_TRUE};
 
-        info_p->swapchain = info_p->device.createSwapchainKHR(swapchain_create_info);
+            info_p->swapchain = info_p->device.createSwapchainKHR(swapchain_create_info);
 
-        info_p->swapchain_images = info_p->device.getSwapchainImagesKHR(info_p->swapchain);
-        info_p->swapchain_image_format = surface_format.format;
-        info_p->swapchain_extent = extent;
+            info_p->swapchain_images = info_p->device.getSwapchainImagesKHR(info_p->swapchain);
+            info_p->swapchain_image_format = surface_format.format;
+            info_p->swapchain_extent = extent;
+        }
+        vk::Extent2D extent = info_p->swapchain_extent;
 
         /////////////////////
         //// IMAGE VIEWS ////
@@ -352,21 +567,60 @@ namespace vulkan_wrapper {
             info_p->swapchain_image_views[i] = info_p->device.createImageView(image_view_create_info);
         }
 
+        //////////////////////
+        //// DEPTH BUFFER ////
+        //////////////////////
+        if (info_p->depth_enabled) {
+            vk::ImageCreateInfo image_create_info = {vk::ImageCreateFlags(), vk::ImageType::e2D, info_p->depth_format, {extent.width, extent.height, 1}, 1, 1,
+                                                     vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                                                     vk::SharingMode::eExclusive, 0, nullptr, vk::ImageLayout::eUndefined};
+            if (!(info_p->depth_image = info_p->device.createImage(image_create_info))) {
+                printf("Could not create the depth buffer\n");
+                return false;
+            }
+            vk::MemoryRequirements memory_requirements = info_p->device.getImageMemoryRequirements(info_p->depth_image);
+            uint32_t chosen = find_memory_type(memory_requirements.memoryTypeBits, false);
+            vk::MemoryAllocateInfo memory_allocate_info = {memory_requirements.size, chosen};
+            //--Handles are reset so destroying the swapchain afterwards skips them--//
+            if (chosen == std::numeric_limits<uint32_t>::max() || !(info_p->depth_memory = info_p->device.allocateMemory(memory_allocate_info))) {
+                printf("No memory type fits the depth buffer\n");
+                info_p->device.destroyImage(info_p->depth_image);
+                info_p->depth_image = vk::Image();
+                info_p->depth_memory = vk::DeviceMemory();
+                return false;
+            }
+            info_p->device.bindImageMemory(info_p->depth_image, info_p->depth_memory, 0);
+            vk::ImageViewCreateInfo depth_view_create_info = {vk::ImageViewCreateFlags(), info_p->depth_image, vk::ImageViewType::e2D, info_p->depth_format,
+                                                              {vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eIdentity, vk::ComponentSwizzle::eIdentity},
+                                                              {vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1}};
+            info_p->depth_view = info_p->device.createImageView(depth_view_create_info);
+        }
+
         /////////////////////
         //// RENDER PASS ////
         /////////////////////
-        vk::AttachmentDescription attachment_description = {vk::AttachmentDescriptionFlags(), info_p->swapchain_image_format, vk::SampleCountFlagBits::e1,
-                                                            vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, vk::AttachmentLoadOp::eDontCare,
-                                                            vk::AttachmentStoreOp::eDontCare, vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR};
+        vk::AttachmentDescription attachment_descriptions[2] = {
+            {vk::AttachmentDescriptionFlags(), info_p->swapchain_image_format, vk::SampleCountFlagBits::e1,
+             vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, vk::AttachmentLoadOp::eDontCare,
+             vk::AttachmentStoreOp::eDontCare, vk::ImageLayout::eUndefined, info_p->headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR},
+            //--Depth only lives for the frame so it is never stored--//
+            {vk::AttachmentDescriptionFlags(), info_p->depth_format, vk::SampleCountFlagBits::e1,
+             vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eDontCare, vk::AttachmentLoadOp::eDontCare,
+             vk::AttachmentStoreOp::eDontCare, vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthStencilAttachmentOptimal}};
+        uint32_t attachment_count = info_p->depth_enabled ? 2 : 1;
 
         vk::AttachmentReference attachment_reference = {0, vk::ImageLayout::eColorAttachmentOptimal};
+        vk::AttachmentReference depth_attachment_reference = {1, vk::ImageLayout::eDepthStencilAttachmentOptimal};
 
-        vk::SubpassDescription subpass_description = {vk::SubpassDescriptionFlags(), vk::PipelineBindPoint::eGraphics, 0, nullptr, 1, &attachment_reference, nullptr, nullptr, 0, nullptr};
+        vk::SubpassDescription subpass_description = {vk::SubpassDescriptionFlags(), vk::PipelineBindPoint::eGraphics, 0, nullptr, 1, &attachment_reference, nullptr,
+                                                      info_p->depth_enabled ? &depth_attachment_reference : nullptr, 0, nullptr};
 
-        vk::SubpassDependency subpass_dependency = {~0U, 0, vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::AccessFlags(),
-                                                    vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite, vk::DependencyFlags()};
+        //--Every frame in flight shares the one depth image, so the last frame's late depth writes have to finish before this frame clears it--//
+        vk::PipelineStageFlags dependency_stages = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+        vk::SubpassDependency subpass_dependency = {~0U, 0, dependency_stages, dependency_stages, vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                                                    vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::DependencyFlags()};
 
-        vk::RenderPassCreateInfo render_pass_create_info = {vk::RenderPassCreateFlags(), 1, &attachment_description, 1, &subpass_description, 1, &subpass_dependency};
+        vk::RenderPassCreateInfo render_pass_create_info = {vk::RenderPassCreateFlags(), attachment_count, attachment_descriptions, 1, &subpass_description, 1, &subpass_dependency};
 
         info_p->render_pass = info_p->device.createRenderPass(render_pass_create_info);
 
@@ -376,7 +630,8 @@ namespace vulkan_wrapper {
         info_p->swapchain_framebuffers.resize(info_p->swapchain_image_views.size());
 
         for (uint32_t i = 0; i < info_p->swapchain_framebuffers.size(); i++) {
-            vk::FramebufferCreateInfo framebuffer_create_info = {vk::FramebufferCreateFlags(), info_p->render_pass, 1, &info_p->swapchain_image_views[i],
+            vk::ImageView attachments[2] = {info_p->swapchain_image_views[i], info_p->depth_view};
+            vk::FramebufferCreateInfo framebuffer_create_info = {vk::FramebufferCreateFlags(), info_p->render_pass, attachment_count, attachments,
                                                                 info_p->swapchain_extent.width, info_p->swapchain_extent.height, 1};
 
             info_p->swapchain_framebuffers[i] = info_p->device.createFramebuffer(framebuffer_create_info);
@@ -386,19 +641,15 @@ namespace vulkan_wrapper {
     }
 
     bool create_vertex_buffer(vk::Buffer& buffer, vk::DeviceMemory& memory, uint32_t size) {
-        vk::BufferCreateInfo buffer_create_info = {vk::BufferCreateFlags(), size, vk::BufferUsageFlagBits::eVertexBuffer, vk::SharingMode::eExclusive, 1, &info_p->graphics_id};
+        return create_buffer(buffer, memory, size, vk::BufferUsageFlagBits::eVertexBuffer, true);
+    }
+    bool create_buffer(vk::Buffer& buffer, vk::DeviceMemory& memory, uint32_t size, const vk::BufferUsageFlags& usage, bool host_visible) {
+        vk::BufferCreateInfo buffer_create_info = {vk::BufferCreateFlags(), size, usage, vk::SharingMode::eExclusive, 1, &info_p->graphics_id};
         if (!(buffer = info_p->device.createBuffer(buffer_create_info))) {
             return false;
         }
         vk::MemoryRequirements memory_requirements = info_p->device.getBufferMemoryRequirements(buffer);
-        vk::PhysicalDeviceMemoryProperties physcial_device_memory_properties = info_p->physical_device.getMemoryProperties();
-
-        uint32_t chosen = std::numeric_limits<uint32_t>::max();
-        for (uint32_t i = 0; i < physcial_device_memory_properties.memoryTypeCount; i++) {
-            if ((memory_requirements.memoryTypeBits & (1u << i)) && (physcial_device_memory_properties.memoryTypes[i].propertyFlags & (vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent))) {
-                chosen = i;
-            }
-        }
+        uint32_t chosen = find_memory_type(memory_requirements.memoryTypeBits, host_visible);
         if (chosen == std::numeric_limits<uint32_t>::max()) {
             info_p->device.destroyBuffer(buffer);
             return false;
@@ -412,14 +663,24 @@ namespace vulkan_wrapper {
         return true;
     }
     void map_vertex_buffer(const vk::DeviceMemory& memory, uint32_t size, const void* data) {
+        info_p->recording.uploaded_bytes += size;
         void* mapped_memory = info_p->device.mapMemory(memory, 0, size);
         memcpy(mapped_memory, data, size);
         info_p->device.unmapMemory(memory);
     }
+    void* map_memory(const vk::DeviceMemory& memory, uint32_t size) {
+        return info_p->device.mapMemory(memory, 0, size);
+    }
+    void unmap_memory(const vk::DeviceMemory& memory) {
+        info_p->device.unmapMemory(memory);
+    }
     void destroy_vertex_buffer(const vk::Buffer& buffer, const vk::DeviceMemory& memory) {
         info_p->device.destroyBuffer(buffer);
         info_p->device.freeMemory(memory);
     }
+    void retire_vertex_buffer(const vk::Buffer& buffer, const vk::DeviceMemory& memory) {
+        info_p->retired_objects.push_back({vk::Pipeline(), vk::PipelineLayout(), buffer, memory, info_p->submitted_frames});
+    }
 
     bool create_shader_module(vk::ShaderModule& shader_module, const std::vector<uint8_t>& src) {
         vk::ShaderModuleCreateInfo shader_module_create_info = {vk::ShaderModuleCreateFlags(), src.size(), reinterpret_cast<const uint32_t*>(src.data())};
@@ -437,7 +698,7 @@ namespace vulkan_wrapper {
     void destroy_pipeline_layout(const vk::PipelineLayout& pipeline_layout) {
         info_p->device.destroyPipelineLayout(pipeline_layout);
     }
-    bool create_pipeline(vk::Pipeline& pipeline, const vk::PipelineLayout& pipeline_layout, uint32_t shader_module_count, const vk::PipelineShaderStageCreateInfo* shader_modules, uint32_t vertex_binding_description_count, const vk::VertexInputBindingDescription* vertex_binding_descriptions, uint32_t vertex_attribute_description_count, const vk::VertexInputAttributeDescription* vertex_attribute_descriptions, float target_aspect) {
+    bool create_pipeline(vk::Pipeline& pipeline, const vk::PipelineLayout& pipeline_layout, uint32_t shader_module_count, const vk::PipelineShaderStageCreateInfo* shader_modules, uint32_t vertex_binding_description_count, const vk::VertexInputBindingDescription* vertex_binding_descriptions, uint32_t vertex_attribute_description_count, const vk::VertexInputAttributeDescription* vertex_attribute_descriptions, float target_aspect, pipeline_variant variant) {
         vk::PipelineVertexInputStateCreateInfo pipeline_vertex_input_state_create_info = {vk::PipelineVertexInputStateCreateFlags(), vertex_binding_description_count, vertex_binding_descriptions, vertex_attribute_description_count, vertex_attribute_descriptions};
         vk::PipelineInputAssemblyStateCreateInfo pipeline_assembly_state_create_info = {vk::PipelineInputAssemblyStateCreateFlags(), vk::PrimitiveTopology::eTriangleList, VK_FALSE};
 
@@ -460,32 +721,176 @@ namespace vulkan_wrapper {
         vk::PipelineViewportStateCreateInfo pipeline_viewport_state_create_info = {vk::PipelineViewportStateCreateFlags(), 1, &viewport, 1, &scissor};
         vk::PipelineRasterizationStateCreateInfo pipeline_rasterization_state_create_info = {vk::PipelineRasterizationStateCreateFlags(), VK_FALSE, VK_FALSE, vk::PolygonMode::eFill, vk::CullModeFlagBits::eNone, vk::FrontFace::eClockwise, VK_FALSE, 0.0f, 0.0f, 0.0f, 1.0f};
         vk::PipelineMultisampleStateCreateInfo pipeline_multisample_state_create_info = {vk::PipelineMultisampleStateCreateFlags(), vk::SampleCountFlagBits::e1, VK_FALSE, 1.0f, nullptr, VK_FALSE, VK_FALSE};
-        vk::PipelineColorBlendAttachmentState pipeline_color_blend_attachment_state = {VK_TRUE, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha, vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd, vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
+        //--Opaque pipelines write depth so they can be drawn front to back, translucent ones only test against it--//
+        bool opaque = variant == pipeline_variant::opaque || variant == pipeline_variant::overdraw_opaque;
+        bool overdraw = variant == pipeline_variant::overdraw_translucent || variant == pipeline_variant::overdraw_opaque;
+        vk::PipelineDepthStencilStateCreateInfo pipeline_depth_stencil_state_create_info = {vk::PipelineDepthStencilStateCreateFlags(), VK_TRUE, opaque ? VK_TRUE : VK_FALSE, vk::CompareOp::eLess, VK_FALSE, VK_FALSE, vk::StencilOpState(), vk::StencilOpState(), 0.0f, 1.0f};
+        vk::PipelineColorBlendAttachmentState pipeline_color_blend_attachment_state = {opaque ? VK_FALSE : VK_TRUE, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha, vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd, vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
+        //--Every fragment that survives the depth test adds its output, so the target ends up holding a count per pixel--//
+        if (overdraw) {
+            pipeline_color_blend_attachment_state = {VK_TRUE, vk::BlendFactor::eOne, vk::BlendFactor::eOne, vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eOne, vk::BlendOp::eAdd, vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
+        }
         vk::PipelineColorBlendStateCreateInfo pipeline_color_blend_state_create_info = {vk::PipelineColorBlendStateCreateFlags(), VK_FALSE, vk::LogicOp::eCopy, 1, &pipeline_color_blend_attachment_state, {0.0f, 0.0f, 0.0f, 0.0f}};
 
-        vk::GraphicsPipelineCreateInfo graphics_pipeline_create_info = {vk::PipelineCreateFlags(), shader_module_count, shader_modules, &pipeline_vertex_input_state_create_info, &pipeline_assembly_state_create_info, nullptr, &pipeline_viewport_state_create_info, &pipeline_rasterization_state_create_info, &pipeline_multisample_state_create_info, nullptr, &pipeline_color_blend_state_create_info, nullptr, pipeline_layout, info_p->render_pass, 0, vk::Pipeline(), -1};
+        vk::GraphicsPipelineCreateInfo graphics_pipeline_create_info = {vk::PipelineCreateFlags(), shader_module_count, shader_modules, &pipeline_vertex_input_state_create_info, &pipeline_assembly_state_create_info, nullptr, &pipeline_viewport_state_create_info, &pipeline_rasterization_state_create_info, &pipeline_multisample_state_create_info, info_p->depth_enabled ? &pipeline_depth_stencil_state_create_info : nullptr, &pipeline_color_blend_state_create_info, nullptr, pipeline_layout, info_p->render_pass, 0, vk::Pipeline(), -1};
         pipeline = info_p->device.createGraphicsPipeline(vk::PipelineCache(), graphics_pipeline_create_info);
         return !!pipeline;
     }
     void destroy_pipeline(const vk::Pipeline& pipeline) {
         info_p->device.destroyPipeline(pipeline);
     }
+    void retire_pipeline(const vk::Pipeline& pipeline, const vk::PipelineLayout& pipeline_layout) {
+        info_p->retired_objects.push_back({pipeline, pipeline_layout, vk::Buffer(), vk::DeviceMemory(), info_p->submitted_frames});
+    }
 
-    bool render_frame(void (*external_render)()) {
-        info_p->device.waitForFences(1, &info_p->in_flight_fences[info_p->current_frame], VK_TRUE, std::numeric_limits<uint64_t >::max());
-        vk::ResultValue<uint32_t> result_value = info_p->device.acquireNextImageKHR(info_p->swapchain, std::numeric_limits<uint64_t >::max(), info_p->image_available_semaphores[info_p->current_frame], vk::Fence());
-        if (result_value.result == vk::Result::eErrorOutOfDateKHR) {
-            if (reload_swapchain()) {
-                return render_frame(external_render);
-            }
+    bool supports_compute() {
+        return info_p->compute_supported;
+    }
+    bool create_compute_pipeline(vk::Pipeline& pipeline, const vk::PipelineLayout& pipeline_layout, const vk::PipelineShaderStageCreateInfo& shader_module) {
+        vk::ComputePipelineCreateInfo compute_pipeline_create_info = {vk::PipelineCreateFlags(), shader_module, pipeline_layout, vk::Pipeline(), -1};
+        pipeline = info_p->device.createComputePipeline(vk::PipelineCache(), compute_pipeline_create_info);
+        return !!pipeline;
+    }
+
+    bool create_storage_descriptor_set_layout(vk::DescriptorSetLayout& layout, uint32_t binding_count, const vk::ShaderStageFlags& stage) {
+        std::vector<vk::DescriptorSetLayoutBinding> bindings(binding_count);
+        for (uint32_t i = 0; i < binding_count; i++) {
+            bindings[i] = {i, vk::DescriptorType::eStorageBuffer, 1, stage, nullptr};
+        }
+        vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info = {vk::DescriptorSetLayoutCreateFlags(), binding_count, bindings.data()};
+        layout = info_p->device.createDescriptorSetLayout(descriptor_set_layout_create_info);
+        return !!layout;
+    }
+    void destroy_descriptor_set_layout(const vk::DescriptorSetLayout& layout) {
+        info_p->device.destroyDescriptorSetLayout(layout);
+    }
+    bool allocate_descriptor_set(vk::DescriptorSet& set, const vk::DescriptorSetLayout& layout) {
+        vk::DescriptorSetAllocateInfo descriptor_set_allocate_info = {info_p->descriptor_pool, 1, &layout};
+        if (info_p->device.allocateDescriptorSets(&descriptor_set_allocate_info, &set) != vk::Result::eSuccess) {
+            set = vk::DescriptorSet();
             return false;
         }
-        else if (result_value.result != vk::Result::eSuccess && result_value.result != vk::Result::eSuboptimalKHR) {
+        return true;
+    }
+    void write_storage_buffers(const vk::DescriptorSet& set, uint32_t count, const vk::Buffer* buffers) {
+        std::vector<vk::DescriptorBufferInfo> buffer_infos(count);
+        std::vector<vk::WriteDescriptorSet> writes(count);
+        for (uint32_t i = 0; i < count; i++) {
+            buffer_infos[i] = {buffers[i], 0, VK_WHOLE_SIZE};
+            writes[i] = {set, i, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &buffer_infos[i], nullptr};
+        }
+        info_p->device.updateDescriptorSets(count, writes.data(), 0, nullptr);
+    }
+    void free_descriptor_set(const vk::DescriptorSet& set) {
+        info_p->device.freeDescriptorSets(info_p->descriptor_pool, 1, &set);
+    }
+
+    bool has_depth_buffer() {
+        return info_p->depth_enabled;
+    }
+    bool set_fragment_counting(bool enabled) {
+        info_p->count_fragments = enabled && info_p->statistics_supported;
+        return info_p->count_fragments;
+    }
+    uint64_t get_fragment_invocations() {
+        return info_p->fragment_invocations;
+    }
+    void get_extent(uint32_t& width, uint32_t& height) {
+        width = info_p->swapchain_extent.width;
+        height = info_p->swapchain_extent.height;
+    }
+
+    bool request_capture() {
+        if (!info_p->capture_supported) {
             return false;
         }
-        uint32_t currentIndex = result_value.value;
+        if (info_p->capture_buffers.empty()) {
+            uint32_t size = info_p->swapchain_extent.width * info_p->swapchain_extent.height * 4;
+            for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+                vk::Buffer buffer;
+                vk::DeviceMemory memory;
+                if (!create_buffer(buffer, memory, size, vk::BufferUsageFlagBits::eTransferDst, true)) {
+                    destroy_capture_buffers();
+                    return false;
+                }
+                info_p->capture_buffers.push_back(buffer);
+                info_p->capture_memory.push_back(memory);
+            }
+            info_p->capture_written.assign(MAX_FRAMES_IN_FLIGHT, false);
+            info_p->capture_extent = info_p->swapchain_extent;
+        }
+        info_p->capture_requested = true;
+        return true;
+    }
+    bool read_capture(std::vector<uint8_t>& pixels, uint32_t& width, uint32_t& height) {
+        //--Frames still in flight are only checked, never waited on--//
+        for (size_t slot = 0; slot < info_p->capture_written.size(); slot++) {
+            if (info_p->capture_written[slot] && info_p->device.getFenceStatus(info_p->in_flight_fences[slot]) == vk::Result::eSuccess) {
+                collect_capture(slot);
+            }
+        }
+        if (!info_p->capture_ready) {
+            return false;
+        }
+        info_p->capture_ready = false;
+        pixels.swap(info_p->capture);
+        width = info_p->capture_extent.width;
+        height = info_p->capture_extent.height;
+        return true;
+    }
+
+    const frame_stats& get_frame_stats() {
+        return info_p->submitted;
+    }
+    void add_uploaded_bytes(uint64_t bytes) {
+        info_p->recording.uploaded_bytes += bytes;
+    }
+
+    uint32_t get_frame_count() {
+        return MAX_FRAMES_IN_FLIGHT;
+    }
+    uint32_t begin_frame() {
+        auto wait_start = std::chrono::steady_clock::now();
+        info_p->device.waitForFences(1, &info_p->in_flight_fences[info_p->current_frame], VK_TRUE, std::numeric_limits<uint64_t >::max());
+        info_p->recording.fence_wait_ms += elapsed_ms(wait_start);
+        if (info_p->statistics_supported && info_p->query_written[info_p->current_frame]) {
+            uint64_t invocations = 0;
+            if (info_p->device.getQueryPoolResults(info_p->query_pool, (uint32_t)info_p->current_frame, 1, sizeof(invocations), &invocations, sizeof(invocations), vk::QueryResultFlagBits::e64) == vk::Result::eSuccess) {
+                info_p->fragment_invocations = invocations;
+            }
+            info_p->query_written[info_p->current_frame] = false;
+        }
+        collect_capture(info_p->current_frame);
+        if (!info_p->retired_objects.empty()) {
+            destroy_retired(false);
+        }
+        return (uint32_t)info_p->current_frame;
+    }
+
+    bool render_frame(void (*external_render)(), void (*external_prepare)()) {
+        auto wait_start = std::chrono::steady_clock::now();
+        info_p->device.waitForFences(1, &info_p->in_flight_fences[info_p->current_frame], VK_TRUE, std::numeric_limits<uint64_t >::max());
+        info_p->recording.fence_wait_ms += elapsed_ms(wait_start);
+        uint32_t currentIndex = 0;
+        if (!info_p->headless) {
+            auto acquire_start = std::chrono::steady_clock::now();
+            vk::ResultValue<uint32_t> result_value = info_p->device.acquireNextImageKHR(info_p->swapchain, std::numeric_limits<uint64_t >::max(), info_p->image_available_semaphores[info_p->current_frame], vk::Fence());
+            info_p->recording.acquire_wait_ms += elapsed_ms(acquire_start);
+            if (result_value.result == vk::Result::eErrorOutOfDateKHR) {
+                if (reload_swapchain()) {
+                    return render_frame(external_render, external_prepare);
+                }
+                return false;
+            }
+            else if (result_value.result != vk::Result::eSuccess && result_value.result != vk::Result::eSuboptimalKHR) {
+                return false;
+            }
+            currentIndex = result_value.value;
+        }
         if (info_p->images_in_flight[currentIndex] != vk::Fence()) {
+            wait_start = std::chrono::steady_clock::now();
             info_p->device.waitForFences(1, &info_p->images_in_flight[currentIndex], VK_TRUE, std::numeric_limits<uint64_t >::max());
+            info_p->recording.fence_wait_ms += elapsed_ms(wait_start);
         }
         info_p->images_in_flight[currentIndex] = info_p->in_flight_fences[info_p->current_frame];
 
@@ -494,47 +899,149 @@ namespace vulkan_wrapper {
         vk::CommandBufferBeginInfo command_buffer_begin_info = {};
         info_p->commands[info_p->current_frame].buffers[0].begin(command_buffer_begin_info);
 
+        if (external_prepare) {
+            info_p->prepare = true;
+            external_prepare();
+            info_p->prepare = false;
+        }
+
+        if (info_p->count_fragments) {
+            info_p->commands[info_p->current_frame].buffers[0].resetQueryPool(info_p->query_pool, (uint32_t)info_p->current_frame, 1);
+            info_p->commands[info_p->current_frame].buffers[0].beginQuery(info_p->query_pool, (uint32_t)info_p->current_frame, vk::QueryControlFlags());
+            info_p->recording.commands += 2;
+        }
+
         std::array<float, 4> colour = {0.0f, 0.0f, 0.0f, 1.0f};
-        vk::ClearValue clear_value = {{colour}};
-        vk::RenderPassBeginInfo render_pass_begin_info = {info_p->render_pass, info_p->swapchain_framebuffers[currentIndex], {{0, 0}, info_p->swapchain_extent}, 1, &clear_value};
+        vk::ClearValue clear_values[2] = {vk::ClearColorValue(colour), vk::ClearDepthStencilValue(1.0f, 0)};
+        vk::RenderPassBeginInfo render_pass_begin_info = {info_p->render_pass, info_p->swapchain_framebuffers[currentIndex], {{0, 0}, info_p->swapchain_extent}, info_p->depth_enabled ? 2U : 1U, clear_values};
         info_p->commands[info_p->current_frame].buffers[0].beginRenderPass(render_pass_begin_info, vk::SubpassContents::eInline);
+        info_p->recording.commands++;
 
         info_p->draw = true;
         external_render();
         info_p->draw = false;
 
         info_p->commands[info_p->current_frame].buffers[0].endRenderPass();
+        info_p->recording.commands++;
+        if (info_p->count_fragments) {
+            info_p->commands[info_p->current_frame].buffers[0].endQuery(info_p->query_pool, (uint32_t)info_p->current_frame);
+            info_p->recording.commands++;
+            info_p->query_written[info_p->current_frame] = true;
+        }
+        if (info_p->capture_requested && !info_p->capture_buffers.empty()) {
+            vk::CommandBuffer& command_buffer = info_p->commands[info_p->current_frame].buffers[0];
+            vk::Image image = info_p->swapchain_images[currentIndex];
+            vk::ImageLayout final_layout = info_p->headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+            vk::ImageSubresourceRange range = {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+            vk::ImageMemoryBarrier to_transfer = {vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferRead, final_layout, vk::ImageLayout::eTransferSrcOptimal,
+                                                  VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, range};
+            command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), 0, nullptr, 0, nullptr, 1, &to_transfer);
+            vk::BufferImageCopy region = {0, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1}, {0, 0, 0}, {info_p->capture_extent.width, info_p->capture_extent.height, 1}};
+            command_buffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, info_p->capture_buffers[info_p->current_frame], 1, &region);
+            vk::MemoryBarrier to_host = {vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead};
+            vk::ImageMemoryBarrier to_present = {vk::AccessFlagBits::eTransferRead, vk::AccessFlags(), vk::ImageLayout::eTransferSrcOptimal, final_layout,
+                                                 VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, range};
+            command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost | vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags(), 1, &to_host, 0, nullptr, 1, &to_present);
+            info_p->capture_written[info_p->current_frame] = true;
+            info_p->capture_requested = false;
+            info_p->recording.commands += 3;
+        }
         info_p->commands[info_p->current_frame].buffers[0].end();
 
         vk::Semaphore wait_semaphores[] = {info_p->image_available_semaphores[info_p->current_frame]};
         vk::Semaphore signal_semaphores[] = {info_p->render_finished_semaphores[info_p->current_frame]};
         vk::PipelineStageFlags pipeline_stage_flags[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
-        vk::SubmitInfo submit_info = {1, wait_semaphores, pipeline_stage_flags, 1, &info_p->commands[info_p->current_frame].buffers[0], 1, signal_semaphores};
+        //--Headless frames have no image to wait for and nothing to present--//
+        uint32_t semaphore_count = info_p->headless ? 0 : 1;
+        vk::SubmitInfo submit_info = {semaphore_count, wait_semaphores, pipeline_stage_flags, 1, &info_p->commands[info_p->current_frame].buffers[0], semaphore_count, signal_semaphores};
 
         info_p->device.resetFences(1, &info_p->in_flight_fences[info_p->current_frame]);
         info_p->graphics_queue.submit(1, &submit_info, info_p->in_flight_fences[info_p->current_frame]);
+        info_p->submitted_frames++;
 
-        vk::PresentInfoKHR present_info = {1, signal_semaphores, 1, &info_p->swapchain, &currentIndex};
-        info_p->present_queue.presentKHR(present_info);
+        if (!info_p->headless) {
+            vk::PresentInfoKHR present_info = {1, signal_semaphores, 1, &info_p->swapchain, &currentIndex};
+            info_p->present_queue.presentKHR(present_info);
+        }
 
         (info_p->current_frame += 1) %= MAX_FRAMES_IN_FLIGHT;
+        info_p->submitted = info_p->recording;
+        info_p->recording = frame_stats();
         return true;
     }
     void bind_pipeline(const vk::Pipeline& pipeline) {
         if (!info_p->draw) return;
         info_p->commands[info_p->current_frame].buffers[0].bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+        info_p->recording.pipeline_binds++;
+        info_p->recording.commands++;
     }
     void bind_vertex_buffers(uint32_t count, const vk::Buffer* buffers, const vk::DeviceSize* offsets) {
         if (!info_p->draw) return;
         info_p->commands[info_p->current_frame].buffers[0].bindVertexBuffers(0, count, buffers, offsets);
+        info_p->recording.vertex_binds++;
+        info_p->recording.commands++;
     }
     void push_constants(const vk::PipelineLayout& layout, const vk::ShaderStageFlags& stage, uint32_t offset, uint32_t size, const void* ptr) {
-        if (!info_p->draw) return;
+        if (!info_p->draw && !info_p->prepare) return;
         info_p->commands[info_p->current_frame].buffers[0].pushConstants(layout, stage, offset, size, ptr);
+        info_p->recording.push_constant_bytes += size;
+        info_p->recording.commands++;
     }
     void draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) {
         if (!info_p->draw) return;
         info_p->commands[info_p->current_frame].buffers[0].draw(vertex_count, instance_count, first_vertex, first_instance);
+        info_p->recording.draws++;
+        info_p->recording.instances += instance_count;
+        info_p->recording.commands++;
+    }
+    void draw_indirect(const vk::Buffer& buffer, vk::DeviceSize offset, uint32_t draw_count, uint32_t stride) {
+        if (!info_p->draw) return;
+        info_p->commands[info_p->current_frame].buffers[0].drawIndirect(buffer, offset, draw_count, stride);
+        info_p->recording.draws += draw_count;
+        info_p->recording.commands++;
+    }
+    void bind_descriptor_set(const vk::PipelineBindPoint& bind_point, const vk::PipelineLayout& layout, const vk::DescriptorSet& set) {
+        if (!info_p->draw && !info_p->prepare) return;
+        info_p->commands[info_p->current_frame].buffers[0].bindDescriptorSets(bind_point, layout, 0, 1, &set, 0, nullptr);
+        info_p->recording.commands++;
+    }
+
+    void bind_compute_pipeline(const vk::Pipeline& pipeline) {
+        if (!info_p->prepare) return;
+        info_p->commands[info_p->current_frame].buffers[0].bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+        info_p->recording.pipeline_binds++;
+        info_p->recording.commands++;
+    }
+    void dispatch(uint32_t x, uint32_t y, uint32_t z) {
+        if (!info_p->prepare) return;
+        info_p->commands[info_p->current_frame].buffers[0].dispatch(x, y, z);
+        info_p->recording.commands++;
+    }
+    void copy_buffer(const vk::Buffer& src, const vk::Buffer& dst, uint32_t region_count, const vk::BufferCopy* regions) {
+        if (!info_p->prepare || region_count == 0) return;
+        info_p->commands[info_p->current_frame].buffers[0].copyBuffer(src, dst, region_count, regions);
+        //--Every copy recorded here is out of a staging buffer--//
+        for (uint32_t i = 0; i < region_count; i++) {
+            info_p->recording.uploaded_bytes += regions[i].size;
+        }
+        info_p->recording.commands++;
+    }
+    void update_buffer(const vk::Buffer& buffer, vk::DeviceSize offset, uint32_t size, const void* data) {
+        if (!info_p->prepare) return;
+        info_p->commands[info_p->current_frame].buffers[0].updateBuffer(buffer, offset, size, data);
+        info_p->recording.uploaded_bytes += size;
+        info_p->recording.commands++;
+    }
+    void fill_buffer(const vk::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size, uint32_t data) {
+        if (!info_p->prepare) return;
+        info_p->commands[info_p->current_frame].buffers[0].fillBuffer(buffer, offset, size, data);
+        info_p->recording.commands++;
+    }
+    void memory_barrier(const vk::PipelineStageFlags& src_stage, const vk::AccessFlags& src_access, const vk::PipelineStageFlags& dst_stage, const vk::AccessFlags& dst_access) {
+        if (!info_p->prepare) return;
+        vk::MemoryBarrier barrier = {src_access, dst_access};
+        info_p->commands[info_p->current_frame].buffers[0].pipelineBarrier(src_stage, dst_stage, vk::DependencyFlags(), 1, &barrier, 0, nullptr, 0, nullptr);
+        info_p->recording.commands++;
     }
 
     bool reload_swapchain() {
@@ -548,19 +1055,35 @@ namespace vulkan_wrapper {
             info_p->device.destroyFramebuffer(framebuffer);
         }
         info_p->device.destroyRenderPass(info_p->render_pass);
-        
+        if (info_p->depth_enabled) {
+            info_p->device.destroyImageView(info_p->depth_view);
+            info_p->device.destroyImage(info_p->depth_image);
+            info_p->device.freeMemory(info_p->depth_memory);
+        }
+
         for (const vk::ImageView& image_view : info_p->swapchain_image_views) {
             info_p->device.destroyImageView(image_view);
         }
-        info_p->device.destroySwapchainKHR(info_p->swapchain);
+        //--Sized to the old extent, the next capture makes new ones--//
+        destroy_capture_buffers();
+        if (info_p->headless) {
+            info_p->device.destroyImage(info_p->swapchain_images[0]);
+            info_p->device.freeMemory(info_p->offscreen_memory);
+            info_p->swapchain_images.clear();
+        }
+        else {
+            info_p->device.destroySwapchainKHR(info_p->swapchain);
+        }
     }
 
     void wait_idle() {
         info_p->device.waitIdle();
+        destroy_retired(true);
     }
 
     void terminate() {
         destroy_swapchain();
+        destroy_retired(true);
 
         for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             info_p->device.destroySemaphore(info_p->image_available_semaphores[i]);
@@ -572,13 +1095,19 @@ namespace vulkan_wrapper {
             info_p->device.freeCommandBuffers(cmd.pool, cmd.buffers);
             info_p->device.destroyCommandPool(cmd.pool);
         }
+        info_p->device.destroyDescriptorPool(info_p->descriptor_pool);
+        if (info_p->statistics_supported) {
+            info_p->device.destroyQueryPool(info_p->query_pool);
+        }
 
         info_p->device.destroy();
 
 #ifdef DEBUG_MODE
         destroyDebugUtilsMessengerEXT();
 #endif
-        info_p->instance.destroySurfaceKHR(info_p->surface);
+        if (info_p->surface) {
+            info_p->instance.destroySurfaceKHR(info_p->surface);
+        }
         info_p->instance.destroy();
         info_p.reset(nullptr);
     }
@@ -12,9 +12,10 @@ layout(push_constant) uniform Info {
 
 layout(location = 0) in vec2 uvIn;
 layout(location = 1) in vec3 normalIn;
+layout(location = 2) in vec4 colourIn;
 
 layout(location = 0) out vec4 outColour;
 
 void main() {
-    outColour = vec4(1.0, 1.0, 1.0, 1.0);
+    outColour = colourIn;
 }
\ No newline at end of file
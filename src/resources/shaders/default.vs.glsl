@@ -12,14 +12,23 @@ layout(push_constant) uniform Info {
 
 layout(location = 0) in vec2 posIn;
 layout(location = 1) in vec2 uvIn;
+layout(location = 2) in vec4 colourIn;
 
 layout(location = 0) out vec2 uvOut;
 layout(location = 1) out vec3 normalOut;
+layout(location = 2) out vec4 colourOut;
 
 void main() {
     uvOut = (info.textureTransform * vec3(uvIn, 1.0)).xy;
+    //--Per draw tint from the render queue on top of the colour baked into the vertex--//
+    colourOut = info.colourMult * colourIn;
 
-    mat4 mv = info.v * info.m;
-    normalOut = mat3(mv) * vec3(0.0, 0.0, 1.0);
-    gl_Position = info.p * mv * vec4(posIn, 0.0, 1.0);
+    //--Quads stay on z = 0, the model's z translation is the draw's depth buffer value--//
+    vec4 world = info.m * vec4(posIn, 0.0, 1.0);
+    float depth = world.z;
+    world.z = 0.0;
+
+    normalOut = mat3(info.v * info.m) * vec3(0.0, 0.0, 1.0);
+    gl_Position = info.p * info.v * world;
+    gl_Position.z = depth * gl_Position.w;
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+#version 450
+#pragma shader_stage(vertex)
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform Info {
+    mat4 p;
+    mat4 v;
+    mat4 m;
+    mat3 textureTransform;
+    mat4 colourMult;
+} info;
+
+layout(location = 0) in vec4 rectIn;
+layout(location = 1) in vec4 uvIn;
+layout(location = 2) in vec4 colourIn;
+
+layout(location = 0) out vec2 uvOut;
+layout(location = 1) out vec3 normalOut;
+layout(location = 2) out vec4 colourOut;
+
+const vec2 corners[6] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+void main() {
+    vec2 corner = corners[gl_VertexIndex];
+    uvOut = uvIn.xy + corner * uvIn.zw;
+    colourOut = colourIn;
+
+    normalOut = mat3(info.v) * vec3(0.0, 0.0, 1.0);
+    gl_Position = info.p * info.v * vec4(rectIn.xy + corner * rectIn.zw, 0.0, 1.0);
+}
\ No newline at end of file
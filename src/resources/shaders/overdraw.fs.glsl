@@ -0,0 +1,10 @@
+#version 450
+#pragma shader_stage(fragment)
+#extension GL_ARB_separate_shader_objects : enable
+
+//--Overdraw mode swaps this in for every pipeline's fragment shader, each fragment adds one step to an 8 bit target--//
+layout(location = 0) out vec4 outColour;
+
+void main() {
+    outColour = vec4(1.0 / 255.0);
+}
\ No newline at end of file
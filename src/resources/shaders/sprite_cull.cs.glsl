@@ -0,0 +1,46 @@
+#version 450
+#pragma shader_stage(compute)
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(local_size_x = 64) in;
+
+struct Sprite {
+    vec4 rect;
+    vec4 uv;
+    float layer;
+    uint colour;
+    uint visible;
+    float pad;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    Sprite instances[];
+};
+layout(std430, set = 0, binding = 1) writeonly buffer Survivors {
+    Sprite survivors[];
+};
+layout(std430, set = 0, binding = 2) buffer Indirect {
+    uint vertexCount;
+    uint instanceCount;
+    uint firstVertex;
+    uint firstInstance;
+} draw;
+
+layout(push_constant) uniform Cull {
+    vec4 view;
+    uint count;
+} cull;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= cull.count) {
+        return;
+    }
+    Sprite s = instances[i];
+    if (s.visible == 0u ||
+        s.rect.x > cull.view.z || s.rect.x + s.rect.z < cull.view.x ||
+        s.rect.y > cull.view.w || s.rect.y + s.rect.w < cull.view.y) {
+        return;
+    }
+    survivors[atomicAdd(draw.instanceCount, 1u)] = s;
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "job/job_system.hpp"
+
+namespace {
+    uint32_t failures = 0;
+
+    void check(bool condition, const char* test, const char* message) {
+        if (!condition) {
+            printf("%s: %s\n", test, message);
+            failures++;
+        }
+    }
+
+    //--Spins without executing jobs, so anything that completes must have been run by another thread--//
+    bool wait_without_helping(job::job_system::counter& c) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!c.done()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        //--Same as wait, the finishing worker may still hold the lock--//
+        std::lock_guard<std::mutex> guard(c.lock);
+        return true;
+    }
+
+    void test_counter() {
+        job::job_system::counter c;
+        std::atomic<uint32_t> ran{0};
+        for (uint32_t i = 0; i < 1000; i++) {
+            job::job_system::run([&ran] { ran.fetch_add(1); }, &c);
+        }
+        job::job_system::wait(&c);
+        check(c.done(), "counter", "wait returned before the counter reached zero");
+        check(ran.load() == 1000, "counter", "not every job ran");
+    }
+
+    void test_continuations() {
+        //--Each stage may only start once every job of the previous stage has finished--//
+        const uint32_t stages = 8;
+        const uint32_t width = 64;
+        std::vector<job::job_system::counter> counters(stages);
+        std::vector<std::atomic<uint32_t>> finished(stages);
+        std::atomic<bool> ordered{true};
+        for (uint32_t stage = 0; stage < stages; stage++) {
+            for (uint32_t i = 0; i < width; i++) {
+                auto fn = [&, stage] {
+                    if (stage > 0 && finished[stage - 1].load() != width) {
+                        ordered = false;
+                    }
+                    finished[stage].fetch_add(1);
+                };
+                if (stage == 0) {
+                    job::job_system::run(fn, &counters[stage]);
+                }
+                else {
+                    job::job_system::run_after(&counters[stage - 1], fn, &counters[stage]);
+                }
+            }
+        }
+        job::job_system::wait(&counters[stages - 1]);
+        check(ordered.load(), "continuations", "a continuation ran before its dependency finished");
+        check(finished[stages - 1].load() == width, "continuations", "the last stage did not finish");
+
+        //--A dependency that is already done releases the job straight away--//
+        job::job_system::counter done;
+        job::job_system::counter signal;
+        bool ran = false;
+        job::job_system::run_after(&done, [&ran] { ran = true; }, &signal);
+        job::job_system::wait(&signal);
+        check(ran, "continuations", "a job depending on a finished counter never ran");
+    }
+
+    void test_parallel_for(uint32_t count, uint32_t grain) {
+        std::vector<std::atomic<uint32_t>> visits(count);
+        std::atomic<uint32_t> calls{0};
+        std::atomic<bool> aligned{true};
+        job::job_system::parallel_for(count, grain, [&](uint32_t begin, uint32_t end) {
+            calls.fetch_add(1);
+            if (grain != 0 && grain < count && (begin % grain != 0 || end - begin > grain || (end != count && end - begin != grain))) {
+                aligned = false;
+            }
+            for (uint32_t i = begin; i < end; i++) {
+                visits[i].fetch_add(1);
+            }
+        });
+        bool once = std::all_of(visits.begin(), visits.end(), [](const std::atomic<uint32_t>& v) { return v.load() == 1; });
+        check(once, "parallel_for", "an index was not visited exactly once");
+        check(aligned.load(), "parallel_for", "a range did not follow the grain");
+        if (grain >= count) {
+            check(calls.load() == (count > 0 ? 1u : 0u), "parallel_for", "a grain covering the whole range should run inline once");
+        }
+        else if (grain != 0) {
+            check(calls.load() == (count + grain - 1) / grain, "parallel_for", "the range was not split into count / grain pieces");
+        }
+    }
+
+    void test_stealing() {
+        //--The main thread only queues to its own deque, so every job here has to be stolen by a worker--//
+        job::job_system::counter c;
+        std::atomic<uint32_t> on_main{0};
+        for (uint32_t i = 0; i < 256; i++) {
+            job::job_system::run([&on_main] {
+                if (job::job_system::is_main_thread()) {
+                    on_main.fetch_add(1);
+                }
+            }, &c);
+        }
+        check(wait_without_helping(c), "stealing", "workers did not steal jobs from the main thread's deque");
+        check(on_main.load() == 0, "stealing", "a job ran on the main thread while it was not helping");
+    }
+
+    void test_run_on_main() {
+        job::job_system::counter c;
+        std::atomic<bool> worker_ran{false};
+        std::atomic<bool> main_ran{false};
+        std::atomic<bool> affine{true};
+        job::job_system::run([&] {
+            worker_ran = true;
+            job::job_system::run_on_main([&] {
+                main_ran = true;
+                if (!job::job_system::is_main_thread()) {
+                    affine = false;
+                }
+            }, &c);
+        }, &c);
+        //--The outer job holds the counter open until it has queued the main thread job--//
+        job::job_system::wait(&c);
+        check(worker_ran.load() && main_ran.load(), "run_on_main", "a job did not run");
+        check(affine.load(), "run_on_main", "a main thread job ran on a worker");
+
+        //--Workers never pick main thread jobs up, they wait for process_main_jobs--//
+        job::job_system::counter later;
+        bool ran = false;
+        job::job_system::run_on_main([&ran] { ran = true; }, &later);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        check(!ran && !later.done(), "run_on_main", "a main thread job ran before the main thread asked for it");
+        job::job_system::process_main_jobs();
+        check(ran && later.done(), "run_on_main", "process_main_jobs did not run the queued job");
+    }
+
+    //--Tools use the helpers without starting the scheduler, everything has to run inline on the caller--//
+    void test_uninitialised() {
+        job::job_system::counter first;
+        job::job_system::counter c;
+        uint32_t ran = 0;
+        job::job_system::run([&ran] { ran++; }, &first);
+        job::job_system::run_after(&first, [&ran] { ran++; }, &c);
+        job::job_system::run_on_main([&ran] { ran++; }, &c);
+        check(ran == 3 && first.done() && c.done(), "uninitialised", "jobs did not run inline before init");
+        job::job_system::wait(&c);
+        job::job_system::process_main_jobs();
+        uint32_t covered = 0;
+        job::job_system::parallel_for(100, 10, [&covered](uint32_t begin, uint32_t end) { covered += end - begin; });
+        check(covered == 100, "uninitialised", "parallel_for did not cover the range before init");
+    }
+
+    void run_all(uint32_t workers) {
+        job::job_system::init(workers);
+        check(job::job_system::get_worker_count() == workers, "init", "wrong worker count");
+        check(job::job_system::is_main_thread(), "init", "the initialising thread should be the main thread");
+        test_counter();
+        test_continuations();
+        for (uint32_t grain : {0u, 1u, 7u, 64u, 1000u, 5000u}) {
+            test_parallel_for(1000, grain);
+        }
+        test_parallel_for(0, 16);
+        test_parallel_for(1, 0);
+        test_run_on_main();
+        if (workers > 0) {
+            test_stealing();
+        }
+        job::job_system::terminate();
+    }
+}
+
+//--One worker makes every steal contend with the owner, several make the workers steal from each other--//
+int main() {
+    test_uninitialised();
+    run_all(1);
+    run_all(3);
+    if (failures > 0) {
+        printf("%u job system checks failed\n", failures);
+        return 1;
+    }
+    printf("All job system checks passed\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "render/sprite_grid.hpp"
+
+namespace {
+    uint32_t failures = 0;
+
+    void check(bool condition, const char* test, const char* message) {
+        if (!condition) {
+            printf("%s: %s\n", test, message);
+            failures++;
+        }
+    }
+
+    //--Same seed every run so a failure reproduces--//
+    uint32_t seed = 0x9E3779B9;
+    float random(float min, float max) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return min + (max - min) * (float)(seed >> 8) * (1.0f / 16777216.0f);
+    }
+
+    render::bounds square(float x, float y, float size) {
+        return {x, y, x + size, y + size};
+    }
+
+    //--Fills a -1 to 1 world, the scale the engine draws at with the default view--//
+    std::vector<render::bounds> fill(render::sprite_grid& grid, uint32_t count) {
+        seed = 0x9E3779B9;
+        std::vector<render::bounds> sprites(count);
+        for (uint32_t i = 0; i < count; i++) {
+            sprites[i] = square(random(-1.0f, 0.98f), random(-1.0f, 0.98f), 0.02f);
+            grid.insert(i, sprites[i]);
+        }
+        return sprites;
+    }
+
+    uint32_t linear_count(const std::vector<render::bounds>& sprites, const render::bounds& area) {
+        return (uint32_t)std::count_if(sprites.begin(), sprites.end(), [&area](const render::bounds& b) { return b.overlaps(area); });
+    }
+
+    void test_query_visits_few_cells() {
+        const uint32_t count = 4000;
+        render::sprite_grid grid(0.25f);
+        std::vector<render::bounds> sprites = fill(grid, count);
+        render::bounds view = {-0.2f, -0.2f, 0.2f, 0.2f};
+        std::vector<uint32_t> out;
+        grid.query(view, out);
+        render::sprite_grid::query_stats stats = grid.get_last_query();
+        check(out.size() == linear_count(sprites, view), "query", "the grid and a linear scan disagree");
+        //--The view spans cells -1 to 0 on each axis--//
+        check(stats.cells == 4, "query", "the view should only walk the four cells it overlaps");
+        //--Four of the 64 cells hold about a sixteenth of the sprites, allow for ones straddling a border--//
+        check(stats.candidates < count / 8, "query", "too many candidates were tested for a small view");
+        check(stats.candidates >= out.size(), "query", "fewer candidates than results");
+
+        //--Cells far larger than the world put everything in the few cells round the origin, which the cell size must avoid--//
+        render::sprite_grid coarse(256.0f);
+        fill(coarse, count);
+        out.clear();
+        coarse.query(view, out);
+        check(coarse.get_last_query().candidates >= count, "query", "cells larger than the world should hand every sprite to the query");
+    }
+
+    void test_huge_query() {
+        render::sprite_grid grid(0.25f);
+        std::vector<render::bounds> sprites = fill(grid, 500);
+        //--Clamps to the full cell range, the span has to be computed without overflowing--//
+        render::bounds everything = {-1e30f, -1e30f, 1e30f, 1e30f};
+        std::vector<uint32_t> out;
+        grid.query(everything, out);
+        check(out.size() == sprites.size(), "huge query", "not every sprite was returned");
+        check(grid.get_last_query().cells == grid.get_cell_count(), "huge query", "every stored cell should be walked once");
+    }
+
+    void test_empty_cells_released() {
+        render::sprite_grid grid(1.0f);
+        grid.insert(0, square(0.25f, 0.25f, 0.5f));
+        check(grid.get_cell_count() == 1, "cells", "one small item should occupy one cell");
+        //--Scrolls the item across a thousand cells, only the current one may be kept--//
+        for (int32_t x = 1; x <= 1000; x++) {
+            grid.update(0, square((float)x + 0.25f, 0.25f, 0.5f));
+        }
+        check(grid.get_cell_count() == 1, "cells", "cells left empty by a moving item were kept");
+        grid.remove(0);
+        check(grid.get_cell_count() == 0, "cells", "removing the last item left a cell behind");
+    }
+
+    void test_set_bounds() {
+        render::sprite_grid grid(1.0f);
+        grid.insert(3, square(0.1f, 0.1f, 0.2f));
+        check(!grid.set_bounds(3, square(0.5f, 0.5f, 0.2f)), "set_bounds", "moving inside a cell should not need a relink");
+        std::vector<uint32_t> out;
+        grid.query(square(0.6f, 0.6f, 0.05f), out);
+        check(out.size() == 1 && out[0] == 3, "set_bounds", "queries should see the new bounds straight away");
+        check(grid.set_bounds(3, square(2.5f, 0.5f, 0.2f)), "set_bounds", "leaving the cell should ask for a relink");
+        grid.update(3, grid.get_bounds(3));
+        out.clear();
+        grid.query(square(2.4f, 0.4f, 0.5f), out);
+        check(out.size() == 1 && grid.get_last_query().cells == 1, "set_bounds", "the item was not relinked into its new cell");
+    }
+}
+
+int main() {
+    test_query_visits_few_cells();
+    test_huge_query();
+    test_empty_cells_released();
+    test_set_bounds();
+    if (failures > 0) {
+        printf("%u sprite grid checks failed\n", failures);
+        return 1;
+    }
+    printf("All sprite grid checks passed\n");
+    return 0;
+}
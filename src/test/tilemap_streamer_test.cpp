@@ -0,0 +1,121 @@
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "job/job_system.hpp"
+#include "render/tilemap.hpp"
+#include "render/tilemap_streamer.hpp"
+#include "resource/region_file.hpp"
+#include "resource/resource_manager.hpp"
+
+namespace {
+    uint32_t failures = 0;
+
+    void check(bool condition, const char* test, const char* message) {
+        if (!condition) {
+            printf("%s: %s\n", test, message);
+            failures++;
+        }
+    }
+
+    const float EXTENT = (float)render::tilemap::CHUNK_SIZE;
+
+    //--Every chunk of the four regions round the origin is filled, so no chunk the camera visits is a hole--//
+    //--Written to the working directory, ctest runs each test in the build folder--//
+    bool write_regions() {
+        resource::region_file::chunk c;
+        c.palette = {0, resource::hash_name("grass")};
+        c.tiles.assign(render::tilemap::CHUNK_SIZE * render::tilemap::CHUNK_SIZE, 1);
+        std::vector<uint8_t> encoded = resource::region_file::encode_chunk(c);
+        std::vector<std::vector<uint8_t>> chunks(resource::region_file::REGION_SIZE * resource::region_file::REGION_SIZE, encoded);
+        std::vector<uint8_t> region = resource::region_file::encode_region(render::tilemap::CHUNK_SIZE, chunks);
+        for (int32_t ry = -1; ry <= 0; ry++) {
+            for (int32_t rx = -1; rx <= 0; rx++) {
+                if (!resource::resource_manager::write_binary_file(resource::region_file::get_file_name(rx, ry), {}, region)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    vml::vec2 centre_of(int32_t cx, int32_t cy) {
+        return vml::vec2(((float)cx + 0.5f) * EXTENT, ((float)cy + 0.5f) * EXTENT);
+    }
+
+    //--Lets every load in flight land, as if enough frames went by for the workers to catch up--//
+    bool drain(render::tilemap_streamer& streamer) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (streamer.get_stats().loading > 0) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            job::job_system::process_main_jobs();
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    void test_misses() {
+        render::tilemap map(1.0f, 0, 0);
+        render::tilemap_streamer streamer(map, {});
+        render::tilemap_streamer::settings s;
+        s.radius = 1;
+        //--Looks three chunks ahead at the speed used below--//
+        s.prefetch_time = 1.0f;
+        s.max_in_flight = 64;
+        streamer.set_settings(s);
+        vml::vec2 still(0.0f, 0.0f);
+        vml::vec2 moving(EXTENT * 3.0f, 0.0f);
+
+        //--Nothing is loaded for the first frame, all nine chunks round the camera are missing--//
+        streamer.update(centre_of(0, 0), moving);
+        check(streamer.get_stats().misses == 9, "misses", "the first frame should miss the nine chunks round the camera");
+        check(drain(streamer), "misses", "loads did not finish");
+        streamer.update(centre_of(0, 0), moving);
+        check(streamer.get_stats().misses == 9, "misses", "chunks that arrived before the frame was drawn counted as misses");
+        check(map.has_chunk(0, 0) && map.has_chunk(3, 0), "misses", "the camera and prefetched chunks were not handed to the tilemap");
+
+        //--Moving along the velocity finds every chunk already prefetched--//
+        for (int32_t cx = 1; cx <= 3; cx++) {
+            check(drain(streamer), "misses", "loads did not finish");
+            streamer.update(centre_of(cx, 0), moving);
+        }
+        check(streamer.get_stats().misses == 9, "misses", "prefetched chunks counted as misses");
+
+        //--A jump nothing predicted misses once per frame until the loads land--//
+        streamer.update(centre_of(10, 10), still);
+        check(streamer.get_stats().misses == 18, "misses", "the jump should miss the nine chunks round the camera");
+        streamer.update(centre_of(10, 10), still);
+        check(streamer.get_stats().misses == 27, "misses", "a chunk still loading on the next frame should miss again");
+        check(drain(streamer), "misses", "loads did not finish");
+        streamer.update(centre_of(10, 10), still);
+        check(streamer.get_stats().misses == 27, "misses", "resident chunks counted as misses");
+        check(streamer.get_stats().resident == streamer.get_stats().loaded, "misses", "nothing should have been evicted under the default budget");
+    }
+}
+
+int main() {
+    resource::resource_manager::init("", '/');
+    job::job_system::init(1);
+    if (!write_regions()) {
+        printf("Could not write region files to the working directory\n");
+        failures++;
+    }
+    else {
+        test_misses();
+    }
+    job::job_system::terminate();
+    for (int32_t ry = -1; ry <= 0; ry++) {
+        for (int32_t rx = -1; rx <= 0; rx++) {
+            std::remove(resource::region_file::get_file_name(rx, ry).c_str());
+        }
+    }
+    if (failures > 0) {
+        printf("%u tilemap streamer checks failed\n", failures);
+        return 1;
+    }
+    printf("All tilemap streamer checks passed\n");
+    return 0;
+}
@@ -1,33 +1,103 @@
 #ifndef TEXTUREPACKAGER_ATLAS_H
 #define TEXTUREPACKAGER_ATLAS_H
 
+#include <limits>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "PngWriter.h"
+
+static const uint32_t NO_ALIAS = std::numeric_limits<uint32_t>::max();
+
 struct Image {
     std::string name;
     std::string file;
+    //--Size of the opaque bounds that get packed, which sit at trimX, trimY inside the srcW x srcH file--//
     uint32_t w, h;
     uint32_t x, y;
     uint32_t layer = std::numeric_limits<uint32_t>::max();
+    std::unique_ptr<uint8_t[]> pixels;
+    uint64_t hash = 0;
+    bool changed = true;
+    uint32_t srcW = 0, srcH = 0;
+    uint32_t trimX = 0, trimY = 0;
+    uint64_t pixelHash = 0;
+    //--Duplicates share the placement of the image at this index instead of being packed--//
+    uint32_t alias = NO_ALIAS;
 };
 
 class Atlas {
 public:
     Atlas(const std::string& base, const std::string& out);
 
+    void setMemoryCap(size_t bytes);
+    void setIncremental(bool enabled);
+    void setMaxExtraLayers(uint32_t layers);
+    void setMipLevels(uint32_t levels);
+    void setFormat(uint32_t format, uint32_t quality);
+    void setPngOptions(const PngWriter::Options& options);
+    void setPagesInFlight(uint32_t pages);
+    //--Restricts packing to the engine with this name, empty tries every engine--//
+    void setEngine(const std::string& name);
+    void setLogPlacements(bool enabled);
+
     void addTexture(const std::string& name, const std::string& file);
+    void addRectangle(const std::string& name, uint32_t w, uint32_t h);
     bool loadInfo();
     bool packRectangles(uint32_t w, uint32_t h);
+    const std::string& getPackName() const;
+    uint32_t getLayerCount() const;
+    //--Packed image area over the area of every layer--//
+    double getOccupancy() const;
+    //--Whole layers hide the difference between engines, how much of the final page they need doesn't--//
+    double getLastLayerFill() const;
+    //--Bounding box of the images on the final page over the page area, and its height in pixels--//
+    double getLastLayerBounds() const;
+    uint32_t getLastLayerHeight() const;
     bool build();
     bool writeData();
+    bool writeCache();
+    void compareLoadTimes();
 private:
+    struct CacheEntry {
+        uint64_t hash;
+        uint32_t w, h;
+        uint32_t x, y;
+        uint32_t layer;
+        uint32_t srcW, srcH;
+        uint32_t trimX, trimY;
+        uint64_t pixelHash;
+    };
+    bool loadCache();
+    void aliasDuplicates();
+
     int stage = 0;
     std::string baseDir;
     std::string outBase;
     std::vector<Image> images;
     uint32_t layerCount = 0;
     uint32_t  width = 0, height = 0;
+    size_t memoryCap = (size_t)1 << 30;
+    uint32_t mipLevels = 0;
+    uint32_t format = 0;
+    uint32_t quality = 2;
+    PngWriter::Options pngOptions;
+    uint32_t pagesInFlight = 2;
+    std::string engine;
+    bool logPlacements = true;
+    bool rectanglesOnly = false;
+    std::string packName;
+    uint64_t usedArea = 0;
+    uint64_t lastLayerArea = 0;
+    uint32_t lastLayerW = 0, lastLayerH = 0;
+
+    bool incremental = true;
+    uint32_t maxExtraLayers = 0;
+    std::unordered_map<std::string, CacheEntry> cache;
+    uint32_t cacheWidth = 0, cacheHeight = 0, cacheLayerCount = 0;
+    std::vector<bool> dirtyLayers;
 };
 
 #endif//TEXTUREPACKAGER_ATLAS_H
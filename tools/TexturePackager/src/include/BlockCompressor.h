@@ -0,0 +1,30 @@
+#ifndef TEXTUREPACKAGER_BLOCKCOMPRESSOR_H
+#define TEXTUREPACKAGER_BLOCKCOMPRESSOR_H
+
+#include <cstdint>
+#include <string>
+
+enum TextureFormat {
+    FORMAT_RGBA8 = 0,
+    //--Opaque or one bit alpha, 8 bytes per 4x4 block--//
+    FORMAT_BC1 = 1,
+    //--Interpolated alpha, 16 bytes per 4x4 block--//
+    FORMAT_BC3 = 2
+};
+
+static const uint32_t MAX_COMPRESSION_QUALITY = 3;
+
+bool parseFormat(const std::string& name, uint32_t& format);
+const char* formatName(uint32_t format);
+
+//--Bytes needed for a w x h level, block formats round up to whole blocks--//
+uint64_t levelSize(uint32_t format, uint32_t w, uint32_t h);
+
+//--Quality 0 fits endpoints to the bounding box, 1 uses the principal axis and each level above adds a least squares refinement--//
+void compress(const uint8_t* rgba, uint32_t w, uint32_t h, uint32_t format, uint32_t quality, uint8_t* out);
+void decompress(const uint8_t* blocks, uint32_t w, uint32_t h, uint32_t format, uint8_t* rgba);
+
+//--Compares premultiplied colour and alpha, so colour hidden under zero alpha doesn't count as error--//
+double psnr(const uint8_t* a, const uint8_t* b, uint32_t w, uint32_t h);
+
+#endif//TEXTUREPACKAGER_BLOCKCOMPRESSOR_H
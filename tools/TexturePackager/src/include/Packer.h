@@ -0,0 +1,97 @@
+#ifndef TEXTUREPACKAGER_PACKER_H
+#define TEXTUREPACKAGER_PACKER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <pack/guillotine_packer.hpp>
+
+struct PackRect {
+    uint32_t x, y, w, h;
+};
+
+//--Packs rectangles into a single page, Atlas keeps one instance per layer--//
+class Packer {
+public:
+    virtual ~Packer() = default;
+
+    virtual std::string name() const = 0;
+    virtual std::unique_ptr<Packer> create() const = 0;
+
+    virtual void reset(uint32_t w, uint32_t h) = 0;
+    virtual bool insert(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y) = 0;
+};
+
+//--Guillotine splits from the engine's pack library, the same packer runtime atlases use--//
+class TreePacker : public Packer {
+public:
+    std::string name() const override;
+    std::unique_ptr<Packer> create() const override;
+
+    void reset(uint32_t w, uint32_t h) override;
+    bool insert(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y) override;
+
+private:
+    pack::guillotine_packer packer;
+};
+
+class MaxRectsPacker : public Packer {
+public:
+    enum Heuristic {
+        BEST_SHORT_SIDE_FIT,
+        BEST_LONG_SIDE_FIT,
+        BEST_AREA_FIT,
+        BOTTOM_LEFT,
+        CONTACT_POINT
+    };
+    explicit MaxRectsPacker(Heuristic heuristic);
+
+    std::string name() const override;
+    std::unique_ptr<Packer> create() const override;
+
+    void reset(uint32_t w, uint32_t h) override;
+    bool insert(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y) override;
+    //--Marks a rectangle as used without searching, for placements kept from an earlier pack--//
+    void occupy(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+
+private:
+    bool findPosition(uint32_t w, uint32_t h, PackRect& out) const;
+    uint64_t contactScore(uint32_t x, uint32_t y, uint32_t w, uint32_t h) const;
+    void place(const PackRect& rect);
+
+    Heuristic heuristic;
+    uint32_t width = 0, height = 0;
+    std::vector<PackRect> freeRects;
+    std::vector<PackRect> usedRects;
+};
+
+class SkylinePacker : public Packer {
+public:
+    enum Heuristic {
+        BOTTOM_LEFT,
+        MIN_WASTE
+    };
+    explicit SkylinePacker(Heuristic heuristic);
+
+    std::string name() const override;
+    std::unique_ptr<Packer> create() const override;
+
+    void reset(uint32_t w, uint32_t h) override;
+    bool insert(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y) override;
+
+private:
+    struct Segment {
+        uint32_t x, y, w;
+    };
+    bool fits(size_t index, uint32_t w, uint32_t h, uint32_t& y, uint64_t& waste) const;
+
+    Heuristic heuristic;
+    uint32_t width = 0, height = 0;
+    std::vector<Segment> skyline;
+};
+
+//--Every engine and heuristic combination Atlas tries when packing--//
+std::vector<std::unique_ptr<Packer>> createPackers();
+
+#endif//TEXTUREPACKAGER_PACKER_H
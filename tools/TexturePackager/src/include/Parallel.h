@@ -0,0 +1,11 @@
+#ifndef TEXTUREPACKAGER_PARALLEL_H
+#define TEXTUREPACKAGER_PARALLEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+uint32_t threadCount();
+void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+#endif//TEXTUREPACKAGER_PARALLEL_H
@@ -1,6 +1,7 @@
 #ifndef TEXTUREPACKAGER_PNGREADER_H
 #define TEXTUREPACKAGER_PNGREADER_H
 
+#include <limits>
 #include <string>
 #include <png.h>
 
@@ -12,11 +13,11 @@ public:
     uint32_t getHeight();
 
     uint8_t* getData();
+    //--Decodes the w x h region at srcX, srcY as RGBA rows spaced stride bytes apart starting at dest--//
+    bool readInto(uint8_t* dest, size_t stride, uint32_t srcX, uint32_t srcY, uint32_t w, uint32_t h);
 
     void close();
 
-    static bool writeFile(const std::string& file, uint32_t w, uint32_t h, uint8_t* data);
-
 private:
     FILE* fp = nullptr;
     png_structp png_ptr = nullptr;
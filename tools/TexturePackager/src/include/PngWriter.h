@@ -0,0 +1,38 @@
+#ifndef TEXTUREPACKAGER_PNGWRITER_H
+#define TEXTUREPACKAGER_PNGWRITER_H
+
+#include <cstdint>
+#include <string>
+
+class PngWriter {
+public:
+    enum Filter {
+        FILTER_NONE,
+        FILTER_SUB,
+        FILTER_UP,
+        FILTER_AVERAGE,
+        FILTER_PAETH,
+        //--Picks the filter per row with the smallest sum of absolute differences, as libpng does--//
+        FILTER_ADAPTIVE
+    };
+    enum Strategy {
+        STRATEGY_DEFAULT,
+        STRATEGY_FILTERED,
+        STRATEGY_RLE,
+        STRATEGY_HUFFMAN
+    };
+    struct Options {
+        //--zlib level, 0 stores the rows uncompressed--//
+        int level = 6;
+        Filter filter = FILTER_ADAPTIVE;
+        Strategy strategy = STRATEGY_DEFAULT;
+    };
+
+    static bool parseFilter(const std::string& name, Filter& filter);
+    static bool parseStrategy(const std::string& name, Strategy& strategy);
+
+    //--Rows are filtered and deflated in strips on every thread, then stitched into a single zlib stream--//
+    static bool writeFile(const std::string& file, uint32_t w, uint32_t h, const uint8_t* data, const Options& options, size_t& bytesWritten);
+};
+
+#endif//TEXTUREPACKAGER_PNGWRITER_H
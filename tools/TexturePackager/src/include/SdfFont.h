@@ -0,0 +1,46 @@
+#ifndef TEXTUREPACKAGER_SDFFONT_H
+#define TEXTUREPACKAGER_SDFFONT_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+//--Slices a bitmap font sheet laid out as a grid of equal cells into signed distance field glyph images--//
+//--Glyphs are written as PNGs and packed like any other image, so the incremental cache and trimming apply to them--//
+class SdfFont {
+public:
+    static const uint32_t MAGIC = 0x41544631;
+
+    struct Options {
+        uint32_t columns = 16, rows = 6;
+        uint32_t firstChar = 32;
+        //--Distance in output texels that spans the whole alpha range, and the space left around each glyph for it--//
+        uint32_t spread = 4;
+        //--Distances are measured on the sheet and sampled every downscale texels, large sheets give sharper fields--//
+        uint32_t downscale = 1;
+        bool monospace = false;
+    };
+
+    static bool parseGrid(const std::string& text, uint32_t& columns, uint32_t& rows);
+
+    //--Writes <folder><codepoint>.png for every glyph with ink, glyphs gets the atlas name and file of each--//
+    bool bake(const std::string& name, const std::string& sheet, const std::string& folder, const Options& options,
+              std::vector<std::pair<std::string, std::string>>& glyphs);
+    //--Advances and bearings for the runtime text layout, in output texels--//
+    bool writeMetrics(const std::string& file) const;
+
+private:
+    struct Glyph {
+        uint32_t codepoint;
+        int32_t left;
+        uint32_t advance;
+        bool hasImage;
+    };
+
+    Options options;
+    uint32_t cellW = 0, cellH = 0;
+    std::vector<Glyph> glyphs;
+};
+
+#endif//TEXTUREPACKAGER_SDFFONT_H
@@ -0,0 +1,52 @@
+#ifndef TEXTUREPACKAGER_TEXTUREFILE_H
+#define TEXTUREPACKAGER_TEXTUREFILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//--GPU ready texture array, a header followed by every layer's mip chain stored as raw texels or compressed blocks--//
+//--Layers are stored one after another so a rebuild can overwrite single layers in place--//
+class TextureFile {
+public:
+    static const uint32_t MAGIC = 0x41545831;
+    static const uint32_t VERSION = 1;
+    struct Level {
+        uint32_t w, h;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    ~TextureFile();
+
+    static uint32_t fullLevelCount(uint32_t w, uint32_t h);
+
+    //--Keeps an existing file when its layout matches so only rewritten layers change, reused reports which happened--//
+    bool open(const std::string& file, uint32_t w, uint32_t h, uint32_t layers, uint32_t levels, uint32_t format, bool& reused);
+    void setQuality(uint32_t quality);
+    //--Takes the full size layer and writes it with the rest of its chain, mips are generated in parallel--//
+    bool writeLayer(uint32_t layer, const uint8_t* data);
+    bool close();
+
+    uint64_t getFileSize() const;
+    //--Signal to noise of the last written layer's top level against its source, infinite for RGBA8--//
+    double getLastPsnr() const;
+
+private:
+    bool writeHeader();
+
+    FILE* fp = nullptr;
+    uint32_t width = 0, height = 0;
+    uint32_t layerCount = 0;
+    uint32_t format = 0;
+    uint32_t quality = 2;
+    double lastPsnr = 0.0;
+    std::vector<Level> levels;
+    uint64_t layerStride = 0;
+};
+
+//--Alpha weighted 2x2 box filter so transparent texels don't darken the edges of sprites--//
+void downsample(const uint8_t* src, uint32_t w, uint32_t h, uint8_t* dst);
+
+#endif//TEXTUREPACKAGER_TEXTUREFILE_H
@@ -1,54 +1,265 @@
 #include "Atlas.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <future>
 
+#include "BlockCompressor.h"
+#include "Packer.h"
+#include "Parallel.h"
 #include "PngReader.h"
+#include "PngWriter.h"
+#include "TextureFile.h"
 
-struct Node {
-    Node* right = nullptr;
-    Node* down = nullptr;
-    bool e = true;
-    uint32_t x, y, w, h;
-    Node(uint32_t xIn, uint32_t yIn, uint32_t wIn, uint32_t hIn) {
-        this->x = xIn;
-        this->y = yIn;
-        this->w = wIn;
-        this->h = hIn;
-    }
-    bool empty() { return this->e; }
-    Node* set(uint32_t wIn, uint32_t hIn) {
-        if (this->empty()) {
-            if (!(wIn > this->w || hIn > this->h)) {
-                this->right = new Node(this->x + wIn, this->y, this->w - wIn, hIn);
-                this->down = new Node(this->x, this->y + hIn, this->w, this->h - hIn);
-                this->e = false;
-                this->w = wIn;
-                this->h = hIn;
-                return this;
-            }
-        }
-        else {
-            Node* out = this->right->set(wIn, hIn);
-            return (out != nullptr) ? out : this->down->set(wIn, hIn);
-        }
-        return nullptr;
-    }
-    void destroy() {
-        if (!this->empty()) {
-            this->right->destroy();
-            delete this->right;
-            this->down->destroy();
-            delete this->down;
+static const uint32_t INFO_MAGIC = 0x41545332;
+static const uint32_t CACHE_MAGIC = 0x54504348;
+static const uint32_t CACHE_VERSION = 2;
+
+//--Result of packing every image with one engine and one ordering--//
+struct PackResult {
+    std::string name;
+    bool success = true;
+    std::vector<uint32_t> x, y, layer;
+    std::vector<uint64_t> layerArea;
+    //--Bounding box of the images on the last layer, the same image set always has the same layerArea on one layer--//
+    uint64_t lastBounds = 0;
+};
+
+static void measureLastLayer(const std::vector<Image>& images, PackResult& result) {
+    uint32_t right = 0, bottom = 0;
+    for (size_t i = 0; i < images.size(); i++) {
+        if (!result.layerArea.empty() && result.layer[i] == result.layerArea.size() - 1) {
+            right = std::max(right, result.x[i] + images[i].w);
+            bottom = std::max(bottom, result.y[i] + images[i].h);
         }
     }
-};
+    result.lastBounds = (uint64_t)right * bottom;
+}
+
+//--First layer with room takes the image, a fresh layer is opened when none has any--//
+static bool insertImage(std::vector<std::unique_ptr<Packer>>& layers, const Packer& engine, const std::vector<Image>& images, size_t i, uint32_t w, uint32_t h, PackResult& result) {
+    const Image& img = images[i];
+    uint32_t layer = 0;
+    for (; layer < layers.size(); layer++) {
+        if (layers[layer]->insert(img.w + 1, img.h + 1, result.x[i], result.y[i])) {
+            break;
+        }
+    }
+    if (layer == layers.size()) {
+        layers.push_back(engine.create());
+        layers.back()->reset(w + 1, h + 1);
+        result.layerArea.push_back(0);
+        if (!layers.back()->insert(img.w + 1, img.h + 1, result.x[i], result.y[i])) {
+            return false;
+        }
+    }
+    result.layer[i] = layer;
+    result.layerArea[layer] += (uint64_t)img.w * img.h;
+    return true;
+}
+
+static PackResult packWith(const Packer& engine, const std::vector<Image>& images, const std::vector<size_t>& order, uint32_t w, uint32_t h) {
+    PackResult result;
+    result.x.resize(images.size());
+    result.y.resize(images.size());
+    result.layer.resize(images.size(), std::numeric_limits<uint32_t>::max());
+
+    std::vector<std::unique_ptr<Packer>> layers;
+    for (size_t i : order) {
+        if (!insertImage(layers, engine, images, i, w, h, result)) {
+            result.success = false;
+            return result;
+        }
+    }
+    measureLastLayer(images, result);
+    return result;
+}
+
+//--Unchanged images keep the placement loaded from the cache and the rest are fitted into the space around them--//
+static PackResult packAround(const std::vector<Image>& images, const std::vector<size_t>& order, uint32_t layerCount, uint32_t w, uint32_t h) {
+    MaxRectsPacker engine(MaxRectsPacker::BEST_SHORT_SIDE_FIT);
+    PackResult result;
+    result.name = "incremental " + engine.name();
+    result.x.resize(images.size());
+    result.y.resize(images.size());
+    result.layer.resize(images.size(), std::numeric_limits<uint32_t>::max());
+    result.layerArea.resize(layerCount, 0);
+
+    std::vector<std::unique_ptr<Packer>> layers;
+    std::vector<MaxRectsPacker*> kept;
+    for (uint32_t l = 0; l < layerCount; l++) {
+        kept.push_back(new MaxRectsPacker(MaxRectsPacker::BEST_SHORT_SIDE_FIT));
+        kept.back()->reset(w + 1, h + 1);
+        layers.emplace_back(kept.back());
+    }
+    for (size_t i = 0; i < images.size(); i++) {
+        const Image& img = images[i];
+        if (img.changed || img.alias != NO_ALIAS) {
+            continue;
+        }
+        if (img.layer >= layerCount || img.x + img.w > w || img.y + img.h > h) {
+            result.success = false;
+            return result;
+        }
+        kept[img.layer]->occupy(img.x, img.y, img.w + 1, img.h + 1);
+        result.x[i] = img.x;
+        result.y[i] = img.y;
+        result.layer[i] = img.layer;
+        result.layerArea[img.layer] += (uint64_t)img.w * img.h;
+    }
+
+    for (size_t i : order) {
+        if (!insertImage(layers, engine, images, i, w, h, result)) {
+            result.success = false;
+            return result;
+        }
+    }
+    measureLastLayer(images, result);
+    return result;
+}
+
+//--Fewer layers wins, then the emptiest last layer so spare space is kept together--//
+//--Equal last layers, always the case with a single layer, go to the tighter bounding box on the last layer--//
+static bool betterPack(const PackResult& a, const PackResult& b) {
+    if (a.success != b.success) return a.success;
+    if (a.layerArea.size() != b.layerArea.size()) return a.layerArea.size() < b.layerArea.size();
+    if (a.layerArea.empty()) return false;
+    if (a.layerArea.back() != b.layerArea.back()) return a.layerArea.back() < b.layerArea.back();
+    return a.lastBounds < b.lastBounds;
+}
+
+//--FNV-1a over the file contents, reading a file is far cheaper than decoding it--//
+static bool hashFile(const std::string& file, uint64_t& hash) {
+    FILE* fp = fopen(file.c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+    std::vector<uint8_t> buffer(1 << 16);
+    uint64_t h = 14695981039346656037ULL;
+    size_t read;
+    while ((read = fread(buffer.data(), 1, buffer.size(), fp)) > 0) {
+        for (size_t i = 0; i < read; i++) {
+            h = (h ^ buffer[i]) * 1099511628211ULL;
+        }
+    }
+    fclose(fp);
+    hash = h;
+    return true;
+}
+
+static bool fileExists(const std::string& file) {
+    FILE* fp = fopen(file.c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+    fclose(fp);
+    return true;
+}
+
+//--Cuts the image down to the bounds of its visible texels, a fully transparent image keeps one texel--//
+static void trimImage(Image& image, std::unique_ptr<uint8_t[]>& full) {
+    uint32_t x0 = image.srcW, y0 = image.srcH, x1 = 0, y1 = 0;
+    for (uint32_t y = 0; y < image.srcH; y++) {
+        const uint8_t* row = full.get() + (size_t)y * image.srcW * 4;
+        for (uint32_t x = 0; x < image.srcW; x++) {
+            if (row[x * 4 + 3] != 0) {
+                x0 = std::min(x0, x);
+                x1 = std::max(x1, x + 1);
+                y0 = std::min(y0, y);
+                y1 = std::max(y1, y + 1);
+            }
+        }
+    }
+    if (x0 >= x1) {
+        x0 = y0 = 0;
+        x1 = y1 = 1;
+    }
+    image.trimX = x0;
+    image.trimY = y0;
+    image.w = x1 - x0;
+    image.h = y1 - y0;
+
+    if (image.w != image.srcW || image.h != image.srcH) {
+        std::unique_ptr<uint8_t[]> trimmed(new uint8_t[(size_t)image.w * image.h * 4]);
+        for (uint32_t r = 0; r < image.h; r++) {
+            memcpy(trimmed.get() + (size_t)r * image.w * 4, full.get() + (((size_t)(y0 + r) * image.srcW) + x0) * 4, (size_t)image.w * 4);
+        }
+        full.swap(trimmed);
+    }
+
+    uint64_t h = 14695981039346656037ULL;
+    const uint32_t dims[2] = {image.w, image.h};
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(dims);
+    for (size_t i = 0; i < sizeof(dims); i++) {
+        h = (h ^ bytes[i]) * 1099511628211ULL;
+    }
+    size_t size = (size_t)image.w * image.h * 4;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ full[i]) * 1099511628211ULL;
+    }
+    image.pixelHash = h;
+}
+
+static void write4Byte(FILE* fp, uint32_t d) {
+    static const uint8_t u255 = 255;
+    uint8_t o[4];
+    o[0] = (uint8_t)(d >> 24) & u255;
+    o[1] = (uint8_t)(d >> 16) & u255;
+    o[2] = (uint8_t)(d >> 8) & u255;
+    o[3] = (uint8_t)(d >> 0) & u255;
+    fwrite(o, 1, 4, fp);
+}
+
+static void read4Byte(FILE* fp, uint32_t& d) {
+    static const uint8_t u255 = 255;
+    uint8_t o[4];
+    fread(o, 1, 4, fp);
+    d = ((uint32_t)o[0] & u255) << 24;
+    d += ((uint32_t)o[1] & u255) << 16;
+    d += ((uint32_t)o[2] & u255) << 8;
+    d += ((uint32_t)o[3] & u255) << 0;
+}
 
 Atlas::Atlas(const std::string& base, const std::string& out) {
     this->baseDir = base;
     this->outBase = out;
 }
 
+void Atlas::setMemoryCap(size_t bytes) {
+    this->memoryCap = bytes;
+}
+void Atlas::setIncremental(bool enabled) {
+    this->incremental = enabled;
+}
+void Atlas::setMaxExtraLayers(uint32_t layers) {
+    this->maxExtraLayers = layers;
+}
+void Atlas::setMipLevels(uint32_t levels) {
+    this->mipLevels = levels;
+}
+void Atlas::setFormat(uint32_t format, uint32_t quality) {
+    this->format = format;
+    this->quality = quality;
+}
+
+void Atlas::setPngOptions(const PngWriter::Options& options) {
+    this->pngOptions = options;
+}
+
+void Atlas::setPagesInFlight(uint32_t pages) {
+    this->pagesInFlight = pages;
+}
+
+void Atlas::setEngine(const std::string& name) {
+    this->engine = name;
+}
+
+void Atlas::setLogPlacements(bool enabled) {
+    this->logPlacements = enabled;
+}
+
 void Atlas::addTexture(const std::string& name, const std::string& file) {
     if (this->stage < 2) {
         this->stage = 1;
@@ -56,148 +267,491 @@ void Atlas::addTexture(const std::string& name, const std::string& file) {
     }
 }
 
+//--Skips loading entirely, the atlas can be packed straight away but has no pixels to build--//
+void Atlas::addRectangle(const std::string& name, uint32_t w, uint32_t h) {
+    if (this->stage == 0 || (this->stage == 2 && this->rectanglesOnly)) {
+        this->stage = 2;
+        this->rectanglesOnly = true;
+        this->images.push_back({name, "", w, h, 0, 0});
+        this->images.back().srcW = w;
+        this->images.back().srcH = h;
+    }
+}
+
+bool Atlas::loadCache() {
+    this->cache.clear();
+    FILE* fp = fopen((this->outBase + ".cache").c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+    uint32_t magic = 0, version = 0, count = 0;
+    read4Byte(fp, magic);
+    read4Byte(fp, version);
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+        fclose(fp);
+        return false;
+    }
+    read4Byte(fp, this->cacheWidth);
+    read4Byte(fp, this->cacheHeight);
+    read4Byte(fp, this->cacheLayerCount);
+    read4Byte(fp, count);
+    for (uint32_t i = 0; i < count && !feof(fp); i++) {
+        CacheEntry entry;
+        uint32_t hashHigh, hashLow;
+        read4Byte(fp, hashHigh);
+        read4Byte(fp, hashLow);
+        entry.hash = ((uint64_t)hashHigh << 32) | hashLow;
+        read4Byte(fp, entry.w);
+        read4Byte(fp, entry.h);
+        read4Byte(fp, entry.x);
+        read4Byte(fp, entry.y);
+        read4Byte(fp, entry.layer);
+        read4Byte(fp, entry.srcW);
+        read4Byte(fp, entry.srcH);
+        read4Byte(fp, entry.trimX);
+        read4Byte(fp, entry.trimY);
+        read4Byte(fp, hashHigh);
+        read4Byte(fp, hashLow);
+        entry.pixelHash = ((uint64_t)hashHigh << 32) | hashLow;
+        std::string name;
+        int c;
+        while ((c = fgetc(fp)) != EOF && c != 0) {
+            name += (char)c;
+        }
+        this->cache[name] = entry;
+    }
+    bool complete = !feof(fp);
+    fclose(fp);
+    if (!complete) {
+        this->cache.clear();
+    }
+    return complete;
+}
+
 bool Atlas::loadInfo() {
     if (this->stage == 1) {
-        for (Image& image : this->images) {
+        if (this->incremental && this->loadCache()) {
+            printf("Loaded build cache with %zu entries\n", this->cache.size());
+        }
+
+        //--Images are decoded here while they fit under the memory cap so build doesn't open them again--//
+        std::atomic<size_t> cached(0);
+        std::vector<std::string> errors(this->images.size());
+        parallelFor(this->images.size(), [&](size_t i) {
+            Image& image = this->images[i];
+            if (!hashFile(image.file, image.hash)) {
+                errors[i] = "Could not open file";
+                return;
+            }
+            //--Unchanged images take their size and placement from the cache and are only decoded if their layer is rebuilt--//
+            auto hit = this->cache.find(image.name);
+            if (hit != this->cache.end() && hit->second.hash == image.hash) {
+                image.w = hit->second.w;
+                image.h = hit->second.h;
+                image.x = hit->second.x;
+                image.y = hit->second.y;
+                image.layer = hit->second.layer;
+                image.srcW = hit->second.srcW;
+                image.srcH = hit->second.srcH;
+                image.trimX = hit->second.trimX;
+                image.trimY = hit->second.trimY;
+                image.pixelHash = hit->second.pixelHash;
+                image.changed = false;
+                return;
+            }
             PngReader reader;
             std::string success = reader.init(image.file);
-            reader.close();
             if (!success.empty()) {
-                printf("Failed to load info:\n    %s - %s\n", image.name.c_str(), success.c_str());
-                return false;
+                reader.close();
+                errors[i] = success;
+                return;
+            }
+            image.srcW = reader.getWidth();
+            image.srcH = reader.getHeight();
+            //--Changed images are always decoded to find their bounds, only the trimmed texels are kept--//
+            std::unique_ptr<uint8_t[]> full(reader.getData());
+            reader.close();
+            if (!full) {
+                errors[i] = "Could not decode image";
+                return;
             }
-            image.w = reader.getWidth();
-            image.h = reader.getHeight();
+            trimImage(image, full);
+            size_t bytes = (size_t)image.w * image.h * 4;
+            if (cached.fetch_add(bytes) + bytes <= this->memoryCap) {
+                image.pixels.swap(full);
+            }
+            else {
+                cached.fetch_sub(bytes);
+            }
+        });
+        bool success = true;
+        for (size_t i = 0; i < this->images.size(); i++) {
+            if (!errors[i].empty()) {
+                printf("Failed to load info:\n    %s - %s\n", this->images[i].name.c_str(), errors[i].c_str());
+                success = false;
+            }
+        }
+        if (!success) {
+            return false;
+        }
+        size_t changed = 0;
+        uint64_t sourceArea = 0, trimmedArea = 0;
+        for (const Image& img : this->images) {
+            changed += img.changed ? 1 : 0;
+            sourceArea += (uint64_t)img.srcW * img.srcH;
+            trimmedArea += (uint64_t)img.w * img.h;
         }
+        printf("%zu of %zu images changed since the last build\n", changed, this->images.size());
+        printf("Trimming transparent borders removed %.1f%% of the source area\n", sourceArea > 0 ? 100.0 * (sourceArea - trimmedArea) / sourceArea : 0.0);
+        this->aliasDuplicates();
+        printf("Decoded %zu MB of %zu images ahead of build\n", cached.load() >> 20, this->images.size());
         this->stage = 2;
         return true;
     }
     return false;
 }
 
+void Atlas::aliasDuplicates() {
+    //--Unchanged images claim their pixels first so a duplicate never moves an existing placement--//
+    std::unordered_map<uint64_t, uint32_t> owners;
+    size_t aliased = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < this->images.size(); i++) {
+            Image& img = this->images[i];
+            if (img.changed != (pass == 1)) {
+                continue;
+            }
+            img.alias = NO_ALIAS;
+            auto owner = owners.find(img.pixelHash);
+            if (owner == owners.end()) {
+                owners[img.pixelHash] = i;
+                continue;
+            }
+            const Image& original = this->images[owner->second];
+            if (original.w == img.w && original.h == img.h) {
+                img.alias = owner->second;
+                img.pixels.reset();
+                aliased++;
+            }
+        }
+    }
+    printf("%zu duplicate images share a placement\n", aliased);
+}
+
 bool Atlas::packRectangles(uint32_t w, uint32_t h) {
     if (this->stage != 2) return false;
 
-    std::sort(this->images.begin(), this->images.end(), [](const Image& i1, const Image& i2) {
-        if (i1.w > i2.w) return true;
-        if (i1.w == i2.w) return i1.h > i2.h;
-        return false;
-    });
-
-    printf("Placing textures:\n");
+    typedef bool (*Order)(const Image&, const Image&);
+    static const std::pair<const char*, Order> orders[] = {
+        {"width", [](const Image& i1, const Image& i2) { return i1.w != i2.w ? i1.w > i2.w : i1.h > i2.h; }},
+        {"height", [](const Image& i1, const Image& i2) { return i1.h != i2.h ? i1.h > i2.h : i1.w > i2.w; }},
+        {"area", [](const Image& i1, const Image& i2) { return (uint64_t)i1.w * i1.h > (uint64_t)i2.w * i2.h; }},
+        {"side", [](const Image& i1, const Image& i2) { return std::max(i1.w, i1.h) > std::max(i2.w, i2.h); }}};
 
-    std::vector<Node*> layers;
-    layers.push_back(new Node(0, 0, w + 1, h + 1));
+    std::vector<std::unique_ptr<Packer>> engines = createPackers();
+    if (!this->engine.empty()) {
+        engines.erase(std::remove_if(engines.begin(), engines.end(), [this](const std::unique_ptr<Packer>& e) {
+            return e->name() != this->engine;
+        }), engines.end());
+        if (engines.empty()) {
+            printf("Unknown packing engine: %s\n", this->engine.c_str());
+            return false;
+        }
+    }
+    size_t orderCount = sizeof(orders) / sizeof(orders[0]);
+    std::vector<PackResult> results(engines.size() * orderCount);
+    parallelFor(results.size(), [&](size_t i) {
+        const Packer& engine = *engines[i / orderCount];
+        const std::pair<const char*, Order>& order = orders[i % orderCount];
+        std::vector<size_t> indices;
+        for (size_t j = 0; j < this->images.size(); j++) {
+            if (this->images[j].alias == NO_ALIAS) {
+                indices.push_back(j);
+            }
+        }
+        std::stable_sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
+            return order.second(this->images[a], this->images[b]);
+        });
+        results[i] = packWith(engine, this->images, indices, w, h);
+        results[i].name = engine.name() + " by " + order.first;
+    });
 
-    bool success = true;
+    size_t best = 0;
+    for (size_t i = 1; i < results.size(); i++) {
+        if (betterPack(results[i], results[best])) {
+            best = i;
+        }
+    }
+    PackResult* chosen = &results[best];
+    this->dirtyLayers.assign(chosen->layerArea.size(), true);
 
-    for (Image& img : this->images) {
-        uint32_t layer = 0;
-        for (Node* l : layers) {
-            Node* actual = l->set(img.w + 1, img.h + 1);
-            if (actual != nullptr) {
-                img.x = actual->x;
-                img.y = actual->y;
-                img.layer = layer;
-                printf("    %s at (%d, %d, %d)\n", img.name.c_str(), img.x, img.y, img.layer);
-                break;
-            }
-            layer++;
-        }
-        if (img.layer == std::numeric_limits<uint32_t>::max()) {
-            Node* nextLayer = new Node(0, 0, w + 1, h + 1);
-            if (nextLayer->set(img.w + 1, img.h + 1) != nullptr) {
-                img.x = nextLayer->x;
-                img.y = nextLayer->y;
-                img.layer = layer;
-                layers.push_back(nextLayer);
-                printf("    %s at (%d, %d, %d)\n", img.name.c_str(), img.x, img.y, img.layer);
-                continue;
+    //--Reusing the previous layout only re-encodes the layers that changed, unless it costs more layers than a fresh pack--//
+    size_t unchanged = 0;
+    for (const Image& img : this->images) {
+        unchanged += img.changed ? 0 : 1;
+    }
+    PackResult around;
+    if (unchanged > 0 && this->cacheWidth == w && this->cacheHeight == h) {
+        std::vector<size_t> indices;
+        for (size_t j = 0; j < this->images.size(); j++) {
+            if (this->images[j].changed && this->images[j].alias == NO_ALIAS) {
+                indices.push_back(j);
+            }
+        }
+        std::stable_sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
+            return orders[2].second(this->images[a], this->images[b]);
+        });
+        around = packAround(this->images, indices, this->cacheLayerCount, w, h);
+        if (around.success && around.layerArea.size() <= chosen->layerArea.size() + this->maxExtraLayers) {
+            chosen = &around;
+            this->dirtyLayers.assign(around.layerArea.size(), false);
+            for (size_t l = this->cacheLayerCount; l < around.layerArea.size(); l++) {
+                this->dirtyLayers[l] = true;
+            }
+            std::unordered_map<std::string, bool> kept;
+            for (size_t i = 0; i < this->images.size(); i++) {
+                kept[this->images[i].name] = !this->images[i].changed;
+                if (this->images[i].changed && this->images[i].alias == NO_ALIAS) {
+                    this->dirtyLayers[around.layer[i]] = true;
+                }
             }
+            //--Layers that lost an image still hold its old pixels--//
+            for (const auto& entry : this->cache) {
+                auto k = kept.find(entry.first);
+                if ((k == kept.end() || !k->second) && entry.second.layer < this->dirtyLayers.size()) {
+                    this->dirtyLayers[entry.second.layer] = true;
+                }
+            }
+        }
+        else if (around.success) {
+            printf("Reusing the cached layout needs %zu layers against %zu for a full pack, repacking everything\n",
+                   around.layerArea.size(), chosen->layerArea.size());
+        }
+    }
+    PackResult& result = *chosen;
+    for (size_t i = 0; i < this->images.size(); i++) {
+        uint32_t alias = this->images[i].alias;
+        if (alias != NO_ALIAS) {
+            result.x[i] = result.x[alias];
+            result.y[i] = result.y[alias];
+            result.layer[i] = result.layer[alias];
+        }
+    }
+
+    if (this->logPlacements) {
+        printf("Placing textures using %s:\n", result.name.c_str());
+    }
+    for (size_t i = 0; i < this->images.size(); i++) {
+        Image& img = this->images[i];
+        if (result.layer[i] == std::numeric_limits<uint32_t>::max()) {
             printf("    Failed %s\n", img.name.c_str());
-            success = false;
-            break;
+            continue;
+        }
+        img.x = result.x[i];
+        img.y = result.y[i];
+        img.layer = result.layer[i];
+        if (!this->logPlacements) {
+            continue;
+        }
+        if (img.alias != NO_ALIAS) {
+            printf("    %s at (%d, %d, %d), duplicate of %s\n", img.name.c_str(), img.x, img.y, img.layer, this->images[img.alias].name.c_str());
+            continue;
+        }
+        printf("    %s at (%d, %d, %d)\n", img.name.c_str(), img.x, img.y, img.layer);
+    }
+    this->packName = result.name;
+    this->usedArea = 0;
+    for (size_t l = 0; l < result.layerArea.size(); l++) {
+        this->usedArea += result.layerArea[l];
+        if (this->logPlacements) {
+            printf("Layer %zu: %.1f%% occupied%s\n", l, 100.0 * result.layerArea[l] / ((double)w * h), this->dirtyLayers[l] ? "" : ", unchanged");
         }
     }
-    this->layerCount = (uint32_t)layers.size();
-    while (!layers.empty()) {
-        Node* n = layers.back();
-        layers.pop_back();
-        n->destroy();
-        delete n;
+    this->layerCount = (uint32_t)result.layerArea.size();
+    this->lastLayerArea = result.layerArea.empty() ? 0 : result.layerArea.back();
+    this->lastLayerW = 0;
+    this->lastLayerH = 0;
+    for (size_t i = 0; i < this->images.size(); i++) {
+        if (this->layerCount > 0 && result.layer[i] == this->layerCount - 1) {
+            this->lastLayerW = std::max(this->lastLayerW, result.x[i] + this->images[i].w);
+            this->lastLayerH = std::max(this->lastLayerH, result.y[i] + this->images[i].h);
+        }
     }
     this->stage = 3;
     this->width = w;
     this->height = h;
-    return success;
+    return result.success;
+}
+
+const std::string& Atlas::getPackName() const {
+    return this->packName;
+}
+
+uint32_t Atlas::getLayerCount() const {
+    return this->layerCount;
+}
+
+double Atlas::getOccupancy() const {
+    uint64_t total = (uint64_t)this->width * this->height * this->layerCount;
+    return total > 0 ? (double)this->usedArea / total : 0.0;
+}
+
+double Atlas::getLastLayerFill() const {
+    uint64_t total = (uint64_t)this->width * this->height;
+    return total > 0 ? (double)this->lastLayerArea / total : 0.0;
+}
+
+double Atlas::getLastLayerBounds() const {
+    uint64_t total = (uint64_t)this->width * this->height;
+    return total > 0 ? (double)((uint64_t)this->lastLayerW * this->lastLayerH) / total : 0.0;
+}
+
+uint32_t Atlas::getLastLayerHeight() const {
+    return this->lastLayerH;
 }
 
 bool Atlas::build() {
-    if (this->stage != 3) return false;
+    if (this->stage != 3 || this->rectanglesOnly) return false;
 
-    uint8_t* data;
-    data = new uint8_t[this->width * this->height * 4 * this->layerCount];
+    std::vector<std::vector<size_t>> layers(this->layerCount);
+    for (size_t i = 0; i < this->images.size(); i++) {
+        if (this->images[i].layer < this->layerCount && this->images[i].alias == NO_ALIAS) {
+            layers[this->images[i].layer].push_back(i);
+        }
+    }
 
-    for (const Image& img : this->images) {
-        PngReader reader;
-        std::string success = reader.init(img.file);
-        if (!success.empty()) {
-            printf("Failed to load info:\n    %s - %s\n", img.name.c_str(), success.c_str());
-            reader.close();
-            delete[] data;
+    //--The texture array is written alongside the pages, if it can't be updated in place every layer is rebuilt--//
+    TextureFile textureFile;
+    bool reused = false;
+    uint32_t levels = this->mipLevels > 0 ? this->mipLevels : TextureFile::fullLevelCount(this->width, this->height);
+    textureFile.setQuality(this->quality);
+    if (!textureFile.open(this->outBase + ".atx", this->width, this->height, this->layerCount, levels, this->format, reused)) {
+        printf("Could not open texture array: %s.atx\n", this->outBase.c_str());
+        return false;
+    }
+    if (!reused) {
+        this->dirtyLayers.assign(this->layerCount, true);
+    }
+
+    //--Each page is encoded on its own thread while the next one is filled, pagesInFlight bounds how many are resident--//
+    typedef std::chrono::steady_clock Clock;
+    size_t pageBytes = (size_t)this->width * this->height * 4;
+    uint32_t inFlight = std::max(1u, std::min(this->pagesInFlight, this->layerCount));
+    std::vector<std::unique_ptr<uint8_t[]>> pages(inFlight);
+    std::vector<std::future<bool>> encoders(inFlight);
+    uint32_t slot = 0;
+    bool encoded = true;
+    auto finishEncode = [&](uint32_t s) {
+        if (encoders[s].valid() && !encoders[s].get()) {
+            encoded = false;
+        }
+    };
+    size_t stride = (size_t)this->width * 4;
+    for (uint32_t l = 0; l < this->layerCount; l++) {
+        std::string file = this->outBase + std::to_string(l) + ".png";
+        if (!this->dirtyLayers[l] && fileExists(file)) {
+            continue;
+        }
+        finishEncode(slot);
+        if (!encoded) {
             return false;
         }
-        if (reader.getWidth() != img.w || reader.getHeight() != img.h) {
+        if (!pages[slot]) {
+            pages[slot].reset(new uint8_t[pageBytes]);
+        }
+        uint8_t* page = pages[slot].get();
+        memset(page, 0, pageBytes);
+
+        //--Every image owns a distinct region of the page so they are decoded into it concurrently--//
+        const std::vector<size_t>& members = layers[l];
+        std::vector<std::string> errors(members.size());
+        parallelFor(members.size(), [&](size_t m) {
+            Image& img = this->images[members[m]];
+            uint8_t* dest = page + (size_t)img.y * stride + (size_t)img.x * 4;
+            if (img.pixels) {
+                uint32_t rowLength = img.w * 4;
+                for (uint32_t r = 0; r < img.h; r++) {
+                    memcpy(dest + r * stride, img.pixels.get() + (size_t)r * rowLength, rowLength);
+                }
+                img.pixels.reset();
+                return;
+            }
+            PngReader reader;
+            std::string success = reader.init(img.file);
+            if (!success.empty()) {
+                reader.close();
+                errors[m] = success;
+                return;
+            }
+            if (reader.getWidth() != img.srcW || reader.getHeight() != img.srcH) {
+                reader.close();
+                errors[m] = "Image changed size since info was loaded";
+                return;
+            }
+            bool decoded = reader.readInto(dest, stride, img.trimX, img.trimY, img.w, img.h);
             reader.close();
-            delete[] data;
+            if (!decoded) {
+                errors[m] = "Could not decode image";
+            }
+        });
+        for (size_t m = 0; m < members.size(); m++) {
+            if (!errors[m].empty()) {
+                printf("Failed to load info:\n    %s - %s\n", this->images[members[m]].name.c_str(), errors[m].c_str());
+                return false;
+            }
+        }
+
+        uint32_t w = this->width, h = this->height;
+        PngWriter::Options options = this->pngOptions;
+        encoders[slot] = std::async(std::launch::async, [file, w, h, page, options, l]() {
+            Clock::time_point start = Clock::now();
+            size_t bytes = 0;
+            bool success = PngWriter::writeFile(file, w, h, page, options, bytes);
+            if (success) {
+                printf("    Layer %u encoded to %s in %.1f ms, %zu KB\n", l, file.c_str(),
+                       std::chrono::duration<double, std::milli>(Clock::now() - start).count(), bytes >> 10);
+            }
+            return success;
+        });
+        slot = (slot + 1) % inFlight;
+
+        //--The texture array only reads the page, so it is written while the encoder runs--//
+        if (!textureFile.writeLayer(l, page)) {
+            printf("Could not write layer %u to the texture array\n", l);
             return false;
         }
-        uint8_t* imgData = reader.getData();
-        reader.close();
-        uint32_t rowLength = img.w * 4;
-        for (int i = 0; i < img.h; i++) {
-            memcpy(data + (((img.layer * this->height) + img.y + i) * this->width + img.x) * 4, imgData + i * rowLength, rowLength);
+        if (this->format != FORMAT_RGBA8) {
+            printf("    Layer %u as %s: %.2f dB PSNR\n", l, formatName(this->format), textureFile.getLastPsnr());
         }
-        delete[] imgData;
     }
-
-    for (int l = 0; l < this->layerCount; l++) {
-        if (!PngReader::writeFile(this->outBase + std::to_string(l) + ".png", this->width, this->height, data + this->width * this->height * 4 * l)) {
-            delete[] data;
-            return false;
+    for (uint32_t s = 0; s < inFlight; s++) {
+        finishEncode(s);
+    }
+    if (!encoded || !textureFile.close()) {
+        return false;
+    }
+    //--Pages past the new layer count would otherwise be picked up as stale layers--//
+    //--A full rebuild never reads the cache, so pages are removed until one is missing past the cached count--//
+    for (uint32_t l = this->layerCount; ; l++) {
+        if (std::remove((this->outBase + std::to_string(l) + ".png").c_str()) != 0 && l >= this->cacheLayerCount) {
+            break;
         }
     }
     this->stage = 4;
-    delete[] data;
     return true;
 }
 
-static void write4Byte(FILE* fp, uint32_t d) {
-    static const uint8_t u255 = 255;
-    uint8_t o[4];
-    o[0] = (uint8_t)(d >> 24) & u255;
-    o[1] = (uint8_t)(d >> 16) & u255;
-    o[2] = (uint8_t)(d >> 8) & u255;
-    o[3] = (uint8_t)(d >> 0) & u255;
-    fwrite(o, 1, 4, fp);
-}
-
-static void read4Byte(FILE* fp, uint32_t& d) {
-    static const uint8_t u255 = 255;
-    uint8_t o[4];
-    fread(o, 1, 4, fp);
-    d = ((uint32_t)o[0] & u255) << 24;
-    d += ((uint32_t)o[1] & u255) << 16;
-    d += ((uint32_t)o[2] & u255) << 8;
-    d += ((uint32_t)o[3] & u255) << 0;
-}
-
 bool Atlas::writeData() {
     static const uint8_t u0 = 0;
     FILE* fp = fopen((this->outBase + ".ats").c_str(), "wb");
     if (!fp) {
         return false;
     }
+    write4Byte(fp, INFO_MAGIC);
+    write4Byte(fp, this->width);
+    write4Byte(fp, this->height);
+    write4Byte(fp, this->layerCount);
+    write4Byte(fp, this->format);
     write4Byte(fp, (uint32_t)this->images.size());
     for (const Image& img : this->images) {
         write4Byte(fp, img.x);
@@ -205,9 +759,122 @@ bool Atlas::writeData() {
         write4Byte(fp, img.layer);
         write4Byte(fp, img.w);
         write4Byte(fp, img.h);
+        write4Byte(fp, img.trimX);
+        write4Byte(fp, img.trimY);
+        write4Byte(fp, img.srcW);
+        write4Byte(fp, img.srcH);
         fprintf(fp, "%s", img.name.c_str());
         fwrite(&u0, 1, 1, fp);
     }
     fclose(fp);
     return true;
-}
\ No newline at end of file
+}
+
+bool Atlas::writeCache() {
+    if (this->stage != 4) return false;
+
+    FILE* fp = fopen((this->outBase + ".cache").c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+    write4Byte(fp, CACHE_MAGIC);
+    write4Byte(fp, CACHE_VERSION);
+    write4Byte(fp, this->width);
+    write4Byte(fp, this->height);
+    write4Byte(fp, this->layerCount);
+    write4Byte(fp, (uint32_t)this->images.size());
+    for (const Image& img : this->images) {
+        write4Byte(fp, (uint32_t)(img.hash >> 32));
+        write4Byte(fp, (uint32_t)img.hash);
+        write4Byte(fp, img.w);
+        write4Byte(fp, img.h);
+        write4Byte(fp, img.x);
+        write4Byte(fp, img.y);
+        write4Byte(fp, img.layer);
+        write4Byte(fp, img.srcW);
+        write4Byte(fp, img.srcH);
+        write4Byte(fp, img.trimX);
+        write4Byte(fp, img.trimY);
+        write4Byte(fp, (uint32_t)(img.pixelHash >> 32));
+        write4Byte(fp, (uint32_t)img.pixelHash);
+        fprintf(fp, "%s", img.name.c_str());
+        fputc(0, fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+//--Loads every output the way the runtime would, the pages also need their mips built to match the texture array--//
+void Atlas::compareLoadTimes() {
+    if (this->stage != 4) return;
+
+    typedef std::chrono::steady_clock Clock;
+    auto since = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    uint32_t levels = TextureFile::fullLevelCount(this->width, this->height);
+    if (this->mipLevels > 0) {
+        levels = std::min(levels, this->mipLevels);
+    }
+    double decodeMs = 0, mipMs = 0;
+    size_t pngBytes = 0;
+    for (uint32_t l = 0; l < this->layerCount; l++) {
+        std::string file = this->outBase + std::to_string(l) + ".png";
+        Clock::time_point start = Clock::now();
+        PngReader reader;
+        if (!reader.init(file).empty()) {
+            reader.close();
+            printf("Could not open %s\n", file.c_str());
+            return;
+        }
+        std::unique_ptr<uint8_t[]> data(reader.getData());
+        reader.close();
+        decodeMs += since(start);
+        if (!data) {
+            return;
+        }
+        FILE* fp = fopen(file.c_str(), "rb");
+        if (fp) {
+            fseek(fp, 0, SEEK_END);
+            pngBytes += (size_t)ftell(fp);
+            fclose(fp);
+        }
+
+        start = Clock::now();
+        uint32_t w = this->width, h = this->height;
+        std::unique_ptr<uint8_t[]> level;
+        const uint8_t* source = data.get();
+        for (uint32_t m = 1; m < levels; m++) {
+            std::unique_ptr<uint8_t[]> next(new uint8_t[(size_t)std::max(1u, w / 2) * std::max(1u, h / 2) * 4]);
+            downsample(source, w, h, next.get());
+            level.swap(next);
+            source = level.get();
+            w = std::max(1u, w / 2);
+            h = std::max(1u, h / 2);
+        }
+        mipMs += since(start);
+    }
+
+    Clock::time_point start = Clock::now();
+    FILE* fp = fopen((this->outBase + ".atx").c_str(), "rb");
+    if (!fp) {
+        printf("Could not open %s.atx\n", this->outBase.c_str());
+        return;
+    }
+    //--The whole file is read in one go, as it would be into a staging buffer--//
+    fseek(fp, 0, SEEK_END);
+    std::vector<uint8_t> staging((size_t)ftell(fp));
+    fseek(fp, 0, SEEK_SET);
+    size_t read = fread(staging.data(), 1, staging.size(), fp);
+    fclose(fp);
+    if (read != staging.size()) {
+        printf("Could not read %s.atx\n", this->outBase.c_str());
+        return;
+    }
+    double rawMs = since(start);
+
+    printf("Load comparison over %u layers:\n", this->layerCount);
+    printf("    png: %.1f ms decoding + %.1f ms building mips, %zu KB on disk\n", decodeMs, mipMs, pngBytes >> 10);
+    printf("    atx: %.1f ms reading, %zu KB on disk\n", rawMs, staging.size() >> 10);
+}
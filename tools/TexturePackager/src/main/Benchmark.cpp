@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Atlas.h"
+#include "Packer.h"
+
+struct Size {
+    uint32_t w, h;
+};
+
+//--Each distribution stands in for a kind of art set, generated from a fixed seed so runs are comparable--//
+struct Distribution {
+    const char* name;
+    uint32_t countScale;
+    Size (*generate)(std::mt19937& rng);
+};
+
+static uint32_t uniformIn(std::mt19937& rng, uint32_t lo, uint32_t hi) {
+    return std::uniform_int_distribution<uint32_t>(lo, hi)(rng);
+}
+
+static const Distribution distributions[] = {
+    {"uniform", 1, [](std::mt19937& rng) {
+        return Size{uniformIn(rng, 8, 256), uniformIn(rng, 8, 256)};
+    }},
+    //--Mostly small sprites with the occasional large background, sides follow a pareto tail--//
+    {"power-law", 1, [](std::mt19937& rng) {
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        auto side = [&]() {
+            return (uint32_t)std::min(2048.0, 8.0 * std::pow(1.0 - u(rng), -1.0 / 1.2));
+        };
+        return Size{side(), side()};
+    }},
+    {"tall-thin", 1, [](std::mt19937& rng) {
+        return Size{uniformIn(rng, 4, 24), uniformIn(rng, 128, 1024)};
+    }},
+    {"many-tiny", 4, [](std::mt19937& rng) {
+        return Size{uniformIn(rng, 2, 16), uniformIn(rng, 2, 16)};
+    }}
+};
+
+int main(int argc, char* argv[]) {
+    uint32_t count = 2000;
+    uint32_t seed = 1;
+    uint32_t runs = 1;
+    uint32_t pageSize = 4096;
+    std::string out;
+    std::string only;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        if (flag == "--count" && arg + 1 < argc) {
+            count = (uint32_t)strtoul(argv[++arg], nullptr, 10);
+        }
+        else if (flag == "--seed" && arg + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++arg], nullptr, 10);
+        }
+        else if (flag == "--runs" && arg + 1 < argc) {
+            runs = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--page" && arg + 1 < argc) {
+            pageSize = (uint32_t)strtoul(argv[++arg], nullptr, 10);
+        }
+        else if (flag == "--out" && arg + 1 < argc) {
+            out = argv[++arg];
+        }
+        else if (flag == "--engine" && arg + 1 < argc) {
+            only = argv[++arg];
+        }
+        else {
+            printf("Usage: <command> [--count <rectangles>] [--seed <seed>] [--runs <runs>] [--page <size>] [--engine <name>] [--out <file.json>]\n");
+            return 0;
+        }
+    }
+
+    FILE* fp = out.empty() ? stdout : fopen(out.c_str(), "w");
+    if (!fp) {
+        printf("Could not open %s\n", out.c_str());
+        return 1;
+    }
+
+    std::vector<std::string> engines;
+    for (const std::unique_ptr<Packer>& engine : createPackers()) {
+        if (only.empty() || engine->name() == only) {
+            engines.push_back(engine->name());
+        }
+    }
+    //--The full search the packager runs by default, so the chosen engine can be checked against the single engine rows--//
+    if (only.empty()) {
+        engines.push_back("all");
+    }
+
+    fprintf(fp, "{\n  \"page\": %u,\n  \"seed\": %u,\n  \"runs\": %u,\n  \"results\": [", pageSize, seed, runs);
+    bool first = true;
+    for (const Distribution& distribution : distributions) {
+        std::mt19937 rng(seed);
+        std::vector<Size> sizes(count * distribution.countScale);
+        for (Size& size : sizes) {
+            size = distribution.generate(rng);
+        }
+        for (const std::string& engine : engines) {
+            //--The fastest run is kept, the slower ones only measure scheduling noise--//
+            double bestMs = 0.0;
+            bool success = true;
+            uint32_t layers = 0;
+            double occupancy = 0.0;
+            double lastFill = 0.0, lastBounds = 0.0;
+            uint32_t lastHeight = 0;
+            std::string chosen;
+            for (uint32_t run = 0; run < runs; run++) {
+                Atlas atlas("", "");
+                atlas.setIncremental(false);
+                atlas.setEngine(engine == "all" ? "" : engine);
+                atlas.setLogPlacements(false);
+                for (size_t i = 0; i < sizes.size(); i++) {
+                    atlas.addRectangle(std::to_string(i), sizes[i].w, sizes[i].h);
+                }
+                auto start = std::chrono::steady_clock::now();
+                success = atlas.packRectangles(pageSize, pageSize);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                if (run == 0 || ms < bestMs) {
+                    bestMs = ms;
+                }
+                layers = atlas.getLayerCount();
+                occupancy = atlas.getOccupancy();
+                lastFill = atlas.getLastLayerFill();
+                lastBounds = atlas.getLastLayerBounds();
+                lastHeight = atlas.getLastLayerHeight();
+                chosen = atlas.getPackName();
+            }
+            fprintf(fp, "%s\n    {\"distribution\": \"%s\", \"engine\": \"%s\", \"rectangles\": %zu, \"success\": %s, "
+                        "\"ms\": %.3f, \"layers\": %u, \"occupancy\": %.4f, \"last_layer_fill\": %.4f, "
+                        "\"last_layer_bounds\": %.4f, \"last_layer_height\": %u, \"chosen\": \"%s\"}",
+                    first ? "" : ",", distribution.name, engine.c_str(), sizes.size(), success ? "true" : "false",
+                    bestMs, layers, occupancy, lastFill, lastBounds, lastHeight, chosen.c_str());
+            first = false;
+            fflush(fp);
+        }
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    if (fp != stdout) {
+        fclose(fp);
+    }
+    return 0;
+}
@@ -0,0 +1,502 @@
+#include "BlockCompressor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXTUREPACKAGER_SSE2
+#endif
+
+#include "Parallel.h"
+
+namespace {
+    struct Block {
+        float r[16], g[16], b[16];
+        //--How much each texel's colour matters, zero for texels nobody will see--//
+        float weight[16];
+        uint8_t a[16];
+    };
+
+    struct Palette {
+        float r[4], g[4], b[4];
+        int size;
+    };
+
+    void loadBlock(const uint8_t* rgba, uint32_t w, uint32_t h, uint32_t bx, uint32_t by, Block& block) {
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t x = std::min(bx * 4 + (i & 3), w - 1);
+            uint32_t y = std::min(by * 4 + (i >> 2), h - 1);
+            const uint8_t* texel = rgba + ((size_t)y * w + x) * 4;
+            block.r[i] = texel[0];
+            block.g[i] = texel[1];
+            block.b[i] = texel[2];
+            block.a[i] = texel[3];
+            block.weight[i] = 1.0f;
+        }
+    }
+
+    uint16_t pack565(const float c[3]) {
+        auto quantize = [](float v, float levels) {
+            return (uint16_t)std::lround(std::min(255.0f, std::max(0.0f, v)) * levels / 255.0f);
+        };
+        return (uint16_t)((quantize(c[0], 31.0f) << 11) | (quantize(c[1], 63.0f) << 5) | quantize(c[2], 31.0f));
+    }
+
+    void unpack565(uint16_t c, uint8_t out[3]) {
+        uint8_t r = (uint8_t)(c >> 11), g = (uint8_t)((c >> 5) & 63), b = (uint8_t)(c & 31);
+        out[0] = (uint8_t)((r << 3) | (r >> 2));
+        out[1] = (uint8_t)((g << 2) | (g >> 4));
+        out[2] = (uint8_t)((b << 3) | (b >> 2));
+    }
+
+    //--Same integer maths as the decoder so the error is measured against what is actually displayed--//
+    void colourPalette(uint16_t c0, uint16_t c1, bool fourColour, uint8_t out[4][4]) {
+        unpack565(c0, out[0]);
+        unpack565(c1, out[1]);
+        for (int c = 0; c < 3; c++) {
+            if (fourColour) {
+                out[2][c] = (uint8_t)((2 * out[0][c] + out[1][c]) / 3);
+                out[3][c] = (uint8_t)((out[0][c] + 2 * out[1][c]) / 3);
+            }
+            else {
+                out[2][c] = (uint8_t)((out[0][c] + out[1][c]) / 2);
+                out[3][c] = 0;
+            }
+        }
+        out[0][3] = out[1][3] = out[2][3] = 255;
+        out[3][3] = fourColour ? 255 : 0;
+    }
+
+    Palette toPalette(uint16_t c0, uint16_t c1, bool fourColour) {
+        uint8_t colours[4][4];
+        colourPalette(c0, c1, fourColour, colours);
+        Palette p;
+        p.size = fourColour ? 4 : 3;
+        for (int i = 0; i < 4; i++) {
+            p.r[i] = colours[i][0];
+            p.g[i] = colours[i][1];
+            p.b[i] = colours[i][2];
+        }
+        return p;
+    }
+
+    //--Picks the nearest palette entry for every texel and returns the weighted squared error--//
+    float assignIndices(const Block& block, const Palette& p, uint8_t indices[16]) {
+#ifdef TEXTUREPACKAGER_SSE2
+        __m128 total = _mm_setzero_ps();
+        for (int i = 0; i < 16; i += 4) {
+            __m128 r = _mm_loadu_ps(block.r + i);
+            __m128 g = _mm_loadu_ps(block.g + i);
+            __m128 b = _mm_loadu_ps(block.b + i);
+            __m128 best = _mm_set1_ps(FLT_MAX);
+            __m128i bestIndex = _mm_setzero_si128();
+            for (int e = 0; e < p.size; e++) {
+                __m128 dr = _mm_sub_ps(r, _mm_set1_ps(p.r[e]));
+                __m128 dg = _mm_sub_ps(g, _mm_set1_ps(p.g[e]));
+                __m128 db = _mm_sub_ps(b, _mm_set1_ps(p.b[e]));
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+                __m128i closer = _mm_castps_si128(_mm_cmplt_ps(d, best));
+                best = _mm_min_ps(d, best);
+                bestIndex = _mm_or_si128(_mm_andnot_si128(closer, bestIndex), _mm_and_si128(closer, _mm_set1_epi32(e)));
+            }
+            total = _mm_add_ps(total, _mm_mul_ps(best, _mm_loadu_ps(block.weight + i)));
+            int32_t lanes[4];
+            _mm_storeu_si128((__m128i*)lanes, bestIndex);
+            for (int l = 0; l < 4; l++) {
+                indices[i + l] = (uint8_t)lanes[l];
+            }
+        }
+        float sums[4];
+        _mm_storeu_ps(sums, total);
+        return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+        float total = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            float best = FLT_MAX;
+            for (int e = 0; e < p.size; e++) {
+                float dr = block.r[i] - p.r[e], dg = block.g[i] - p.g[e], db = block.b[i] - p.b[e];
+                float d = dr * dr + dg * dg + db * db;
+                if (d < best) {
+                    best = d;
+                    indices[i] = (uint8_t)e;
+                }
+            }
+            total += best * block.weight[i];
+        }
+        return total;
+#endif
+    }
+
+    //--Bounding box diagonal, good enough for flat blocks and cheap--//
+    void boundingEndpoints(const Block& block, float e0[3], float e1[3]) {
+        float lo[3] = {255.0f, 255.0f, 255.0f}, hi[3] = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; i++) {
+            if (block.weight[i] <= 0.0f) continue;
+            const float c[3] = {block.r[i], block.g[i], block.b[i]};
+            for (int k = 0; k < 3; k++) {
+                lo[k] = std::min(lo[k], c[k]);
+                hi[k] = std::max(hi[k], c[k]);
+            }
+        }
+        for (int k = 0; k < 3; k++) {
+            e0[k] = std::max(lo[k], hi[k]);
+            e1[k] = std::min(lo[k], hi[k]);
+        }
+    }
+
+    //--Extremes of the texels projected onto the principal axis of their weighted covariance--//
+    void principalEndpoints(const Block& block, float e0[3], float e1[3]) {
+        float total = 0.0f, mean[3] = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; i++) {
+            total += block.weight[i];
+            mean[0] += block.r[i] * block.weight[i];
+            mean[1] += block.g[i] * block.weight[i];
+            mean[2] += block.b[i] * block.weight[i];
+        }
+        if (total <= 0.0f) {
+            e0[0] = e0[1] = e0[2] = e1[0] = e1[1] = e1[2] = 0.0f;
+            return;
+        }
+        for (float& m : mean) m /= total;
+        float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; i++) {
+            float d[3] = {block.r[i] - mean[0], block.g[i] - mean[1], block.b[i] - mean[2]};
+            float w = block.weight[i];
+            cov[0] += w * d[0] * d[0];
+            cov[1] += w * d[0] * d[1];
+            cov[2] += w * d[0] * d[2];
+            cov[3] += w * d[1] * d[1];
+            cov[4] += w * d[1] * d[2];
+            cov[5] += w * d[2] * d[2];
+        }
+        float axis[3] = {1.0f, 1.0f, 1.0f};
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[3] = {cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                             cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                             cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+            float length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+            if (length < 1e-6f) {
+                break;
+            }
+            for (int k = 0; k < 3; k++) axis[k] = next[k] / length;
+        }
+        float lo = FLT_MAX, hi = -FLT_MAX;
+        for (int i = 0; i < 16; i++) {
+            if (block.weight[i] <= 0.0f) continue;
+            float t = (block.r[i] - mean[0]) * axis[0] + (block.g[i] - mean[1]) * axis[1] + (block.b[i] - mean[2]) * axis[2];
+            lo = std::min(lo, t);
+            hi = std::max(hi, t);
+        }
+        float lengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        for (int k = 0; k < 3; k++) {
+            e0[k] = mean[k] + axis[k] * hi / lengthSq;
+            e1[k] = mean[k] + axis[k] * lo / lengthSq;
+        }
+    }
+
+    //--Least squares endpoints for the current index assignment, false if the system is degenerate--//
+    bool refineEndpoints(const Block& block, const uint8_t indices[16], bool fourColour, float e0[3], float e1[3]) {
+        static const float fourWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        static const float threeWeights[4] = {1.0f, 0.0f, 0.5f, 0.0f};
+        const float* weights = fourColour ? fourWeights : threeWeights;
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[3] = {0.0f, 0.0f, 0.0f}, bx[3] = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; i++) {
+            float w = block.weight[i];
+            if (w <= 0.0f || (!fourColour && indices[i] == 3)) continue;
+            float a = weights[indices[i]], b = 1.0f - a;
+            aa += w * a * a;
+            ab += w * a * b;
+            bb += w * b * b;
+            const float c[3] = {block.r[i], block.g[i], block.b[i]};
+            for (int k = 0; k < 3; k++) {
+                ax[k] += w * a * c[k];
+                bx[k] += w * b * c[k];
+            }
+        }
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f) {
+            return false;
+        }
+        for (int k = 0; k < 3; k++) {
+            e0[k] = (ax[k] * bb - bx[k] * ab) / det;
+            e1[k] = (bx[k] * aa - ax[k] * ab) / det;
+        }
+        return true;
+    }
+
+    void writeColourBlock(uint16_t c0, uint16_t c1, const uint8_t indices[16], uint8_t* out) {
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; i++) {
+            bits |= (uint32_t)indices[i] << (i * 2);
+        }
+        out[0] = (uint8_t)c0;
+        out[1] = (uint8_t)(c0 >> 8);
+        out[2] = (uint8_t)c1;
+        out[3] = (uint8_t)(c1 >> 8);
+        out[4] = (uint8_t)bits;
+        out[5] = (uint8_t)(bits >> 8);
+        out[6] = (uint8_t)(bits >> 16);
+        out[7] = (uint8_t)(bits >> 24);
+    }
+
+    //--Texels with zero weight are transparent in punch through mode and take index 3--//
+    void encodeColour(Block& block, bool punchThrough, uint32_t quality, uint8_t* out) {
+        float e0[3], e1[3];
+        if (quality == 0) {
+            boundingEndpoints(block, e0, e1);
+        }
+        else {
+            principalEndpoints(block, e0, e1);
+        }
+
+        //--Four colour blocks need c0 > c1 and punch through blocks c0 <= c1, the order is the mode--//
+        bool fourColour = !punchThrough;
+        auto order = [fourColour](uint16_t& c0, uint16_t& c1, uint8_t* indices) {
+            if ((fourColour && c0 < c1) || (!fourColour && c0 > c1)) {
+                static const uint8_t swapped[2][4] = {{1, 0, 3, 2}, {1, 0, 2, 3}};
+                std::swap(c0, c1);
+                for (int i = 0; i < 16; i++) indices[i] = swapped[fourColour ? 0 : 1][indices[i]];
+            }
+        };
+
+        uint16_t bestC0 = pack565(e0), bestC1 = pack565(e1);
+        uint8_t bestIndices[16];
+        float bestError = assignIndices(block, toPalette(bestC0, bestC1, fourColour), bestIndices);
+        for (uint32_t iteration = 1; iteration < quality; iteration++) {
+            if (!refineEndpoints(block, bestIndices, fourColour, e0, e1)) {
+                break;
+            }
+            uint16_t c0 = pack565(e0), c1 = pack565(e1);
+            uint8_t indices[16];
+            float error = assignIndices(block, toPalette(c0, c1, fourColour), indices);
+            if (error >= bestError) {
+                break;
+            }
+            bestError = error;
+            bestC0 = c0;
+            bestC1 = c1;
+            memcpy(bestIndices, indices, sizeof(indices));
+        }
+
+        if (punchThrough) {
+            for (int i = 0; i < 16; i++) {
+                if (block.weight[i] <= 0.0f) bestIndices[i] = 3;
+            }
+        }
+        if (fourColour && bestC0 == bestC1) {
+            //--Equal endpoints decode as three colour mode, where index 3 would be transparent--//
+            memset(bestIndices, 0, sizeof(bestIndices));
+        }
+        order(bestC0, bestC1, bestIndices);
+        writeColourBlock(bestC0, bestC1, bestIndices, out);
+    }
+
+    void alphaPalette(uint8_t a0, uint8_t a1, uint8_t out[8]) {
+        out[0] = a0;
+        out[1] = a1;
+        if (a0 > a1) {
+            for (int i = 1; i < 7; i++) out[i + 1] = (uint8_t)(((7 - i) * a0 + i * a1) / 7);
+        }
+        else {
+            for (int i = 1; i < 5; i++) out[i + 1] = (uint8_t)(((5 - i) * a0 + i * a1) / 5);
+            out[6] = 0;
+            out[7] = 255;
+        }
+    }
+
+    uint32_t fitAlpha(const uint8_t alpha[16], uint8_t a0, uint8_t a1, uint8_t indices[16]) {
+        uint8_t values[8];
+        alphaPalette(a0, a1, values);
+        uint32_t total = 0;
+        for (int i = 0; i < 16; i++) {
+            uint32_t best = UINT32_MAX;
+            for (uint8_t v = 0; v < 8; v++) {
+                uint32_t d = (uint32_t)std::abs((int)alpha[i] - (int)values[v]);
+                if (d < best) {
+                    best = d;
+                    indices[i] = v;
+                }
+            }
+            total += best * best;
+        }
+        return total;
+    }
+
+    //--Eight interpolated values across the range, or six inside it plus exact 0 and 255 when the block has both--//
+    void encodeAlpha(const uint8_t alpha[16], uint32_t quality, uint8_t* out) {
+        uint8_t lo = 255, hi = 0, innerLo = 255, innerHi = 0;
+        for (int i = 0; i < 16; i++) {
+            lo = std::min(lo, alpha[i]);
+            hi = std::max(hi, alpha[i]);
+            if (alpha[i] != 0 && alpha[i] != 255) {
+                innerLo = std::min(innerLo, alpha[i]);
+                innerHi = std::max(innerHi, alpha[i]);
+            }
+        }
+        uint8_t a0 = hi, a1 = lo;
+        uint8_t indices[16];
+        uint32_t error = fitAlpha(alpha, a0, a1, indices);
+        if (quality > 0 && error > 0) {
+            if (innerLo > innerHi) {
+                innerLo = innerHi = lo;
+            }
+            uint8_t sixIndices[16];
+            uint32_t sixError = fitAlpha(alpha, innerLo, innerHi, sixIndices);
+            if (sixError < error) {
+                a0 = innerLo;
+                a1 = innerHi;
+                memcpy(indices, sixIndices, sizeof(indices));
+            }
+        }
+        out[0] = a0;
+        out[1] = a1;
+        uint64_t bits = 0;
+        for (int i = 0; i < 16; i++) {
+            bits |= (uint64_t)indices[i] << (i * 3);
+        }
+        for (int i = 0; i < 6; i++) {
+            out[2 + i] = (uint8_t)(bits >> (i * 8));
+        }
+    }
+
+    void decodeColour(const uint8_t* in, bool alwaysFourColour, uint8_t texels[16][4]) {
+        uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8));
+        uint16_t c1 = (uint16_t)(in[2] | (in[3] << 8));
+        uint32_t bits = (uint32_t)in[4] | ((uint32_t)in[5] << 8) | ((uint32_t)in[6] << 16) | ((uint32_t)in[7] << 24);
+        uint8_t palette[4][4];
+        colourPalette(c0, c1, alwaysFourColour || c0 > c1, palette);
+        for (int i = 0; i < 16; i++) {
+            memcpy(texels[i], palette[(bits >> (i * 2)) & 3], 4);
+        }
+    }
+
+    void decodeAlpha(const uint8_t* in, uint8_t texels[16][4]) {
+        uint8_t values[8];
+        alphaPalette(in[0], in[1], values);
+        uint64_t bits = 0;
+        for (int i = 0; i < 6; i++) {
+            bits |= (uint64_t)in[2 + i] << (i * 8);
+        }
+        for (int i = 0; i < 16; i++) {
+            texels[i][3] = values[(bits >> (i * 3)) & 7];
+        }
+    }
+
+    uint32_t blockBytes(uint32_t format) {
+        return format == FORMAT_BC1 ? 8 : 16;
+    }
+
+    //--Whole rows of blocks are handed out so each task writes a contiguous part of the output--//
+    void forEachBlockRow(uint32_t w, uint32_t h, const std::function<void(uint32_t, uint32_t)>& fn) {
+        uint32_t columns = (w + 3) / 4, rows = (h + 3) / 4;
+        parallelFor(rows, [&](size_t by) {
+            for (uint32_t bx = 0; bx < columns; bx++) {
+                fn(bx, (uint32_t)by);
+            }
+        });
+    }
+}
+
+bool parseFormat(const std::string& name, uint32_t& format) {
+    static const std::pair<const char*, TextureFormat> formats[] = {{"rgba8", FORMAT_RGBA8}, {"bc1", FORMAT_BC1}, {"bc3", FORMAT_BC3}};
+    for (const auto& f : formats) {
+        if (name == f.first) {
+            format = f.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* formatName(uint32_t format) {
+    switch (format) {
+        case FORMAT_BC1: return "BC1";
+        case FORMAT_BC3: return "BC3";
+        default: return "RGBA8";
+    }
+}
+
+uint64_t levelSize(uint32_t format, uint32_t w, uint32_t h) {
+    if (format == FORMAT_RGBA8) {
+        return (uint64_t)w * h * 4;
+    }
+    return (uint64_t)((w + 3) / 4) * ((h + 3) / 4) * blockBytes(format);
+}
+
+void compress(const uint8_t* rgba, uint32_t w, uint32_t h, uint32_t format, uint32_t quality, uint8_t* out) {
+    if (format == FORMAT_RGBA8) {
+        memcpy(out, rgba, (size_t)levelSize(format, w, h));
+        return;
+    }
+    quality = std::min(quality, MAX_COMPRESSION_QUALITY);
+    uint32_t columns = (w + 3) / 4;
+    forEachBlockRow(w, h, [&](uint32_t bx, uint32_t by) {
+        Block block;
+        loadBlock(rgba, w, h, bx, by, block);
+        uint8_t* dest = out + ((size_t)by * columns + bx) * blockBytes(format);
+        if (format == FORMAT_BC1) {
+            bool punchThrough = false;
+            for (int i = 0; i < 16; i++) {
+                if (block.a[i] < 128) {
+                    block.weight[i] = 0.0f;
+                    punchThrough = true;
+                }
+            }
+            encodeColour(block, punchThrough, quality, dest);
+        }
+        else {
+            //--Colour under low alpha is barely visible, so it shouldn't pull the endpoints--//
+            for (int i = 0; i < 16; i++) {
+                block.weight[i] = block.a[i] / 255.0f;
+            }
+            encodeAlpha(block.a, quality, dest);
+            encodeColour(block, false, quality, dest + 8);
+        }
+    });
+}
+
+void decompress(const uint8_t* blocks, uint32_t w, uint32_t h, uint32_t format, uint8_t* rgba) {
+    if (format == FORMAT_RGBA8) {
+        memcpy(rgba, blocks, (size_t)levelSize(format, w, h));
+        return;
+    }
+    uint32_t columns = (w + 3) / 4;
+    forEachBlockRow(w, h, [&](uint32_t bx, uint32_t by) {
+        const uint8_t* src = blocks + ((size_t)by * columns + bx) * blockBytes(format);
+        uint8_t texels[16][4];
+        if (format == FORMAT_BC1) {
+            decodeColour(src, false, texels);
+        }
+        else {
+            decodeColour(src + 8, true, texels);
+            decodeAlpha(src, texels);
+        }
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+            if (x < w && y < h) {
+                memcpy(rgba + ((size_t)y * w + x) * 4, texels[i], 4);
+            }
+        }
+    });
+}
+
+double psnr(const uint8_t* a, const uint8_t* b, uint32_t w, uint32_t h) {
+    double total = 0.0;
+    size_t count = (size_t)w * h;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* p = a + i * 4;
+        const uint8_t* q = b + i * 4;
+        for (int c = 0; c < 3; c++) {
+            double d = (p[c] * p[3] - q[c] * q[3]) / 255.0;
+            total += d * d;
+        }
+        double d = (double)p[3] - q[3];
+        total += d * d;
+    }
+    double mse = total / ((double)count * 4.0);
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+}
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 
 #ifdef _WIN32
 #include <filesystem>
@@ -6,18 +9,102 @@ namespace fs = std::filesystem;
 #elif __APPLE__
 #include <experimental/filesystem>
 #include <Atlas.h>
+#include <BlockCompressor.h>
+#include <SdfFont.h>
 
 namespace fs = std::experimental::filesystem;
 #endif
 
+static std::chrono::steady_clock::time_point phaseStart;
+
+static void beginPhase() {
+    phaseStart = std::chrono::steady_clock::now();
+}
+static void endPhase(const char* name) {
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - phaseStart).count();
+    printf("%s took %.1f ms\n", name, ms);
+}
+
 int main(int argc, char* argv[]) {
 
-    if (argc != 2) {
-        printf("Usage: <command> <target-folder>\n");
+    bool full = false;
+    bool compareLoad = false;
+    uint32_t mipLevels = 0;
+    uint32_t format = FORMAT_RGBA8;
+    uint32_t quality = 2;
+    PngWriter::Options pngOptions;
+    uint32_t pagesInFlight = 2;
+    std::vector<std::pair<std::string, std::string>> fonts;
+    SdfFont::Options fontOptions;
+    int arg = 1;
+    for (; arg < argc - 1; arg++) {
+        std::string flag = argv[arg];
+        if (flag == "--full") {
+            full = true;
+        }
+        else if (flag == "--compare-load") {
+            compareLoad = true;
+        }
+        else if (flag == "--mips" && arg + 2 < argc) {
+            mipLevels = (uint32_t)strtoul(argv[++arg], nullptr, 10);
+        }
+        else if (flag == "--format" && arg + 2 < argc && parseFormat(argv[arg + 1], format)) {
+            arg++;
+        }
+        else if (flag == "--quality" && arg + 2 < argc) {
+            quality = std::min((uint32_t)strtoul(argv[++arg], nullptr, 10), MAX_COMPRESSION_QUALITY);
+        }
+        else if (flag == "--png-level" && arg + 2 < argc) {
+            pngOptions.level = std::min(std::max(atoi(argv[++arg]), 0), 9);
+        }
+        else if (flag == "--png-filter" && arg + 2 < argc && PngWriter::parseFilter(argv[arg + 1], pngOptions.filter)) {
+            arg++;
+        }
+        else if (flag == "--png-strategy" && arg + 2 < argc && PngWriter::parseStrategy(argv[arg + 1], pngOptions.strategy)) {
+            arg++;
+        }
+        //--Stored, unfiltered pages for dev builds where the pack is rerun far more often than the output is shipped--//
+        else if (flag == "--fast-png") {
+            pngOptions.level = 0;
+            pngOptions.filter = PngWriter::FILTER_NONE;
+        }
+        else if (flag == "--pages-in-flight" && arg + 2 < argc) {
+            pagesInFlight = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        //--Glyphs are packed as <name>/<codepoint> and their advances written to <target>.<name>.atf--//
+        else if (flag == "--sdf-font" && arg + 3 < argc) {
+            fonts.emplace_back(argv[arg + 1], argv[arg + 2]);
+            arg += 2;
+        }
+        else if (flag == "--font-grid" && arg + 2 < argc && SdfFont::parseGrid(argv[arg + 1], fontOptions.columns, fontOptions.rows)) {
+            arg++;
+        }
+        else if (flag == "--font-first" && arg + 2 < argc) {
+            fontOptions.firstChar = (uint32_t)strtoul(argv[++arg], nullptr, 10);
+        }
+        else if (flag == "--sdf-spread" && arg + 2 < argc) {
+            fontOptions.spread = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--sdf-downscale" && arg + 2 < argc) {
+            fontOptions.downscale = std::max(1u, (uint32_t)strtoul(argv[++arg], nullptr, 10));
+        }
+        else if (flag == "--font-monospace") {
+            fontOptions.monospace = true;
+        }
+        else {
+            break;
+        }
+    }
+    if (arg != argc - 1) {
+        printf("Usage: <command> [--full] [--mips <levels>] [--format rgba8|bc1|bc3] [--quality 0-%u] [--compare-load]\n"
+               "       [--png-level 0-9] [--png-filter none|sub|up|average|paeth|adaptive] [--png-strategy default|filtered|rle|huffman]\n"
+               "       [--fast-png] [--pages-in-flight <pages>]\n"
+               "       [--sdf-font <name> <sheet.png>] [--font-grid <columns>x<rows>] [--font-first <codepoint>]\n"
+               "       [--sdf-spread <texels>] [--sdf-downscale <factor>] [--font-monospace] <target-folder>\n", MAX_COMPRESSION_QUALITY);
         return 0;
     }
 
-    std::string targetFolder = std::string(argv[1]);
+    std::string targetFolder = std::string(argv[argc - 1]);
     while (targetFolder.find_last_of(fs::path::preferred_separator) == (targetFolder.size() - 1)) {
         targetFolder = targetFolder.substr(0, targetFolder.size() - 1);
     }
@@ -30,12 +117,36 @@ int main(int argc, char* argv[]) {
     }
 
     Atlas atlas(targetFolder, targetFolder.substr(0, targetFolder.size() - 1));
+    atlas.setIncremental(!full);
+    atlas.setMipLevels(mipLevels);
+    atlas.setFormat(format, quality);
+    atlas.setPngOptions(pngOptions);
+    atlas.setPagesInFlight(pagesInFlight);
 
-    printf("Finding all '.png's in: '%s'\n", targetFolder.c_str());
+    //--Glyph images go beside the target folder rather than in it so they are never picked up as sources--//
+    std::vector<SdfFont> sdfFonts(fonts.size());
     bool found = false;
+    for (size_t i = 0; i < fonts.size(); i++) {
+        std::string glyphFolder = targetFolder.substr(0, targetFolder.size() - 1) + ".glyphs" + fs::path::preferred_separator + fonts[i].first + fs::path::preferred_separator;
+        fs::create_directories(glyphFolder);
+        std::vector<std::pair<std::string, std::string>> glyphs;
+        if (!sdfFonts[i].bake(fonts[i].first, fonts[i].second, glyphFolder, fontOptions, glyphs)) {
+            printf("Failed: Could not bake font '%s'\n", fonts[i].first.c_str());
+            return 0;
+        }
+        for (const std::pair<std::string, std::string>& glyph : glyphs) {
+            atlas.addTexture(glyph.first, glyph.second);
+            found = true;
+        }
+    }
+
+    printf("Finding all '.png's in: '%s'\n", targetFolder.c_str());
     for (const fs::directory_entry& entry : fs::recursive_directory_iterator(targetFolder)) {
         if (fs::is_regular_file(entry)) {
-            if (entry.path().extension() == ".png") {
+            bool sheet = std::any_of(fonts.begin(), fonts.end(), [&entry](const std::pair<std::string, std::string>& font) {
+                return fs::exists(font.second) && fs::equivalent(entry.path(), font.second);
+            });
+            if (entry.path().extension() == ".png" && !sheet) {
                 std::string file = entry.path().string();
                 std::string ref = file.substr(0, file.size() - 4);
                 ref = ref.substr(targetFolder.size());
@@ -49,22 +160,43 @@ int main(int argc, char* argv[]) {
         printf("    None found\n");
         return 0;
     }
+    beginPhase();
     if (!atlas.loadInfo()) {
         printf("Failed: Could not load info\n");
         return 0;
     }
+    endPhase("Loading info");
+    beginPhase();
     if (!atlas.packRectangles(4096, 4096)) {
         printf("Failed: Could not pack textures\n");
         return 0;
     }
+    endPhase("Packing");
+    beginPhase();
     if (!atlas.build()) {
         printf("Failed: Could not create output images\n");
         return 0;
     }
+    endPhase("Building");
+    beginPhase();
     if (!atlas.writeData()) {
         printf("Failed: Could not create output info\n");
         return 0;
     }
+    if (!atlas.writeCache()) {
+        printf("Warning: Could not write build cache, the next build will be a full build\n");
+    }
+    for (size_t i = 0; i < fonts.size(); i++) {
+        std::string file = targetFolder.substr(0, targetFolder.size() - 1) + "." + fonts[i].first + ".atf";
+        if (!sdfFonts[i].writeMetrics(file)) {
+            printf("Failed: Could not write font metrics %s\n", file.c_str());
+            return 0;
+        }
+    }
+    endPhase("Writing info");
+    if (compareLoad) {
+        atlas.compareLoadTimes();
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "Packer.h"
+
+#include <algorithm>
+#include <limits>
+
+static bool contains(const PackRect& outer, const PackRect& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+}
+
+static uint32_t overlap(uint32_t a0, uint32_t a1, uint32_t b0, uint32_t b1) {
+    if (a1 <= b0 || b1 <= a0) return 0;
+    return std::min(a1, b1) - std::max(a0, b0);
+}
+
+MaxRectsPacker::MaxRectsPacker(Heuristic heuristic) {
+    this->heuristic = heuristic;
+}
+
+std::string MaxRectsPacker::name() const {
+    static const char* names[] = {"maxrects-bssf", "maxrects-blsf", "maxrects-baf", "maxrects-bl", "maxrects-cp"};
+    return names[this->heuristic];
+}
+std::unique_ptr<Packer> MaxRectsPacker::create() const {
+    return std::make_unique<MaxRectsPacker>(this->heuristic);
+}
+
+void MaxRectsPacker::reset(uint32_t w, uint32_t h) {
+    this->width = w;
+    this->height = h;
+    this->freeRects.clear();
+    this->usedRects.clear();
+    this->freeRects.push_back({0, 0, w, h});
+}
+
+bool MaxRectsPacker::insert(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y) {
+    PackRect rect;
+    if (!this->findPosition(w, h, rect)) {
+        return false;
+    }
+    this->place(rect);
+    x = rect.x;
+    y = rect.y;
+    return true;
+}
+
+void MaxRectsPacker::occupy(uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    this->place({x, y, w, h});
+}
+
+//--Lower scores are better, the second score breaks ties--//
+bool MaxRectsPacker::findPosition(uint32_t w, uint32_t h, PackRect& out) const {
+    uint64_t best1 = std::numeric_limits<uint64_t>::max();
+    uint64_t best2 = std::numeric_limits<uint64_t>::max();
+    bool found = false;
+    for (const PackRect& f : this->freeRects) {
+        if (f.w < w || f.h < h) {
+            continue;
+        }
+        uint32_t leftoverW = f.w - w;
+        uint32_t leftoverH = f.h - h;
+        uint64_t s1, s2;
+        switch (this->heuristic) {
+            case BEST_SHORT_SIDE_FIT:
+                s1 = std::min(leftoverW, leftoverH);
+                s2 = std::max(leftoverW, leftoverH);
+                break;
+            case BEST_LONG_SIDE_FIT:
+                s1 = std::max(leftoverW, leftoverH);
+                s2 = std::min(leftoverW, leftoverH);
+                break;
+            case BEST_AREA_FIT:
+                s1 = (uint64_t)f.w * f.h - (uint64_t)w * h;
+                s2 = std::min(leftoverW, leftoverH);
+                break;
+            case BOTTOM_LEFT:
+                s1 = f.y + h;
+                s2 = f.x;
+                break;
+            case CONTACT_POINT:
+            default:
+                //--More contact is better so invert it to keep lower as better--//
+                s1 = std::numeric_limits<uint32_t>::max() - this->contactScore(f.x, f.y, w, h);
+                s2 = 0;
+                break;
+        }
+        if (s1 < best1 || (s1 == best1 && s2 < best2)) {
+            best1 = s1;
+            best2 = s2;
+            out = {f.x, f.y, w, h};
+            found = true;
+        }
+    }
+    return found;
+}
+
+uint64_t MaxRectsPacker::contactScore(uint32_t x, uint32_t y, uint32_t w, uint32_t h) const {
+    uint64_t score = 0;
+    if (x == 0 || x + w == this->width) score += h;
+    if (y == 0 || y + h == this->height) score += w;
+    for (const PackRect& u : this->usedRects) {
+        if (u.x == x + w || u.x + u.w == x) score += overlap(u.y, u.y + u.h, y, y + h);
+        if (u.y == y + h || u.y + u.h == y) score += overlap(u.x, u.x + u.w, x, x + w);
+    }
+    return score;
+}
+
+void MaxRectsPacker::place(const PackRect& rect) {
+    //--Every free rectangle the placement overlaps is replaced by up to four maximal pieces around it--//
+    std::vector<PackRect> kept;
+    std::vector<PackRect> pieces;
+    kept.reserve(this->freeRects.size());
+    for (const PackRect& f : this->freeRects) {
+        if (rect.x >= f.x + f.w || rect.x + rect.w <= f.x || rect.y >= f.y + f.h || rect.y + rect.h <= f.y) {
+            kept.push_back(f);
+            continue;
+        }
+        if (rect.x > f.x) pieces.push_back({f.x, f.y, rect.x - f.x, f.h});
+        if (rect.x + rect.w < f.x + f.w) pieces.push_back({rect.x + rect.w, f.y, f.x + f.w - rect.x - rect.w, f.h});
+        if (rect.y > f.y) pieces.push_back({f.x, f.y, f.w, rect.y - f.y});
+        if (rect.y + rect.h < f.y + f.h) pieces.push_back({f.x, rect.y + rect.h, f.w, f.y + f.h - rect.y - rect.h});
+    }
+    //--Untouched rectangles were already maximal and a piece can't contain them, so only pieces need pruning--//
+    std::vector<PackRect> survivors;
+    for (size_t i = 0; i < pieces.size(); i++) {
+        bool redundant = false;
+        for (const PackRect& k : kept) {
+            if (contains(k, pieces[i])) {
+                redundant = true;
+                break;
+            }
+        }
+        for (size_t j = 0; j < pieces.size() && !redundant; j++) {
+            if (i != j && contains(pieces[j], pieces[i])) {
+                redundant = !contains(pieces[i], pieces[j]) || j < i;
+            }
+        }
+        if (!redundant) {
+            survivors.push_back(pieces[i]);
+        }
+    }
+    this->freeRects.swap(kept);
+    this->freeRects.insert(this->freeRects.end(), survivors.begin(), survivors.end());
+    this->usedRects.push_back(rect);
+}
@@ -0,0 +1,14 @@
+#include "Packer.h"
+
+std::vector<std::unique_ptr<Packer>> createPackers() {
+    std::vector<std::unique_ptr<Packer>> packers;
+    packers.push_back(std::make_unique<TreePacker>());
+    packers.push_back(std::make_unique<MaxRectsPacker>(MaxRectsPacker::BEST_SHORT_SIDE_FIT));
+    packers.push_back(std::make_unique<MaxRectsPacker>(MaxRectsPacker::BEST_LONG_SIDE_FIT));
+    packers.push_back(std::make_unique<MaxRectsPacker>(MaxRectsPacker::BEST_AREA_FIT));
+    packers.push_back(std::make_unique<MaxRectsPacker>(MaxRectsPacker::BOTTOM_LEFT));
+    packers.push_back(std::make_unique<MaxRectsPacker>(MaxRectsPacker::CONTACT_POINT));
+    packers.push_back(std::make_unique<SkylinePacker>(SkylinePacker::BOTTOM_LEFT));
+    packers.push_back(std::make_unique<SkylinePacker>(SkylinePacker::MIN_WASTE));
+    return packers;
+}
@@ -0,0 +1,28 @@
+#include "Parallel.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+uint32_t threadCount() {
+    uint32_t count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+    size_t threads = std::min((size_t)threadCount(), count);
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : pool) {
+        t.join();
+    }
+}
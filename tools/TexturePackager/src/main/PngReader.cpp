@@ -4,6 +4,7 @@
 #include <stdexcept>
 #include <cstring>
 #include <sstream>
+#include <vector>
 #include "png.h"
 
 std::string PngReader::init(const std::string& file) {
@@ -36,9 +37,16 @@ std::string PngReader::init(const std::string& file) {
 
         png_read_info(this->png_ptr, this->info_ptr);
 
-        if (png_get_color_type(this->png_ptr, this->info_ptr) != PNG_COLOR_TYPE_RGB_ALPHA) {
+        png_byte colourType = png_get_color_type(this->png_ptr, this->info_ptr);
+        if (colourType != PNG_COLOR_TYPE_RGB_ALPHA) {
             png_set_expand(png_ptr);
         }
+        if (colourType == PNG_COLOR_TYPE_GRAY || colourType == PNG_COLOR_TYPE_GRAY_ALPHA) {
+            png_set_gray_to_rgb(png_ptr);
+        }
+        if (!(colourType & PNG_COLOR_MASK_ALPHA) && !png_get_valid(this->png_ptr, this->info_ptr, PNG_INFO_tRNS)) {
+            png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+        }
         if (png_get_bit_depth(this->png_ptr, this->info_ptr) != 8) {
             png_set_strip_16(png_ptr);
         }
@@ -62,77 +70,49 @@ uint32_t PngReader::getHeight() {
 }
 
 uint8_t* PngReader::getData() {
-    uint8_t* out = nullptr;
-    try {
-        png_read_update_info(this->png_ptr, this->info_ptr);
-
-        out = new uint8_t[this->width * this->height * 4];
-
-        png_byte* row;
-        row = new png_byte[png_get_rowbytes(this->png_ptr, this->info_ptr)];
-
-        for (int i = 0; i < this->height; i++) {
-            png_read_row(this->png_ptr, row, nullptr);
-            memcpy(out + i * this->width * 4, row, this->width * 4);
-        }
-        delete[] row;
-        png_read_end(this->png_ptr, nullptr);
-        png_destroy_read_struct(&this->png_ptr, &this->info_ptr, nullptr);
-    }
-    catch (const std::exception& e) {
-        png_destroy_read_struct(&this->png_ptr, &this->info_ptr, nullptr);
-        printf("    Exception: %s\n", e.what());
+    uint8_t* out = new uint8_t[(size_t)this->width * this->height * 4];
+    if (!this->readInto(out, (size_t)this->width * 4, 0, 0, this->width, this->height)) {
+        delete[] out;
         return nullptr;
     }
     return out;
 }
 
-void PngReader::close() {
-    fclose(this->fp);
-}
-
-bool PngReader::writeFile(const std::string &file, uint32_t w, uint32_t h, uint8_t *data) {
-    FILE* fp = fopen(file.c_str(), "wb");
-    printf("Writing file: %s\n", file.c_str());
-    if (!fp) {
-        printf("    Could not open file\n");
-        return false;
-    }
-
-    png_structp png_ptr;
-    png_infop info_ptr;
+bool PngReader::readInto(uint8_t* dest, size_t stride, uint32_t srcX, uint32_t srcY, uint32_t w, uint32_t h) {
     try {
-        png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-        if (!png_ptr) {
-            throw std::runtime_error("Could not initialise 'png_structp'");
+        png_read_update_info(this->png_ptr, this->info_ptr);
+        if (png_get_rowbytes(this->png_ptr, this->info_ptr) != (size_t)this->width * 4) {
+            throw std::runtime_error("Decoded rows are not 4 bytes per pixel");
         }
-        info_ptr = png_create_info_struct(png_ptr);
-        if (!info_ptr) {
-            throw std::runtime_error("Could not initialise 'png_infop'");
+        if (srcX + w > this->width || srcY + h > this->height) {
+            throw std::runtime_error("Requested region is outside the image");
         }
-        png_init_io(png_ptr, fp);
-
-        png_set_IHDR(png_ptr, info_ptr, w, h, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
-
-        png_write_info(png_ptr, info_ptr);
-
-        png_byte* row;
-        row = new png_byte[png_get_rowbytes(png_ptr, info_ptr)];
 
-        for (int i = 0; i < h; i++) {
-            memcpy(row, data + i * w * 4, w * 4);
-            png_write_row(png_ptr, row);
+        //--Full width rows go straight to their destination, anything else is decoded aside and the region copied out--//
+        bool direct = srcX == 0 && w == this->width;
+        std::vector<png_byte> row(direct && h == this->height ? 0 : (size_t)this->width * 4);
+        for (uint32_t i = 0; i < this->height; i++) {
+            bool inside = i >= srcY && i < srcY + h;
+            if (inside && direct) {
+                png_read_row(this->png_ptr, dest + (i - srcY) * stride, nullptr);
+                continue;
+            }
+            png_read_row(this->png_ptr, row.data(), nullptr);
+            if (inside) {
+                memcpy(dest + (i - srcY) * stride, row.data() + (size_t)srcX * 4, (size_t)w * 4);
+            }
         }
-        delete[] row;
-        png_write_end(png_ptr, nullptr);
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        fclose(fp);
+        png_read_end(this->png_ptr, nullptr);
+        png_destroy_read_struct(&this->png_ptr, &this->info_ptr, nullptr);
     }
     catch (const std::exception& e) {
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        fclose(fp);
+        png_destroy_read_struct(&this->png_ptr, &this->info_ptr, nullptr);
         printf("    Exception: %s\n", e.what());
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+void PngReader::close() {
+    fclose(this->fp);
+}
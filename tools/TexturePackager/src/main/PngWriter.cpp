@@ -0,0 +1,221 @@
+#include "PngWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <zlib.h>
+
+#include "Parallel.h"
+
+static const uint32_t BYTES_PER_PIXEL = 4;
+static const uint32_t MIN_STRIP_ROWS = 16;
+static const size_t WINDOW_SIZE = 32768;
+
+namespace {
+    struct Strip {
+        std::vector<uint8_t> filtered;
+        std::vector<uint8_t> compressed;
+        uLong adler = 1;
+        bool success = true;
+    };
+
+    uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+        int p = (int)a + b - c;
+        int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc) return a;
+        return pb <= pc ? b : c;
+    }
+
+    void filterRow(const uint8_t* row, const uint8_t* prev, size_t length, int type, uint8_t* out) {
+        out[0] = (uint8_t)type;
+        out++;
+        for (size_t i = 0; i < length; i++) {
+            uint8_t a = i >= BYTES_PER_PIXEL ? row[i - BYTES_PER_PIXEL] : 0;
+            uint8_t b = prev ? prev[i] : 0;
+            uint8_t c = (prev && i >= BYTES_PER_PIXEL) ? prev[i - BYTES_PER_PIXEL] : 0;
+            switch (type) {
+                case PngWriter::FILTER_SUB: out[i] = (uint8_t)(row[i] - a); break;
+                case PngWriter::FILTER_UP: out[i] = (uint8_t)(row[i] - b); break;
+                case PngWriter::FILTER_AVERAGE: out[i] = (uint8_t)(row[i] - ((a + b) >> 1)); break;
+                case PngWriter::FILTER_PAETH: out[i] = (uint8_t)(row[i] - paeth(a, b, c)); break;
+                default: out[i] = row[i]; break;
+            }
+        }
+    }
+
+    uint64_t filterCost(const uint8_t* filtered, size_t length) {
+        uint64_t cost = 0;
+        for (size_t i = 1; i <= length; i++) {
+            cost += (uint64_t)std::abs((int)(int8_t)filtered[i]);
+        }
+        return cost;
+    }
+
+    void filterStrip(const uint8_t* data, uint32_t w, uint32_t begin, uint32_t end, PngWriter::Filter filter, std::vector<uint8_t>& out) {
+        size_t length = (size_t)w * BYTES_PER_PIXEL;
+        out.resize((length + 1) * (end - begin));
+        std::vector<uint8_t> candidate(filter == PngWriter::FILTER_ADAPTIVE ? length + 1 : 0);
+        for (uint32_t y = begin; y < end; y++) {
+            const uint8_t* row = data + (size_t)y * length;
+            const uint8_t* prev = y > 0 ? row - length : nullptr;
+            uint8_t* dest = out.data() + (size_t)(y - begin) * (length + 1);
+            if (filter != PngWriter::FILTER_ADAPTIVE) {
+                filterRow(row, prev, length, filter, dest);
+                continue;
+            }
+            uint64_t best = UINT64_MAX;
+            for (int type = PngWriter::FILTER_NONE; type <= PngWriter::FILTER_PAETH; type++) {
+                filterRow(row, prev, length, type, candidate.data());
+                uint64_t cost = filterCost(candidate.data(), length);
+                if (cost < best) {
+                    best = cost;
+                    memcpy(dest, candidate.data(), length + 1);
+                }
+            }
+        }
+    }
+
+    int zlibStrategy(PngWriter::Strategy strategy) {
+        switch (strategy) {
+            case PngWriter::STRATEGY_FILTERED: return Z_FILTERED;
+            case PngWriter::STRATEGY_RLE: return Z_RLE;
+            case PngWriter::STRATEGY_HUFFMAN: return Z_HUFFMAN_ONLY;
+            default: return Z_DEFAULT_STRATEGY;
+        }
+    }
+
+    //--Raw deflate of one strip, primed with the end of the previous strip so matches can reach across the seam--//
+    void deflateStrip(Strip& strip, const Strip* previous, bool last, const PngWriter::Options& options) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (deflateInit2(&stream, options.level, Z_DEFLATED, -15, 8, zlibStrategy(options.strategy)) != Z_OK) {
+            strip.success = false;
+            return;
+        }
+        if (previous && options.level > 0) {
+            size_t window = std::min(WINDOW_SIZE, previous->filtered.size());
+            deflateSetDictionary(&stream, previous->filtered.data() + previous->filtered.size() - window, (uInt)window);
+        }
+        strip.compressed.resize(deflateBound(&stream, (uLong)strip.filtered.size()) + 16);
+        stream.next_in = strip.filtered.data();
+        stream.avail_in = (uInt)strip.filtered.size();
+        stream.next_out = strip.compressed.data();
+        stream.avail_out = (uInt)strip.compressed.size();
+        //--Every strip but the last ends on a byte aligned sync point so the raw streams can be concatenated--//
+        int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+        strip.success = last ? result == Z_STREAM_END : (result == Z_OK && stream.avail_in == 0);
+        strip.compressed.resize(strip.compressed.size() - stream.avail_out);
+        deflateEnd(&stream);
+        strip.adler = adler32(1, strip.filtered.data(), (uInt)strip.filtered.size());
+    }
+
+    void write4Byte(uint8_t* out, uint32_t d) {
+        out[0] = (uint8_t)(d >> 24);
+        out[1] = (uint8_t)(d >> 16);
+        out[2] = (uint8_t)(d >> 8);
+        out[3] = (uint8_t)d;
+    }
+
+    bool writeChunk(FILE* fp, const char* type, const uint8_t* data, size_t size, size_t& bytesWritten) {
+        uint8_t header[8];
+        write4Byte(header, (uint32_t)size);
+        memcpy(header + 4, type, 4);
+        uLong crc = crc32(0, header + 4, 4);
+        if (size > 0) {
+            crc = crc32(crc, data, (uInt)size);
+        }
+        uint8_t footer[4];
+        write4Byte(footer, (uint32_t)crc);
+        bool success = fwrite(header, 1, 8, fp) == 8 && (size == 0 || fwrite(data, 1, size, fp) == size) && fwrite(footer, 1, 4, fp) == 4;
+        bytesWritten += 12 + size;
+        return success;
+    }
+}
+
+bool PngWriter::parseFilter(const std::string& name, Filter& filter) {
+    static const std::pair<const char*, Filter> filters[] = {{"none", FILTER_NONE}, {"sub", FILTER_SUB}, {"up", FILTER_UP},
+                                                             {"average", FILTER_AVERAGE}, {"paeth", FILTER_PAETH}, {"adaptive", FILTER_ADAPTIVE}};
+    for (const auto& f : filters) {
+        if (name == f.first) {
+            filter = f.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PngWriter::parseStrategy(const std::string& name, Strategy& strategy) {
+    static const std::pair<const char*, Strategy> strategies[] = {{"default", STRATEGY_DEFAULT}, {"filtered", STRATEGY_FILTERED},
+                                                                  {"rle", STRATEGY_RLE}, {"huffman", STRATEGY_HUFFMAN}};
+    for (const auto& s : strategies) {
+        if (name == s.first) {
+            strategy = s.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PngWriter::writeFile(const std::string& file, uint32_t w, uint32_t h, const uint8_t* data, const Options& options, size_t& bytesWritten) {
+    bytesWritten = 0;
+    uint32_t rowsPerStrip = std::max(MIN_STRIP_ROWS, (h + threadCount() * 2 - 1) / (threadCount() * 2));
+    std::vector<Strip> strips((h + rowsPerStrip - 1) / rowsPerStrip);
+
+    //--Filtering only reads the source so every strip can be filtered at once, compression then needs its predecessor's tail--//
+    parallelFor(strips.size(), [&](size_t s) {
+        uint32_t begin = (uint32_t)s * rowsPerStrip;
+        filterStrip(data, w, begin, std::min(h, begin + rowsPerStrip), options.filter, strips[s].filtered);
+    });
+    parallelFor(strips.size(), [&](size_t s) {
+        deflateStrip(strips[s], s > 0 ? &strips[s - 1] : nullptr, s + 1 == strips.size(), options);
+    });
+
+    uLong adler = 1;
+    for (const Strip& strip : strips) {
+        if (!strip.success) {
+            printf("    Could not compress %s\n", file.c_str());
+            return false;
+        }
+        adler = adler32_combine(adler, strip.adler, (z_off_t)strip.filtered.size());
+    }
+
+    FILE* fp = fopen(file.c_str(), "wb");
+    if (!fp) {
+        printf("    Could not open file %s\n", file.c_str());
+        return false;
+    }
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    bool success = fwrite(signature, 1, 8, fp) == 8;
+    bytesWritten += 8;
+
+    uint8_t ihdr[13];
+    write4Byte(ihdr, w);
+    write4Byte(ihdr + 4, h);
+    ihdr[8] = 8;
+    ihdr[9] = 6;
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;
+    success = success && writeChunk(fp, "IHDR", ihdr, sizeof(ihdr), bytesWritten);
+
+    //--zlib header advertising a 32K window with the level hint, checked so the pair is a multiple of 31--//
+    int levelHint = options.level <= 1 ? 0 : options.level <= 5 ? 1 : options.level == 6 ? 2 : 3;
+    uint8_t zlibHeader[2] = {0x78, (uint8_t)(levelHint << 6)};
+    zlibHeader[1] += (uint8_t)(31 - ((zlibHeader[0] << 8) | zlibHeader[1]) % 31);
+    std::vector<uint8_t> first(zlibHeader, zlibHeader + 2);
+    first.insert(first.end(), strips[0].compressed.begin(), strips[0].compressed.end());
+    strips[0].compressed.swap(first);
+    uint8_t trailer[4];
+    write4Byte(trailer, (uint32_t)adler);
+    strips.back().compressed.insert(strips.back().compressed.end(), trailer, trailer + 4);
+
+    for (const Strip& strip : strips) {
+        success = success && writeChunk(fp, "IDAT", strip.compressed.data(), strip.compressed.size(), bytesWritten);
+    }
+    success = success && writeChunk(fp, "IEND", nullptr, 0, bytesWritten);
+    success = (fclose(fp) == 0) && success;
+    if (!success) {
+        printf("    Could not write file %s\n", file.c_str());
+    }
+    return success;
+}
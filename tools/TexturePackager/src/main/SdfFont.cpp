@@ -0,0 +1,215 @@
+#include "SdfFont.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "Parallel.h"
+#include "PngReader.h"
+#include "PngWriter.h"
+
+static const float FAR = 1e20f;
+
+static void write4Byte(FILE* fp, uint32_t d) {
+    uint8_t o[4] = {(uint8_t)(d >> 24), (uint8_t)(d >> 16), (uint8_t)(d >> 8), (uint8_t)d};
+    fwrite(o, 1, 4, fp);
+}
+
+//--Felzenszwalb and Huttenlocher's squared distance transform along one row or column, the lower envelope of parabolas rooted at each sample--//
+static void distance1D(const float* f, uint32_t n, float* d, uint32_t* v, float* z) {
+    uint32_t k = 0;
+    v[0] = 0;
+    z[0] = -FAR;
+    z[1] = FAR;
+    for (uint32_t q = 1; q < n; q++) {
+        double s;
+        while (true) {
+            uint32_t p = v[k];
+            s = (((double)f[q] + (double)q * q) - ((double)f[p] + (double)p * p)) / (2.0 * q - 2.0 * p);
+            //--z[0] is minus infinity so the envelope never empties--//
+            if (s > z[k] || k == 0) {
+                break;
+            }
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = (float)s;
+        z[k + 1] = FAR;
+    }
+    k = 0;
+    for (uint32_t q = 0; q < n; q++) {
+        while (z[k + 1] < (float)q) {
+            k++;
+        }
+        float dq = (float)q - (float)v[k];
+        d[q] = dq * dq + f[v[k]];
+    }
+}
+
+//--Squared distance from every texel to the nearest zero of grid, columns then rows--//
+static void distance2D(std::vector<float>& grid, uint32_t w, uint32_t h) {
+    uint32_t n = std::max(w, h);
+    std::vector<float> f(n), d(n), z(n + 1);
+    std::vector<uint32_t> v(n);
+    for (uint32_t x = 0; x < w; x++) {
+        for (uint32_t y = 0; y < h; y++) {
+            f[y] = grid[(size_t)y * w + x];
+        }
+        distance1D(f.data(), h, d.data(), v.data(), z.data());
+        for (uint32_t y = 0; y < h; y++) {
+            grid[(size_t)y * w + x] = d[y];
+        }
+    }
+    for (uint32_t y = 0; y < h; y++) {
+        distance1D(&grid[(size_t)y * w], w, d.data(), v.data(), z.data());
+        std::copy(d.begin(), d.begin() + w, grid.begin() + (size_t)y * w);
+    }
+}
+
+bool SdfFont::parseGrid(const std::string& text, uint32_t& columns, uint32_t& rows) {
+    size_t x = text.find('x');
+    if (x == std::string::npos) {
+        return false;
+    }
+    uint32_t c = (uint32_t)strtoul(text.substr(0, x).c_str(), nullptr, 10);
+    uint32_t r = (uint32_t)strtoul(text.substr(x + 1).c_str(), nullptr, 10);
+    if (c == 0 || r == 0) {
+        return false;
+    }
+    columns = c;
+    rows = r;
+    return true;
+}
+
+bool SdfFont::bake(const std::string& name, const std::string& sheet, const std::string& folder, const Options& options,
+                   std::vector<std::pair<std::string, std::string>>& glyphs) {
+    this->options = options;
+    this->options.downscale = std::max(1u, options.downscale);
+    this->options.spread = std::max(1u, options.spread);
+    PngReader reader;
+    std::string success = reader.init(sheet);
+    if (!success.empty()) {
+        reader.close();
+        printf("Could not open font sheet %s - %s\n", sheet.c_str(), success.c_str());
+        return false;
+    }
+    uint32_t sheetW = reader.getWidth(), sheetH = reader.getHeight();
+    std::unique_ptr<uint8_t[]> pixels(reader.getData());
+    reader.close();
+    if (!pixels) {
+        printf("Could not decode font sheet %s\n", sheet.c_str());
+        return false;
+    }
+
+    const uint32_t ds = this->options.downscale, spread = this->options.spread;
+    uint32_t srcCellW = sheetW / options.columns, srcCellH = sheetH / options.rows;
+    this->cellW = srcCellW / ds;
+    this->cellH = srcCellH / ds;
+    if (this->cellW == 0 || this->cellH == 0) {
+        printf("Font sheet %s is too small for a %ux%u grid downscaled by %u\n", sheet.c_str(), options.columns, options.rows, ds);
+        return false;
+    }
+    //--Sheets without transparency are read as light glyphs on a dark background--//
+    bool useAlpha = false;
+    for (size_t i = 0; i < (size_t)sheetW * sheetH && !useAlpha; i++) {
+        useAlpha = pixels[i * 4 + 3] < 255;
+    }
+
+    uint32_t count = options.columns * options.rows;
+    uint32_t pad = spread * ds;
+    uint32_t paddedW = srcCellW + 2 * pad, paddedH = srcCellH + 2 * pad;
+    uint32_t outW = this->cellW + 2 * spread, outH = this->cellH + 2 * spread;
+    this->glyphs.assign(count, {0, 0, 0, false});
+    std::vector<std::unique_ptr<uint8_t[]>> images(count);
+    parallelFor(count, [&](size_t i) {
+        Glyph& glyph = this->glyphs[i];
+        glyph.codepoint = options.firstChar + (uint32_t)i;
+        uint32_t cellX = (uint32_t)(i % options.columns) * srcCellW, cellY = (uint32_t)(i / options.columns) * srcCellH;
+
+        std::vector<bool> inside((size_t)paddedW * paddedH, false);
+        uint32_t inkMin = paddedW, inkMax = 0;
+        for (uint32_t y = 0; y < srcCellH; y++) {
+            for (uint32_t x = 0; x < srcCellW; x++) {
+                const uint8_t* p = &pixels[(((size_t)cellY + y) * sheetW + cellX + x) * 4];
+                uint32_t coverage = useAlpha ? p[3] : ((uint32_t)p[0] + p[1] + p[2]) / 3;
+                if (coverage >= 128) {
+                    inside[(size_t)(y + pad) * paddedW + x + pad] = true;
+                    inkMin = std::min(inkMin, x);
+                    inkMax = std::max(inkMax, x);
+                }
+            }
+        }
+        if (inkMin > inkMax) {
+            glyph.advance = options.monospace ? this->cellW : std::max(1u, this->cellW / 2);
+            return;
+        }
+        glyph.hasImage = true;
+        glyph.left = options.monospace ? 0 : (int32_t)(inkMin / ds);
+        glyph.advance = options.monospace ? this->cellW : (inkMax + ds) / ds - (uint32_t)glyph.left + 1;
+
+        //--Distance to the nearest inked texel for the outside and to the nearest bare texel for the inside--//
+        std::vector<float> toInk(inside.size()), toBare(inside.size());
+        for (size_t p = 0; p < inside.size(); p++) {
+            toInk[p] = inside[p] ? 0.0f : FAR;
+            toBare[p] = inside[p] ? FAR : 0.0f;
+        }
+        distance2D(toInk, paddedW, paddedH);
+        distance2D(toBare, paddedW, paddedH);
+
+        std::unique_ptr<uint8_t[]> out(new uint8_t[(size_t)outW * outH * 4]);
+        for (uint32_t y = 0; y < outH; y++) {
+            for (uint32_t x = 0; x < outW; x++) {
+                size_t p = (size_t)std::min(y * ds + ds / 2, paddedH - 1) * paddedW + std::min(x * ds + ds / 2, paddedW - 1);
+                //--Half a texel either side of the edge so the 0.5 alpha contour sits between inked and bare texels--//
+                float d = inside[p] ? std::sqrt(toBare[p]) - 0.5f : 0.5f - std::sqrt(toInk[p]);
+                float alpha = 127.5f + d / (float)ds / (float)spread * 127.5f;
+                uint8_t* o = &out[((size_t)y * outW + x) * 4];
+                o[0] = o[1] = o[2] = 255;
+                o[3] = (uint8_t)std::min(255.0f, std::max(0.0f, std::round(alpha)));
+            }
+        }
+        images[i].swap(out);
+    });
+
+    PngWriter::Options pngOptions;
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!images[i]) {
+            continue;
+        }
+        std::string file = folder + std::to_string(this->glyphs[i].codepoint) + ".png";
+        size_t bytes = 0;
+        if (!PngWriter::writeFile(file, outW, outH, images[i].get(), pngOptions, bytes)) {
+            printf("Could not write glyph %s\n", file.c_str());
+            return false;
+        }
+        glyphs.emplace_back(name + "/" + std::to_string(this->glyphs[i].codepoint), file);
+        written++;
+    }
+    printf("Baked %u of %u glyphs from %s into %ux%u distance fields\n", written, count, sheet.c_str(), outW, outH);
+    return true;
+}
+
+bool SdfFont::writeMetrics(const std::string& file) const {
+    FILE* fp = fopen(file.c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+    write4Byte(fp, MAGIC);
+    write4Byte(fp, this->cellW);
+    write4Byte(fp, this->cellH);
+    write4Byte(fp, this->options.spread);
+    write4Byte(fp, (uint32_t)this->glyphs.size());
+    for (const Glyph& g : this->glyphs) {
+        write4Byte(fp, g.codepoint);
+        write4Byte(fp, (uint32_t)g.left);
+        write4Byte(fp, g.advance);
+        write4Byte(fp, g.hasImage ? 1 : 0);
+    }
+    bool success = !ferror(fp);
+    fclose(fp);
+    return success;
+}
@@ -0,0 +1,105 @@
+#include "Packer.h"
+
+#include <algorithm>
+#include <limits>
+
+SkylinePacker::SkylinePacker(Heuristic heuristic) {
+    this->heuristic = heuristic;
+}
+
+std::string SkylinePacker::name() const {
+    return this->heuristic == BOTTOM_LEFT ? "skyline-bl" : "skyline-minwaste";
+}
+std::unique_ptr<Packer> SkylinePacker::create() const {
+    return std::make_unique<SkylinePacker>(this->heuristic);
+}
+
+void SkylinePacker::reset(uint32_t w, uint32_t h) {
+    this->width = w;
+    this->height = h;
+    this->skyline.clear();
+    this->skyline.push_back({0, 0, w});
+}
+
+//--Finds the height a rectangle would rest at with its left edge on segment index--//
+bool SkylinePacker::fits(size_t index, uint32_t w, uint32_t h, uint32_t& y, uint64_t& waste) const {
+    uint32_t x = this->skyline[index].x;
+    if (x + w > this->width) {
+        return false;
+    }
+    y = 0;
+    uint32_t remaining = w;
+    for (size_t i = index; remaining > 0; i++) {
+        if (i >= this->skyline.size()) {
+            return false;
+        }
+        y = std::max(y, this->skyline[i].y);
+        remaining -= std::min(remaining, this->skyline[i].w);
+    }
+    if (y + h > this->height) {
+        return false;
+    }
+    waste = 0;
+    remaining = w;
+    for (size_t i = index; remaining > 0; i++) {
+        uint32_t span = std::min(remaining, this->skyline[i].w);
+        waste += (uint64_t)span * (y - this->skyline[i].y);
+        remaining -= span;
+    }
+    return true;
+}
+
+bool SkylinePacker::insert(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y) {
+    size_t bestIndex = this->skyline.size();
+    uint64_t best1 = std::numeric_limits<uint64_t>::max();
+    uint64_t best2 = std::numeric_limits<uint64_t>::max();
+    uint32_t bestY = 0;
+    for (size_t i = 0; i < this->skyline.size(); i++) {
+        uint32_t restY;
+        uint64_t waste;
+        if (!this->fits(i, w, h, restY, waste)) {
+            continue;
+        }
+        uint64_t s1 = this->heuristic == BOTTOM_LEFT ? restY + h : waste;
+        uint64_t s2 = this->heuristic == BOTTOM_LEFT ? this->skyline[i].w : restY + h;
+        if (s1 < best1 || (s1 == best1 && s2 < best2)) {
+            best1 = s1;
+            best2 = s2;
+            bestIndex = i;
+            bestY = restY;
+        }
+    }
+    if (bestIndex == this->skyline.size()) {
+        return false;
+    }
+    x = this->skyline[bestIndex].x;
+    y = bestY;
+
+    //--Raise the skyline under the new rectangle, trimming or removing the segments it covers--//
+    Segment raised = {x, y + h, w};
+    size_t i = bestIndex;
+    while (i < this->skyline.size() && this->skyline[i].x < x + w) {
+        Segment& s = this->skyline[i];
+        uint32_t end = s.x + s.w;
+        if (end <= x + w) {
+            this->skyline.erase(this->skyline.begin() + i);
+        }
+        else {
+            s.w = end - (x + w);
+            s.x = x + w;
+            break;
+        }
+    }
+    this->skyline.insert(this->skyline.begin() + bestIndex, raised);
+
+    for (size_t j = 0; j + 1 < this->skyline.size();) {
+        if (this->skyline[j].y == this->skyline[j + 1].y) {
+            this->skyline[j].w += this->skyline[j + 1].w;
+            this->skyline.erase(this->skyline.begin() + j + 1);
+        }
+        else {
+            j++;
+        }
+    }
+    return true;
+}
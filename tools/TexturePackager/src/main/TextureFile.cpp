@@ -0,0 +1,213 @@
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "BlockCompressor.h"
+#include "Parallel.h"
+
+//--Texel data is aligned so every level can be copied to the GPU straight out of a staging buffer--//
+static const uint64_t DATA_ALIGNMENT = 16;
+static const uint32_t ROWS_PER_TASK = 64;
+
+static uint64_t alignUp(uint64_t v) {
+    return (v + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+}
+
+static bool seekTo(FILE* fp, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(fp, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(fp, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+static void write4Byte(FILE* fp, uint32_t d) {
+    uint8_t o[4] = {(uint8_t)(d >> 24), (uint8_t)(d >> 16), (uint8_t)(d >> 8), (uint8_t)d};
+    fwrite(o, 1, 4, fp);
+}
+
+static bool read4Byte(FILE* fp, uint32_t& d) {
+    uint8_t o[4];
+    if (fread(o, 1, 4, fp) != 4) {
+        return false;
+    }
+    d = ((uint32_t)o[0] << 24) | ((uint32_t)o[1] << 16) | ((uint32_t)o[2] << 8) | (uint32_t)o[3];
+    return true;
+}
+
+void downsample(const uint8_t* src, uint32_t w, uint32_t h, uint8_t* dst) {
+    uint32_t dw = std::max(1u, w / 2);
+    uint32_t dh = std::max(1u, h / 2);
+    uint32_t tasks = (dh + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    parallelFor(tasks, [&](size_t t) {
+        uint32_t end = std::min(dh, (uint32_t)(t + 1) * ROWS_PER_TASK);
+        for (uint32_t y = (uint32_t)t * ROWS_PER_TASK; y < end; y++) {
+            const uint8_t* row0 = src + (size_t)std::min(y * 2, h - 1) * w * 4;
+            const uint8_t* row1 = src + (size_t)std::min(y * 2 + 1, h - 1) * w * 4;
+            uint8_t* out = dst + (size_t)y * dw * 4;
+            for (uint32_t x = 0; x < dw; x++) {
+                uint32_t x0 = std::min(x * 2, w - 1) * 4;
+                uint32_t x1 = std::min(x * 2 + 1, w - 1) * 4;
+                const uint8_t* texels[4] = {row0 + x0, row0 + x1, row1 + x0, row1 + x1};
+                uint32_t alpha = 0;
+                uint32_t colour[3] = {0, 0, 0};
+                for (const uint8_t* texel : texels) {
+                    alpha += texel[3];
+                    for (int c = 0; c < 3; c++) {
+                        colour[c] += texel[c] * texel[3];
+                    }
+                }
+                for (int c = 0; c < 3; c++) {
+                    out[x * 4 + c] = alpha > 0 ? (uint8_t)((colour[c] + alpha / 2) / alpha) : 0;
+                }
+                out[x * 4 + 3] = (uint8_t)((alpha + 2) / 4);
+            }
+        }
+    });
+}
+
+TextureFile::~TextureFile() {
+    this->close();
+}
+
+uint32_t TextureFile::fullLevelCount(uint32_t w, uint32_t h) {
+    uint32_t levels = 1;
+    while (w > 1 || h > 1) {
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+        levels++;
+    }
+    return levels;
+}
+
+void TextureFile::setQuality(uint32_t quality) {
+    this->quality = quality;
+}
+
+bool TextureFile::open(const std::string& file, uint32_t w, uint32_t h, uint32_t layers, uint32_t levels, uint32_t format, bool& reused) {
+    this->close();
+    this->format = format;
+    this->width = w;
+    this->height = h;
+    this->layerCount = layers;
+    levels = std::min(std::max(levels, 1u), fullLevelCount(w, h));
+
+    uint64_t headerSize = 4 * 9 + 24 * (uint64_t)levels;
+    uint64_t offset = alignUp(headerSize);
+    this->levels.clear();
+    for (uint32_t l = 0; l < levels; l++) {
+        Level level = {w, h, offset, levelSize(format, w, h)};
+        this->levels.push_back(level);
+        offset = alignUp(offset + level.size);
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+    }
+    this->layerStride = offset - this->levels[0].offset;
+
+    //--An existing file can be updated in place if everything but a growing layer count matches, shrinking recreates it--//
+    reused = false;
+    this->fp = fopen(file.c_str(), "r+b");
+    if (this->fp) {
+        uint32_t header[7];
+        bool read = true;
+        for (uint32_t& v : header) {
+            read = read && read4Byte(this->fp, v);
+        }
+        reused = read && header[0] == MAGIC && header[1] == VERSION && header[2] == this->format &&
+                 header[3] == this->width && header[4] == this->height && header[5] <= layers && header[6] == levels;
+        if (!reused) {
+            fclose(this->fp);
+            this->fp = nullptr;
+        }
+    }
+    if (!this->fp) {
+        this->fp = fopen(file.c_str(), "wb");
+    }
+    if (!this->fp) {
+        return false;
+    }
+    return this->writeHeader();
+}
+
+bool TextureFile::writeHeader() {
+    if (!seekTo(this->fp, 0)) {
+        return false;
+    }
+    write4Byte(this->fp, MAGIC);
+    write4Byte(this->fp, VERSION);
+    write4Byte(this->fp, this->format);
+    write4Byte(this->fp, this->width);
+    write4Byte(this->fp, this->height);
+    write4Byte(this->fp, this->layerCount);
+    write4Byte(this->fp, (uint32_t)this->levels.size());
+    write4Byte(this->fp, (uint32_t)(this->layerStride >> 32));
+    write4Byte(this->fp, (uint32_t)this->layerStride);
+    for (const Level& level : this->levels) {
+        write4Byte(this->fp, level.w);
+        write4Byte(this->fp, level.h);
+        write4Byte(this->fp, (uint32_t)(level.offset >> 32));
+        write4Byte(this->fp, (uint32_t)level.offset);
+        write4Byte(this->fp, (uint32_t)(level.size >> 32));
+        write4Byte(this->fp, (uint32_t)level.size);
+    }
+    return !ferror(this->fp);
+}
+
+bool TextureFile::writeLayer(uint32_t layer, const uint8_t* data) {
+    if (!this->fp || layer >= this->layerCount) {
+        return false;
+    }
+    //--Each level is only needed to build the next one, so two buffers are swapped down the chain--//
+    std::unique_ptr<uint8_t[]> current;
+    std::unique_ptr<uint8_t[]> next;
+    std::unique_ptr<uint8_t[]> blocks;
+    const uint8_t* source = data;
+    for (size_t l = 0; l < this->levels.size(); l++) {
+        const Level& level = this->levels[l];
+        if (l > 0) {
+            const Level& parent = this->levels[l - 1];
+            next.reset(new uint8_t[(size_t)level.w * level.h * 4]);
+            downsample(source, parent.w, parent.h, next.get());
+            current.swap(next);
+            source = current.get();
+        }
+        const uint8_t* out = source;
+        if (this->format != FORMAT_RGBA8) {
+            blocks.reset(new uint8_t[level.size]);
+            compress(source, level.w, level.h, this->format, this->quality, blocks.get());
+            out = blocks.get();
+            if (l == 0) {
+                std::unique_ptr<uint8_t[]> decoded(new uint8_t[(size_t)level.w * level.h * 4]);
+                decompress(blocks.get(), level.w, level.h, this->format, decoded.get());
+                this->lastPsnr = psnr(source, decoded.get(), level.w, level.h);
+            }
+        }
+        else if (l == 0) {
+            this->lastPsnr = INFINITY;
+        }
+        if (!seekTo(this->fp, level.offset + this->layerStride * layer) || fwrite(out, 1, level.size, this->fp) != level.size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextureFile::close() {
+    if (!this->fp) {
+        return true;
+    }
+    bool success = !ferror(this->fp);
+    success = (fclose(this->fp) == 0) && success;
+    this->fp = nullptr;
+    return success;
+}
+
+uint64_t TextureFile::getFileSize() const {
+    return this->levels[0].offset + this->layerStride * this->layerCount;
+}
+
+double TextureFile::getLastPsnr() const {
+    return this->lastPsnr;
+}
@@ -0,0 +1,22 @@
+#include "Packer.h"
+
+std::string TreePacker::name() const {
+    return "tree";
+}
+std::unique_ptr<Packer> TreePacker::create() const {
+    return std::make_unique<TreePacker>();
+}
+
+void TreePacker::reset(uint32_t w, uint32_t h) {
+    this->packer.reset(w, h);
+}
+
+bool TreePacker::insert(uint32_t w, uint32_t h, uint32_t& x, uint32_t& y) {
+    pack::rect r;
+    if (this->packer.insert(w, h, r) == pack::guillotine_packer::INVALID_HANDLE) {
+        return false;
+    }
+    x = r.x;
+    y = r.y;
+    return true;
+}